@@ -181,6 +181,14 @@ export class ClosestRayResultCallback extends RayResultCallback  {
 	set_m_hitPointWorld(value: btVector3): void;
 }
 
+export class hbrClosestRayResultCallback extends ClosestRayResultCallback  {
+	constructor(from: btVector3, to: btVector3);
+	get_m_hitShapePart(): number;
+	set_m_hitShapePart(value: number): void;
+	get_m_hitIndex(): number;
+	set_m_hitIndex(value: number): void;
+}
+
 export class btManifoldPoint {
 	getPositionWorldOnA(): btVector3;
 	getPositionWorldOnB(): btVector3;
@@ -250,6 +258,14 @@ export class ClosestConvexResultCallback extends ConvexResultCallback  {
 	set_m_hitPointWorld(value: btVector3): void;
 }
 
+export class hbrClosestConvexResultCallback extends ClosestConvexResultCallback  {
+	constructor(convexFromWorld: btVector3, convexToWorld: btVector3);
+	get_m_hitShapePart(): number;
+	set_m_hitShapePart(value: number): void;
+	get_m_hitIndex(): number;
+	set_m_hitIndex(value: number): void;
+}
+
 export class btCollisionShape {
 	setLocalScaling(scaling: btVector3): void;
 	getLocalScaling(): btVector3;
@@ -365,6 +381,8 @@ export class btShapeHull {
 	buildHull(margin: number): boolean;
 	numVertices(): number;
 	getVertexPointer(): btVector3;
+	numTriangles(): number;
+	numIndices(): number;
 }
 
 export class btConeShapeX extends btConeShape  {
@@ -388,6 +406,15 @@ export class btCompoundShape extends btCollisionShape  {
 	getMargin(): number;
 }
 
+export class hbrInstancedShape extends btCompoundShape  {
+	constructor(instanceShape: btCollisionShape);
+	addInstance(transform: btTransform): number;
+	addInstances(transforms: number, count: number): number;
+	removeInstance(index: number): boolean;
+	getNumInstances(): number;
+	getInstanceShape(): btCollisionShape;
+}
+
 export class btStridingMeshInterface {
 	setScaling(scaling: btVector3): void;
 }
@@ -423,8 +450,53 @@ export class btHeightfieldTerrainShape extends btConcaveShape  {
 	getMargin(): number;
 }
 
+export class hbrShapeCache {
+	constructor();
+	getBoxShape(halfExtents: btVector3): btCollisionShape;
+	getSphereShape(radius: number): btCollisionShape;
+	getCapsuleShape(radius: number, height: number, upAxis: number): btCollisionShape;
+	getCylinderShape(halfExtents: btVector3, upAxis: number): btCollisionShape;
+	getConeShape(radius: number, height: number, upAxis: number): btCollisionShape;
+	getConvexHullShape(points: number, numPoints: number): btCollisionShape;
+	getTriangleMeshShape(vertices: number, numVertices: number, indices: number, numTriangles: number): btCollisionShape;
+	retain(shape: btCollisionShape): boolean;
+	release(shape: btCollisionShape): boolean;
+	getRefCount(shape: btCollisionShape): number;
+	getHitCount(): number;
+	getMissCount(): number;
+	getLiveShapeCount(): number;
+	resetStats(): void;
+}
+
+export class hbrHeightfieldTerrain {
+	constructor(world: btCollisionWorld, tileSamples: number, sampleSpacing: number, upAxis?: number);
+	setOrigin(origin: btVector3): void;
+	getOrigin(): btVector3;
+	setCollisionFilter(group: number, mask: number): void;
+	setFriction(friction: number): void;
+	setRestitution(restitution: number): void;
+	loadTile(tileX: number, tileZ: number, heights: number): boolean;
+	unloadTile(tileX: number, tileZ: number): boolean;
+	isTileLoaded(tileX: number, tileZ: number): boolean;
+	getNumLoadedTiles(): number;
+	getTileObject(tileX: number, tileZ: number): btCollisionObject;
+	setHeights(sampleX: number, sampleZ: number, width: number, length: number, heights: number): number;
+	setMemoryBudget(bytes: number): void;
+	getMemoryBudget(): number;
+	getMemoryUsed(): number;
+	updateStreaming(positions: number, numPositions: number, radius: number, missingTiles: number, maxMissing: number): number;
+}
+
 export class btDefaultCollisionConstructionInfo {
 	constructor();
+	get_m_defaultMaxPersistentManifoldPoolSize(): number;
+	set_m_defaultMaxPersistentManifoldPoolSize(value: number): void;
+	get_m_defaultMaxCollisionAlgorithmPoolSize(): number;
+	set_m_defaultMaxCollisionAlgorithmPoolSize(value: number): void;
+	get_m_customCollisionAlgorithmMaxElementSize(): number;
+	set_m_customCollisionAlgorithmMaxElementSize(value: number): void;
+	get_m_useEpaPenetrationAlgorithm(): number;
+	set_m_useEpaPenetrationAlgorithm(value: number): void;
 }
 
 export class btDefaultCollisionConfiguration extends btCollisionConfiguration  {
@@ -448,13 +520,32 @@ export class btCollisionDispatcher extends btDispatcher  {
 	constructor(conf: btDefaultCollisionConfiguration);
 }
 
+export class hbrCollisionDispatcher extends btCollisionDispatcher  {
+	constructor(conf: btDefaultCollisionConfiguration);
+	getManifoldPoolSize(): number;
+	getManifoldPoolUsed(): number;
+	getManifoldPoolHighWater(): number;
+	getManifoldPoolOverflows(): number;
+	getAlgorithmPoolSize(): number;
+	getAlgorithmPoolUsed(): number;
+	getAlgorithmPoolHighWater(): number;
+	getAlgorithmPoolOverflows(): number;
+	resetCounters(): void;
+}
+
 export class btOverlappingPairCallback {
 	get_$__dummyprop__btOverlappingPairCallback(): any;
 	set_$__dummyprop__btOverlappingPairCallback(value: any): void;
 }
 
+export class btOverlapFilterCallback {
+	get_$__dummyprop__btOverlapFilterCallback(): any;
+	set_$__dummyprop__btOverlapFilterCallback(value: any): void;
+}
+
 export class btOverlappingPairCache {
 	setInternalGhostPairCallback(ghostPairCallback: btOverlappingPairCallback): void;
+	setOverlapFilterCallback(callback: btOverlapFilterCallback): void;
 }
 
 export class btAxisSweep3 {
@@ -475,6 +566,15 @@ export class btDbvtBroadphase extends btBroadphaseInterface  {
 	constructor();
 }
 
+export class hbrGridBroadphase extends btBroadphaseInterface  {
+	constructor(cellSize: number, upAxis?: number, pairCache?: btOverlappingPairCache);
+	getCellSize(): number;
+	getNumProxies(): number;
+	getNumLargeProxies(): number;
+	getNumCells(): number;
+	getNumMovedProxies(): number;
+}
+
 export class btBroadphaseProxy {
 	get_m_collisionFilterGroup(): number;
 	set_m_collisionFilterGroup(value: number): void;
@@ -558,6 +658,8 @@ export class btTypedConstraint {
 	setBreakingImpulseThreshold(threshold: number): void;
 	getParam(num: number, axis: number): number;
 	setParam(num: number, value: number, axis: number): void;
+	getOverrideNumSolverIterations(): number;
+	setOverrideNumSolverIterations(overideNumIterations: number): void;
 }
 
 export class btPoint2PointConstraint extends btTypedConstraint  {
@@ -593,6 +695,22 @@ export class btSequentialImpulseConstraintSolver extends btConstraintSolver  {
 	constructor();
 }
 
+export class hbrAdaptiveConstraintSolver extends btSequentialImpulseConstraintSolver  {
+	constructor();
+	setAdaptive(adaptive: boolean): void;
+	getAdaptive(): boolean;
+	setResidualThreshold(threshold: number): void;
+	getResidualThreshold(): number;
+	setIterationLimits(minIterations: number, maxIterations: number): void;
+	getMinIterations(): number;
+	getMaxIterations(): number;
+	getNumIslands(): number;
+	getNumIterations(): number;
+	getMaxIslandIterations(): number;
+	getNumUnconverged(): number;
+	getMaxResidual(): number;
+}
+
 export class btConeTwistConstraint extends btTypedConstraint  {
 	constructor(rbA: btRigidBody, rbB: btRigidBody, rbAFrame: btTransform, rbBFrame: btTransform);
 	constructor(rbA: btRigidBody, rbAFrame: btTransform);
@@ -673,6 +791,9 @@ export class btCollisionWorld {
 	contactPairTest(colObjA: btCollisionObject, colObjB: btCollisionObject, resultCallback: ContactResultCallback): void;
 	contactTest(colObj: btCollisionObject, resultCallback: ContactResultCallback): void;
 	updateSingleAabb(colObj: btCollisionObject): void;
+	getNumCollisionObjects(): number;
+	setForceUpdateAllAabbs(forceUpdateAllAabbs: boolean): void;
+	getForceUpdateAllAabbs(): boolean;
 	setDebugDrawer(debugDrawer: btIDebugDraw): void;
 	getDebugDrawer(): btIDebugDraw;
 	debugDrawWorld(): void;
@@ -686,6 +807,10 @@ export class btContactSolverInfo {
 	set_m_splitImpulsePenetrationThreshold(value: number): void;
 	get_m_numIterations(): number;
 	set_m_numIterations(value: number): void;
+	get_m_leastSquaresResidualThreshold(): number;
+	set_m_leastSquaresResidualThreshold(value: number): void;
+	get_m_minimumSolverBatchSize(): number;
+	set_m_minimumSolverBatchSize(value: number): void;
 }
 
 export class btDynamicsWorld extends btCollisionWorld  {
@@ -707,6 +832,15 @@ export class btDiscreteDynamicsWorld extends btDynamicsWorld  {
 	setSynchronizeAllMotionStates(synchronizeAll: boolean): void;
 }
 
+export class hbrActiveSetDynamicsWorld extends btDiscreteDynamicsWorld  {
+	constructor(dispatcher: btDispatcher, pairCache: btBroadphaseInterface, constraintSolver: btConstraintSolver, collisionConfiguration: btCollisionConfiguration);
+	activateBody(object: btCollisionObject, forceActivation?: boolean): void;
+	markMoved(object: btCollisionObject): void;
+	refreshActiveSet(): void;
+	getNumActiveBodies(): number;
+	getNumMovedObjects(): number;
+}
+
 export class btVehicleTuning {
 	constructor();
 	get_m_suspensionStiffness(): number;
@@ -850,6 +984,7 @@ export class hbrKinematicCharacterController extends btActionInterface  {
 	applyImpulse(v: btVector3): void;
 	setWalkDirection(walkDirection: btVector3): void;
 	warp(origin: btVector3): void;
+	shiftOrigin(offset: btVector3): void;
 	preStep(collisionWorld: btCollisionWorld): void;
 	playerStep(collisionWorld: btCollisionWorld, dt: number): void;
 	preUpdate(collisionWorld: btCollisionWorld, dt: number): void;
@@ -876,7 +1011,11 @@ export class hbrKinematicCharacterController extends btActionInterface  {
 	getMaxSlope(): number;
 	getGhostObject(): btPairCachingGhostObject;
 	setUseGhostSweepTest(useGhostObjectSweepTest: boolean): void;
+	setCollisionLayers(layers: hbrCollisionLayers): void;
+	getCollisionLayers(): hbrCollisionLayers;
 	onGround(): boolean;
+	getGroundObject(): btCollisionObject;
+	getGroundIndex(): number;
 	setLinearVelocity(velocity: btVector3): void;
 	getLinearVelocity(): btVector3;
 	getLocalLinearVelocity(): btVector3;
@@ -887,6 +1026,82 @@ export class hbrKinematicCharacterController extends btActionInterface  {
 	setUpInterpolate(value: boolean): void;
 }
 
+export class hbrFloatingOrigin {
+	constructor(world: btDiscreteDynamicsWorld);
+	addCharacter(character: hbrKinematicCharacterController): void;
+	removeCharacter(character: hbrKinematicCharacterController): void;
+	getNumCharacters(): number;
+	rebase(x: number, y: number, z: number): void;
+	getOrigin(): btVector3;
+}
+
+export class hbrKinematicBodyBatch {
+	constructor(world: btCollisionWorld);
+	addBody(body: btCollisionObject): number;
+	removeBody(index: number): boolean;
+	getBody(index: number): btCollisionObject;
+	getNumBodies(): number;
+	setTransforms(indices: number, transforms: number, count: number, timeStep: number): number;
+}
+
+export class hbrStaticBatch {
+	constructor(world: btCollisionWorld);
+	add(object: btCollisionObject, collisionFilterGroup?: number, collisionFilterMask?: number): void;
+	getNumPending(): number;
+	commit(): number;
+	removeChunk(chunk: number): void;
+	getNumChunks(): number;
+	getChunkSize(chunk: number): number;
+	getChunkObject(chunk: number, index: number): btCollisionObject;
+}
+
+export class hbrHandleTable {
+	constructor();
+	addRigidBody(body: btRigidBody): number;
+	addGhostObject(ghost: btGhostObject): number;
+	addCharacter(character: hbrKinematicCharacterController): number;
+	remove(handle: number): boolean;
+	isValid(handle: number): boolean;
+	getKind(handle: number): number;
+	getCount(): number;
+	findHandle(object: btCollisionObject): number;
+	getCollisionObject(handle: number): btCollisionObject;
+	getCharacter(handle: number): hbrKinematicCharacterController;
+	getTransform(handle: number, out: number): boolean;
+	setTransform(handle: number, transform: number): boolean;
+	setPosition(handle: number, x: number, y: number, z: number): boolean;
+	setRotation(handle: number, x: number, y: number, z: number, w: number): boolean;
+	getLinearVelocity(handle: number, out: number): boolean;
+	setLinearVelocity(handle: number, x: number, y: number, z: number): boolean;
+	getAngularVelocity(handle: number, out: number): boolean;
+	setAngularVelocity(handle: number, x: number, y: number, z: number): boolean;
+	applyCentralImpulse(handle: number, x: number, y: number, z: number): boolean;
+	applyCentralForce(handle: number, x: number, y: number, z: number): boolean;
+	activate(handle: number): boolean;
+	getActivationState(handle: number): number;
+	getUserIndex(handle: number): number;
+	setUserIndex(handle: number, index: number): boolean;
+	setWalkDirection(handle: number, x: number, y: number, z: number): boolean;
+	jump(handle: number): boolean;
+	onGround(handle: number): boolean;
+	warp(handle: number, x: number, y: number, z: number): boolean;
+	readTransforms(handles: number, count: number, out: number): number;
+	readLinearVelocities(handles: number, count: number, out: number): number;
+	rayTestClosest(world: btCollisionWorld, fromX: number, fromY: number, fromZ: number, toX: number, toY: number, toZ: number, out: number): number;
+}
+
+export class hbrArrayView {
+	constructor();
+	vector3Stride(): number;
+	vector3ArrayData(array: btVector3Array): number;
+	intArrayData(array: btIntArray): number;
+	copyFaceIndices(faces: btFaceArray, out: number, maxInts: number): number;
+	copyFacePlanes(faces: btFaceArray, out: number, maxFaces: number): number;
+	shapeHullVertices(hull: btShapeHull): number;
+	shapeHullIndices(hull: btShapeHull): number;
+	convexHullPoints(shape: btConvexHullShape): number;
+}
+
 export class btRaycastVehicle extends btActionInterface  {
 	constructor(tuning: btVehicleTuning, chassis: btRigidBody, raycaster: btVehicleRaycaster);
 	applyEngineForce(force: number, wheel: number): void;
@@ -919,6 +1134,19 @@ export class btRaycastVehicle extends btActionInterface  {
 	getUserConstraintId(): number;
 }
 
+export class hbrVehicleFleet extends btActionInterface  {
+	constructor(world: btCollisionWorld);
+	getRaycaster(): btVehicleRaycaster;
+	addVehicle(vehicle: btRaycastVehicle, driveFlags?: number): number;
+	removeVehicle(vehicle: btRaycastVehicle): boolean;
+	getVehicle(index: number): btRaycastVehicle;
+	getNumVehicles(): number;
+	setRayFilter(group: number, mask: number): void;
+	setControls(controls: number, count: number): void;
+	getStateSize(): number;
+	writeState(out: number, interpolatedTransform: boolean): number;
+}
+
 export class btGhostObject extends btCollisionObject  {
 	constructor();
 	getNumOverlappingObjects(): number;
@@ -933,4 +1161,275 @@ export class btGhostPairCallback extends btOverlappingPairCallback  {
 	constructor();
 }
 
+export class hbrCollisionLayers extends btOverlapFilterCallback  {
+	constructor();
+	setLayerCollision(layerA: number, layerB: number, enable: boolean): void;
+	getLayerCollision(layerA: number, layerB: number): boolean;
+	setLayerMask(layer: number, mask: number): void;
+	getLayerMask(layer: number): number;
+	enableAll(): void;
+	disableAll(): void;
+	getLayerGroup(layer: number): number;
+	setObjectLayer(object: btCollisionObject, layer: number): boolean;
+	getObjectLayer(object: btCollisionObject): number;
+	setRayQueryLayer(callback: RayResultCallback, layer: number): void;
+	setConvexQueryLayer(callback: ConvexResultCallback, layer: number): void;
+	refresh(world: btCollisionWorld): number;
+}
+
+export class hbrArena {
+	constructor();
+	activate(): void;
+	deactivate(): void;
+	isActive(): boolean;
+	reset(): void;
+	addCategory(name: string): number;
+	setCategory(category: number): void;
+	getCategory(): number;
+	getNumCategories(): number;
+	getCategoryName(category: number): string;
+	getLiveBytes(category: number): number;
+	getPeakBytes(category: number): number;
+	getNumAllocations(category: number): number;
+	getNumLiveAllocations(category: number): number;
+	getReservedBytes(): number;
+}
+
+export class hbrProfiler {
+	constructor();
+	isEnabled(): boolean;
+	capture(world: btDynamicsWorld): number;
+	reset(): void;
+	getNumScopes(): number;
+	getScopes(): number;
+	getScopeName(index: number): string;
+	getCapturedTime(): number;
+	getNumCollisionObjects(): number;
+	getNumActiveObjects(): number;
+	getNumOverlappingPairs(): number;
+	getNumManifolds(): number;
+	getNumContactPoints(): number;
+	getNumConstraints(): number;
+	getConfiguredSolverIterations(): number;
+}
+
+export class hbrAsyncStepper {
+	constructor(world: btDynamicsWorld, handles: hbrHandleTable, commandCapacity?: number);
+	setPublishedHandles(handles: number, count: number): boolean;
+	getNumPublished(): number;
+	pushCommand(op: number, handle: number, x: number, y: number, z: number, w: number): boolean;
+	getNumPendingCommands(): number;
+	step(timeStep: number, maxSubSteps: number, fixedTimeStep: number): void;
+	start(timeStep: number, maxSubSteps: number, fixedTimeStep: number): boolean;
+	requestStep(): void;
+	stop(): void;
+	isRunning(): boolean;
+	isThreadingSupported(): boolean;
+	acquireFrame(): boolean;
+	getFrame(): number;
+	getFrameNumber(): number;
+	getStepsCompleted(): number;
+}
+
+export class hbrSnapshotCodec {
+	constructor(handles: hbrHandleTable, positionPrecision: number, velocityPrecision: number);
+	bindId(id: number, handle: number): void;
+	unbindId(id: number): void;
+	getHandle(id: number): number;
+	getPositionPrecision(): number;
+	getVelocityPrecision(): number;
+	capture(ids: number, count: number, state: number): number;
+	encode(state: number, count: number, baseline: number, baselineCount: number, out: number, capacity: number): number;
+	decode(input: number, size: number, baseline: number, baselineCount: number, out: number, capacity: number, apply: boolean): number;
+	apply(state: number, count: number): number;
+}
+
+export class hbrTriggerVolumes {
+	constructor(world: btCollisionWorld);
+	addTrigger(ghost: btGhostObject, exactShapeTest?: boolean): number;
+	removeTrigger(id: number): boolean;
+	getTrigger(id: number): btGhostObject;
+	getNumTriggers(): number;
+	getNumOccupants(id: number): number;
+	update(): number;
+	getNumEnterEvents(): number;
+	getEnterEvents(): number;
+	getNumExitEvents(): number;
+	getExitEvents(): number;
+}
+
+export class btSoftBodyWorldInfo {
+	constructor();
+	get_air_density(): number;
+	set_air_density(value: number): void;
+	get_water_density(): number;
+	set_water_density(value: number): void;
+	get_water_offset(): number;
+	set_water_offset(value: number): void;
+	get_m_maxDisplacement(): number;
+	set_m_maxDisplacement(value: number): void;
+	get_water_normal(): btVector3;
+	set_water_normal(value: btVector3): void;
+	get_m_broadphase(): btBroadphaseInterface;
+	set_m_broadphase(value: btBroadphaseInterface): void;
+	get_m_dispatcher(): btDispatcher;
+	set_m_dispatcher(value: btDispatcher): void;
+	get_m_gravity(): btVector3;
+	set_m_gravity(value: btVector3): void;
+}
+
+export class Node {
+	get_m_x(): btVector3;
+	set_m_x(value: btVector3): void;
+	get_m_n(): btVector3;
+	set_m_n(value: btVector3): void;
+}
+
+export class tNodeArray {
+	size(): number;
+	at(n: number): Node;
+}
+
+export class Material {
+	get_m_kLST(): number;
+	set_m_kLST(value: number): void;
+	get_m_kAST(): number;
+	set_m_kAST(value: number): void;
+	get_m_kVST(): number;
+	set_m_kVST(value: number): void;
+	get_m_flags(): number;
+	set_m_flags(value: number): void;
+}
+
+export class tMaterialArray {
+	size(): number;
+	at(n: number): Material;
+}
+
+export class Config {
+	get_kVCF(): number;
+	set_kVCF(value: number): void;
+	get_kDP(): number;
+	set_kDP(value: number): void;
+	get_kDG(): number;
+	set_kDG(value: number): void;
+	get_kLF(): number;
+	set_kLF(value: number): void;
+	get_kPR(): number;
+	set_kPR(value: number): void;
+	get_kVC(): number;
+	set_kVC(value: number): void;
+	get_kDF(): number;
+	set_kDF(value: number): void;
+	get_kMT(): number;
+	set_kMT(value: number): void;
+	get_kCHR(): number;
+	set_kCHR(value: number): void;
+	get_kKHR(): number;
+	set_kKHR(value: number): void;
+	get_kSHR(): number;
+	set_kSHR(value: number): void;
+	get_kAHR(): number;
+	set_kAHR(value: number): void;
+	get_kSRHR_CL(): number;
+	set_kSRHR_CL(value: number): void;
+	get_kSKHR_CL(): number;
+	set_kSKHR_CL(value: number): void;
+	get_kSSHR_CL(): number;
+	set_kSSHR_CL(value: number): void;
+	get_kSR_SPLT_CL(): number;
+	set_kSR_SPLT_CL(value: number): void;
+	get_kSK_SPLT_CL(): number;
+	set_kSK_SPLT_CL(value: number): void;
+	get_kSS_SPLT_CL(): number;
+	set_kSS_SPLT_CL(value: number): void;
+	get_maxvolume(): number;
+	set_maxvolume(value: number): void;
+	get_timescale(): number;
+	set_timescale(value: number): void;
+	get_viterations(): number;
+	set_viterations(value: number): void;
+	get_piterations(): number;
+	set_piterations(value: number): void;
+	get_diterations(): number;
+	set_diterations(value: number): void;
+	get_citerations(): number;
+	set_citerations(value: number): void;
+	get_collisions(): number;
+	set_collisions(value: number): void;
+}
+
+export class btSoftBody extends btCollisionObject  {
+	constructor(worldInfo: btSoftBodyWorldInfo, node_count: number, x: btVector3, m: number[]);
+	get_m_cfg(): Config;
+	set_m_cfg(value: Config): void;
+	get_m_nodes(): tNodeArray;
+	set_m_nodes(value: tNodeArray): void;
+	get_m_materials(): tMaterialArray;
+	set_m_materials(value: tMaterialArray): void;
+	checkLink(node0: number, node1: number): boolean;
+	checkFace(node0: number, node1: number, node2: number): boolean;
+	appendMaterial(): Material;
+	appendNode(x: btVector3, m: number): void;
+	appendLink(node0: number, node1: number, mat: Material, bcheckexist: boolean): void;
+	appendFace(node0: number, node1: number, node2: number, mat: Material): void;
+	appendTetra(node0: number, node1: number, node2: number, node3: number, mat: Material): void;
+	appendAnchor(node: number, body: btRigidBody, disableCollisionBetweenLinkedBodies: boolean, influence: number): void;
+	getTotalMass(): number;
+	setTotalMass(mass: number, fromfaces: boolean): void;
+	setMass(node: number, mass: number): void;
+	transform(trs: btTransform): void;
+	translate(trs: btVector3): void;
+	rotate(rot: btQuaternion): void;
+	scale(scl: btVector3): void;
+	generateClusters(k: number, maxiterations?: number): number;
+	upcast(colObj: btCollisionObject): btSoftBody;
+}
+
+export class btSoftBodyRigidBodyCollisionConfiguration extends btDefaultCollisionConfiguration  {
+	constructor(info?: btDefaultCollisionConstructionInfo);
+}
+
+export class btSoftBodySolver {
+	get_$__dummyprop__btSoftBodySolver(): any;
+	set_$__dummyprop__btSoftBodySolver(value: any): void;
+}
+
+export class btDefaultSoftBodySolver extends btSoftBodySolver  {
+	constructor();
+}
+
+export class btSoftBodyArray {
+	size(): number;
+	at(n: number): btSoftBody;
+}
+
+export class btSoftRigidDynamicsWorld extends btDiscreteDynamicsWorld  {
+	constructor(dispatcher: btDispatcher, pairCache: btBroadphaseInterface, constraintSolver: btConstraintSolver, collisionConfiguration: btCollisionConfiguration, softBodySolver: btSoftBodySolver);
+	addSoftBody(body: btSoftBody, collisionFilterGroup: number, collisionFilterMask: number): void;
+	removeSoftBody(body: btSoftBody): void;
+	removeCollisionObject(collisionObject: btCollisionObject): void;
+	getWorldInfo(): btSoftBodyWorldInfo;
+	getSoftBodyArray(): btSoftBodyArray;
+}
+
+export class btSoftBodyHelpers {
+	constructor();
+	CreateRope(worldInfo: btSoftBodyWorldInfo, from: btVector3, to: btVector3, res: number, fixeds: number): btSoftBody;
+	CreatePatch(worldInfo: btSoftBodyWorldInfo, corner00: btVector3, corner10: btVector3, corner01: btVector3, corner11: btVector3, resx: number, resy: number, fixeds: number, gendiags: boolean): btSoftBody;
+	CreatePatchUV(worldInfo: btSoftBodyWorldInfo, corner00: btVector3, corner10: btVector3, corner01: btVector3, corner11: btVector3, resx: number, resy: number, fixeds: number, gendiags: boolean, tex_coords: number[]): btSoftBody;
+	CreateEllipsoid(worldInfo: btSoftBodyWorldInfo, center: btVector3, radius: btVector3, res: number): btSoftBody;
+	CreateFromTriMesh(worldInfo: btSoftBodyWorldInfo, vertices: number[], triangles: number[], ntriangles: number, randomizeConstraints: boolean): btSoftBody;
+	CreateFromConvexHull(worldInfo: btSoftBodyWorldInfo, vertices: btVector3, nvertices: number, randomizeConstraints: boolean): btSoftBody;
+}
+
+export class hbrSoftBodyExporter {
+	constructor();
+	setRemap(remap: number, numVertices: number): void;
+	clearRemap(): void;
+	hasRemap(): boolean;
+	getNumVertices(body: btSoftBody): number;
+	exportNodes(body: btSoftBody, positions: number, normals: number): number;
+}
+
 }
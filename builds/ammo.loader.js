@@ -0,0 +1,86 @@
+// Picks the fastest ammo.js build the engine supports and instantiates it. This file is written by hand, make.py
+// does not generate it.
+//
+//   AmmoLoader({ path: 'builds/' }).then(function(Ammo) { ... });
+//
+// Options:
+//   path    - directory (or URL prefix) holding the builds, defaults to this file's directory in node and '' in browsers
+//   builds  - candidate builds in order of preference, defaults to ['simd', 'wasm', 'asm']
+//   module  - object passed to the Ammo() factory (TOTAL_MEMORY, locateFile, ...)
+(function(root) {
+  var FILES = { simd: 'ammo.simd.js', wasm: 'ammo.wasm.js', asm: 'ammo.js' };
+
+  // (func (result v128) i32.const 0 i8x16.splat i8x16.popcnt)
+  var SIMD_PROBE = new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11]);
+
+  var isNode = typeof process === 'object' && process.versions && process.versions.node && typeof require === 'function';
+
+  function supports(build) {
+    if (build === 'asm') return true;
+    if (typeof WebAssembly !== 'object') return false;
+    if (build === 'simd') {
+      try {
+        return WebAssembly.validate(SIMD_PROBE);
+      } catch (e) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  function selectBuild(options) {
+    var builds = options.builds || ['simd', 'wasm', 'asm'];
+    for (var i = 0; i < builds.length; i++) {
+      if (!supports(builds[i])) continue;
+      // In node we can also skip builds that were not made
+      if (isNode && !require('fs').existsSync(require('path').join(options.path, FILES[builds[i]]))) continue;
+      return builds[i];
+    }
+    throw new Error('AmmoLoader: none of ' + builds.join(', ') + ' is supported');
+  }
+
+  function loadFactory(url) {
+    if (isNode) return Promise.resolve(require(url));
+    if (typeof importScripts === 'function') {
+      importScripts(url);
+      return Promise.resolve(root.Ammo);
+    }
+    return new Promise(function(resolve, reject) {
+      var script = document.createElement('script');
+      script.src = url;
+      script.onload = function() { resolve(root.Ammo); };
+      script.onerror = function() { reject(new Error('AmmoLoader: failed to load ' + url)); };
+      document.head.appendChild(script);
+    });
+  }
+
+  function AmmoLoader(options) {
+    options = options || {};
+    if (options.path === undefined) options.path = isNode ? __dirname : '';
+    var build;
+    try {
+      build = selectBuild(options);
+    } catch (e) {
+      return Promise.reject(e);
+    }
+    var url = isNode ? require('path').join(options.path, FILES[build]) : options.path + FILES[build];
+    return loadFactory(url).then(function(factory) {
+      return new Promise(function(resolve) {
+        factory(options.module || {}).then(function(Ammo) {
+          // The module is a thenable itself, resolving a promise with it would never settle
+          delete Ammo.then;
+          Ammo.build = build;
+          resolve(Ammo);
+        });
+      });
+    });
+  }
+
+  AmmoLoader.supports = supports;
+
+  if (typeof module === 'object' && module.exports) {
+    module.exports = AmmoLoader;
+  } else {
+    root.AmmoLoader = AmmoLoader;
+  }
+})(this);
@@ -0,0 +1,206 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "LinearMath/btQuickprof.h"
+#include "hbrActiveSetDynamicsWorld.h"
+
+hbrActiveSetDynamicsWorld::hbrActiveSetDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* pairCache, btConstraintSolver* constraintSolver, btCollisionConfiguration* collisionConfiguration)
+	: btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration)
+{
+	m_forceUpdateAllAabbs = false;
+}
+
+void hbrActiveSetDynamicsWorld::wake(btCollisionObject* object)
+{
+	// Bodies added with mass 0 keep the static flag when they are made kinematic later
+	btRigidBody* body = btRigidBody::upcast(object);
+	if (!body || (body->isStaticObject() && !body->isKinematicObject()) || !body->isActive() || m_awake.find(body))
+		return;
+
+	m_awake.insert(body, 1);
+	m_nonStaticRigidBodies.push_back(body);
+}
+
+void hbrActiveSetDynamicsWorld::trackAddedBody(btRigidBody* body)
+{
+	// btDiscreteDynamicsWorld appends every non-static body, keep it only while it is awake. A kinematic body that kept
+	// the static flag of mass 0 is not appended, nothing wakes it later when it moves in free space.
+	int last = m_nonStaticRigidBodies.size() - 1;
+	if (last < 0 || m_nonStaticRigidBodies[last] != body)
+	{
+		if (body->isKinematicObject())
+			wake(body);
+		return;
+	}
+
+	if (body->isActive())
+		m_awake.insert(body, 1);
+	else
+		m_nonStaticRigidBodies.pop_back();
+}
+
+void hbrActiveSetDynamicsWorld::forget(btCollisionObject* object)
+{
+	m_awake.remove(object);
+	m_activeObjects.remove(object);
+
+	for (int i = m_movedObjects.size() - 1; i >= 0; i--)
+	{
+		if (m_movedObjects[i] == object)
+		{
+			m_movedObjects.swap(i, m_movedObjects.size() - 1);
+			m_movedObjects.pop_back();
+		}
+	}
+}
+
+#if BT_BULLET_VERSION >= 285
+void hbrActiveSetDynamicsWorld::addCollisionObject(btCollisionObject* collisionObject, int collisionFilterGroup, int collisionFilterMask)
+#else
+void hbrActiveSetDynamicsWorld::addCollisionObject(btCollisionObject* collisionObject, short int collisionFilterGroup, short int collisionFilterMask)
+#endif
+{
+	btDiscreteDynamicsWorld::addCollisionObject(collisionObject, collisionFilterGroup, collisionFilterMask);
+
+	// Rigid bodies are tracked by addRigidBody
+	if (!btRigidBody::upcast(collisionObject) && !collisionObject->isStaticObject())
+		m_activeObjects.push_back(collisionObject);
+}
+
+#if BT_BULLET_VERSION >= 285
+void hbrActiveSetDynamicsWorld::addRigidBody(btRigidBody* body, int group, int mask)
+#else
+void hbrActiveSetDynamicsWorld::addRigidBody(btRigidBody* body, short group, short mask)
+#endif
+{
+	btDiscreteDynamicsWorld::addRigidBody(body, group, mask);
+	trackAddedBody(body);
+}
+
+void hbrActiveSetDynamicsWorld::addRigidBody(btRigidBody* body)
+{
+	btDiscreteDynamicsWorld::addRigidBody(body);
+	trackAddedBody(body);
+}
+
+void hbrActiveSetDynamicsWorld::removeRigidBody(btRigidBody* body)
+{
+	forget(body);
+	btDiscreteDynamicsWorld::removeRigidBody(body);
+}
+
+void hbrActiveSetDynamicsWorld::removeCollisionObject(btCollisionObject* collisionObject)
+{
+	forget(collisionObject);
+	btDiscreteDynamicsWorld::removeCollisionObject(collisionObject);
+}
+
+void hbrActiveSetDynamicsWorld::updateAabbs()
+{
+	if (m_forceUpdateAllAabbs)
+	{
+		btDiscreteDynamicsWorld::updateAabbs();
+		m_movedObjects.resize(0);
+		return;
+	}
+
+	BT_PROFILE("updateAabbs");
+
+	for (int i = 0; i < m_nonStaticRigidBodies.size(); i++)
+	{
+		if (m_nonStaticRigidBodies[i]->isActive())
+			updateSingleAabb(m_nonStaticRigidBodies[i]);
+	}
+	for (int i = 0; i < m_activeObjects.size(); i++)
+	{
+		if (m_activeObjects[i]->isActive())
+			updateSingleAabb(m_activeObjects[i]);
+	}
+	for (int i = 0; i < m_movedObjects.size(); i++)
+		updateSingleAabb(m_movedObjects[i]);
+	m_movedObjects.resize(0);
+}
+
+void hbrActiveSetDynamicsWorld::saveKinematicState(btScalar timeStep)
+{
+	BT_PROFILE("saveKinematicState");
+
+	for (int i = 0; i < m_nonStaticRigidBodies.size(); i++)
+	{
+		btRigidBody* body = m_nonStaticRigidBodies[i];
+		if (body->getActivationState() != ISLAND_SLEEPING && body->isKinematicObject())
+			body->saveKinematicState(timeStep);
+	}
+}
+
+void hbrActiveSetDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+
+	// Building the islands woke the sleeping members of every island with an awake body. Islands are joined through
+	// overlapping pairs and constraints, so the woken bodies are found among those and are integrated from this step on.
+	btBroadphasePairArray& pairs = getPairCache()->getOverlappingPairArray();
+	for (int i = 0; i < pairs.size(); i++)
+	{
+		wake(static_cast<btCollisionObject*>(pairs[i].m_pProxy0->m_clientObject));
+		wake(static_cast<btCollisionObject*>(pairs[i].m_pProxy1->m_clientObject));
+	}
+	for (int i = 0; i < m_constraints.size(); i++)
+	{
+		wake(&m_constraints[i]->getRigidBodyA());
+		wake(&m_constraints[i]->getRigidBodyB());
+	}
+}
+
+void hbrActiveSetDynamicsWorld::internalSingleStepSimulation(btScalar timeStep)
+{
+	btDiscreteDynamicsWorld::internalSingleStepSimulation(timeStep);
+
+	// Bodies that fell asleep in this step leave the awake set, their velocities were cleared by updateActivationState
+	int count = 0;
+	for (int i = 0; i < m_nonStaticRigidBodies.size(); i++)
+	{
+		btRigidBody* body = m_nonStaticRigidBodies[i];
+		if (body->getActivationState() == ISLAND_SLEEPING)
+			m_awake.remove(body);
+		else
+			m_nonStaticRigidBodies[count++] = body;
+	}
+	m_nonStaticRigidBodies.resize(count);
+}
+
+void hbrActiveSetDynamicsWorld::activateBody(btCollisionObject* object, bool forceActivation)
+{
+	object->activate(forceActivation);
+	wake(object);
+}
+
+void hbrActiveSetDynamicsWorld::markMoved(btCollisionObject* object)
+{
+	btRigidBody* body = btRigidBody::upcast(object);
+	if (body && body->isKinematicObject())
+		activateBody(body, true);
+	else
+		m_movedObjects.push_back(object);
+}
+
+void hbrActiveSetDynamicsWorld::refreshActiveSet()
+{
+	m_awake.clear();
+	m_nonStaticRigidBodies.resize(0);
+
+	for (int i = 0; i < m_collisionObjects.size(); i++)
+		wake(m_collisionObjects[i]);
+}
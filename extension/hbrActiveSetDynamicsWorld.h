@@ -0,0 +1,77 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_ACTIVE_SET_DYNAMICS_WORLD_H
+#define HBR_ACTIVE_SET_DYNAMICS_WORLD_H
+
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
+#include "LinearMath/btHashMap.h"
+
+///hbrActiveSetDynamicsWorld is a btDiscreteDynamicsWorld whose step only walks the objects that are awake.
+///btDiscreteDynamicsWorld keeps every non-static rigid body in m_nonStaticRigidBodies and visits all of them when it
+///integrates, damps, syncs motion states and clears forces, and visits every collision object to update AABBs and
+///save kinematic state. Here m_nonStaticRigidBodies only holds the awake bodies: a body leaves it when it falls asleep
+///and comes back when it is woken by something it overlaps or is constrained to. AABBs are updated for those bodies,
+///for the ghost objects of the world, and for objects passed to markMoved. Everything else, static scenery and
+///sleeping bodies, is not visited by these passes.
+///The island manager still looks at every object and overlapping pair to find and wake islands.
+///A body woken with btCollisionObject::activate that overlaps nothing is not noticed, use activateBody for those.
+///setSynchronizeAllMotionStates(true) only syncs the awake bodies as well.
+class hbrActiveSetDynamicsWorld : public btDiscreteDynamicsWorld
+{
+protected:
+	///Bodies in m_nonStaticRigidBodies
+	btHashMap<btHashPtr, int> m_awake;
+	///Collision objects that are not rigid bodies, e.g. ghost objects, their AABBs are updated while they are active
+	btAlignedObjectArray<btCollisionObject*> m_activeObjects;
+	///Objects to update the AABB of once in the next step
+	btAlignedObjectArray<btCollisionObject*> m_movedObjects;
+
+	void wake(btCollisionObject * object);
+	void trackAddedBody(btRigidBody * body);
+	void forget(btCollisionObject * object);
+
+	virtual void internalSingleStepSimulation(btScalar timeStep);
+	virtual void solveConstraints(btContactSolverInfo & solverInfo);
+	virtual void saveKinematicState(btScalar timeStep);
+
+public:
+	///Unlike btDiscreteDynamicsWorld, AABBs of objects that are not awake are not updated every step, see
+	///setForceUpdateAllAabbs.
+	hbrActiveSetDynamicsWorld(btDispatcher * dispatcher, btBroadphaseInterface * pairCache, btConstraintSolver * constraintSolver, btCollisionConfiguration * collisionConfiguration);
+
+#if BT_BULLET_VERSION >= 285
+	virtual void addCollisionObject(btCollisionObject * collisionObject, int collisionFilterGroup = btBroadphaseProxy::StaticFilter, int collisionFilterMask = btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+	virtual void addRigidBody(btRigidBody * body, int group, int mask);
+#else
+	virtual void addCollisionObject(btCollisionObject * collisionObject, short int collisionFilterGroup = btBroadphaseProxy::StaticFilter, short int collisionFilterMask = btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+	virtual void addRigidBody(btRigidBody * body, short group, short mask);
+#endif
+	virtual void addRigidBody(btRigidBody * body);
+	virtual void removeRigidBody(btRigidBody * body);
+	virtual void removeCollisionObject(btCollisionObject * collisionObject);
+
+	virtual void updateAabbs();
+
+	///Activates an object and adds it to the awake set right away. Use it for kinematic bodies that were added static.
+	void activateBody(btCollisionObject * object, bool forceActivation = false);
+	///Updates the AABB of an object that is not awake in the next step, after it was moved. Kinematic bodies are
+	///activated instead so their velocity is derived from the motion.
+	void markMoved(btCollisionObject * object);
+	///Rebuilds the awake set from all objects of the world.
+	void refreshActiveSet();
+
+	int getNumActiveBodies() const { return m_nonStaticRigidBodies.size(); }
+	int getNumMovedObjects() const { return m_movedObjects.size(); }
+};
+
+#endif  // HBR_ACTIVE_SET_DYNAMICS_WORLD_H
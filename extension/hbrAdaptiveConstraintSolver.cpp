@@ -0,0 +1,110 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btQuickprof.h"
+#include "hbrAdaptiveConstraintSolver.h"
+
+hbrAdaptiveConstraintSolver::hbrAdaptiveConstraintSolver()
+	: m_adaptive(false),
+	  m_residualThreshold(btScalar(1e-6)),
+	  m_minIterations(2),
+	  m_maxIterations(20),
+	  m_numIslands(0),
+	  m_numIterations(0),
+	  m_maxIslandIterations(0),
+	  m_numUnconverged(0),
+	  m_maxResidual(0)
+{
+}
+
+void hbrAdaptiveConstraintSolver::setIterationLimits(int minIterations, int maxIterations)
+{
+	m_minIterations = btMax(minIterations, 1);
+	m_maxIterations = btMax(maxIterations, m_minIterations);
+}
+
+void hbrAdaptiveConstraintSolver::prepareSolve(int numBodies, int numManifolds)
+{
+	btSequentialImpulseConstraintSolver::prepareSolve(numBodies, numManifolds);
+
+	m_numIslands = 0;
+	m_numIterations = 0;
+	m_maxIslandIterations = 0;
+	m_numUnconverged = 0;
+	m_maxResidual = 0;
+}
+
+btScalar hbrAdaptiveConstraintSolver::solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifoldPtr, int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer, btDispatcher* dispatcher)
+{
+	if (!m_adaptive)
+		return btSequentialImpulseConstraintSolver::solveGroup(bodies, numBodies, manifoldPtr, numManifolds, constraints, numConstraints, info, debugDrawer, dispatcher);
+
+	// solveSingleIteration only solves the contacts while the iteration is below m_numIterations and the constraints
+	// below the count the setup gave them, set both up for the maximum
+	btContactSolverInfo adaptiveInfo = info;
+	adaptiveInfo.m_numIterations = btMax(m_maxIterations, info.m_numIterations);
+	return btSequentialImpulseConstraintSolver::solveGroup(bodies, numBodies, manifoldPtr, numManifolds, constraints, numConstraints, adaptiveInfo, debugDrawer, dispatcher);
+}
+
+btScalar hbrAdaptiveConstraintSolver::solveGroupCacheFriendlyIterations(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifoldPtr, int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& infoGlobal, btIDebugDraw* debugDrawer)
+{
+	BT_PROFILE("solveGroupCacheFriendlyIterations");
+
+	// Islands without contact points or constraints are solved as well, they have nothing to iterate
+	if (m_tmpSolverContactConstraintPool.size() + m_tmpSolverNonContactConstraintPool.size() == 0)
+		return 0.f;
+
+	solveGroupCacheFriendlySplitImpulseIterations(bodies, numBodies, manifoldPtr, numManifolds, constraints, numConstraints, infoGlobal, debugDrawer);
+
+	int minIterations, maxIterations;
+	btScalar threshold;
+	if (m_adaptive)
+	{
+		minIterations = m_minIterations;
+		maxIterations = m_maxIterations;
+		threshold = m_residualThreshold;
+	}
+	else
+	{
+		minIterations = 1;
+		maxIterations = infoGlobal.m_numIterations;
+#if BT_BULLET_VERSION >= 283
+		threshold = infoGlobal.m_leastSquaresResidualThreshold;
+#else
+		threshold = 0;
+#endif
+	}
+	// The largest override of the constraints in this island
+	maxIterations = btMax(maxIterations, m_maxOverrideNumSolverIterations);
+#if BT_BULLET_VERSION < 283
+	// Older solvers do not measure the residual
+	minIterations = maxIterations;
+#endif
+
+	btScalar residual = 0;
+	int iteration = 0;
+	while (iteration < maxIterations)
+	{
+		residual = solveSingleIteration(iteration, bodies, numBodies, manifoldPtr, numManifolds, constraints, numConstraints, infoGlobal, debugDrawer);
+		iteration++;
+		if (iteration >= minIterations && residual <= threshold)
+			break;
+	}
+
+	m_numIslands++;
+	m_numIterations += iteration;
+	m_maxIslandIterations = btMax(m_maxIslandIterations, iteration);
+	m_maxResidual = btMax(m_maxResidual, residual);
+	if (residual > threshold)
+		m_numUnconverged++;
+	return 0.f;
+}
@@ -0,0 +1,68 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_ADAPTIVE_CONSTRAINT_SOLVER_H
+#define HBR_ADAPTIVE_CONSTRAINT_SOLVER_H
+
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
+
+///hbrAdaptiveConstraintSolver is a btSequentialImpulseConstraintSolver that decides per island how many iterations to
+///run. In adaptive mode an island stops once the residual of an iteration (the largest squared impulse correction, the
+///sum of them in older Bullet releases) is at most the residual threshold, after the minimum number of iterations, and
+///iterates up to the maximum while it is above. The maximum may exceed m_numIterations of the solver info, the
+///contacts and constraints are set up for it. btTypedConstraint::setOverrideNumSolverIterations raises the maximum of
+///the island the constraint is in.
+///Without adaptive mode it iterates m_numIterations of the solver info like the base solver.
+///The counters describe the last solve, one per internal step of the world. The world solves small islands together
+///in batches, set m_minimumSolverBatchSize of the solver info to 1 to get the limits per island.
+class hbrAdaptiveConstraintSolver : public btSequentialImpulseConstraintSolver
+{
+protected:
+	bool m_adaptive;
+	btScalar m_residualThreshold;
+	int m_minIterations;
+	int m_maxIterations;
+
+	int m_numIslands;
+	int m_numIterations;
+	int m_maxIslandIterations;
+	int m_numUnconverged;
+	btScalar m_maxResidual;
+
+	virtual btScalar solveGroupCacheFriendlyIterations(btCollisionObject * *bodies, int numBodies, btPersistentManifold** manifoldPtr, int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& infoGlobal, btIDebugDraw* debugDrawer);
+
+public:
+	hbrAdaptiveConstraintSolver();
+
+	virtual void prepareSolve(int numBodies, int numManifolds);
+	virtual btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifoldPtr, int numManifolds, btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer, btDispatcher* dispatcher);
+
+	void setAdaptive(bool adaptive) { m_adaptive = adaptive; }
+	bool getAdaptive() const { return m_adaptive; }
+	void setResidualThreshold(btScalar threshold) { m_residualThreshold = threshold; }
+	btScalar getResidualThreshold() const { return m_residualThreshold; }
+	///Iterations of an island in adaptive mode
+	void setIterationLimits(int minIterations, int maxIterations);
+	int getMinIterations() const { return m_minIterations; }
+	int getMaxIterations() const { return m_maxIterations; }
+
+	///Islands (or batches of them) with contacts or constraints to solve
+	int getNumIslands() const { return m_numIslands; }
+	///Iterations of all islands together
+	int getNumIterations() const { return m_numIterations; }
+	int getMaxIslandIterations() const { return m_maxIslandIterations; }
+	///Islands whose last residual is above the threshold
+	int getNumUnconverged() const { return m_numUnconverged; }
+	btScalar getMaxResidual() const { return m_maxResidual; }
+};
+
+#endif  // HBR_ADAPTIVE_CONSTRAINT_SOLVER_H
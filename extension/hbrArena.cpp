@@ -0,0 +1,414 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "LinearMath/btAlignedAllocator.h"
+#include "hbrArena.h"
+
+// Which arena owns each page of the address space. Sized for wasm32, on larger address spaces chunks beyond 4 GB are
+// not taken and those allocations stay on the heap.
+#define HBR_ARENA_NUM_PAGES (0x100000000ull / HBR_ARENA_PAGE_SIZE)
+// Blocks in a chunk start 8 bytes past a 16 byte boundary, so the memory after their header is 16 byte aligned
+#define HBR_ARENA_BLOCK_OFFSET 8
+#define HBR_ARENA_LARGE_OFFSET 32
+#define HBR_ARENA_LARGE_CLASS 0xffff
+
+struct hbrArenaHeader
+{
+	unsigned int m_size;
+	unsigned short m_sizeClass;
+	unsigned short m_category;
+};
+
+struct hbrArenaChunk
+{
+	hbrArenaChunk* m_next;
+};
+
+struct hbrArenaLargeBlock
+{
+	hbrArenaLargeBlock* m_previous;
+	hbrArenaLargeBlock* m_next;
+	size_t m_bytes;
+};
+
+static hbrArena* hbrArenaOwners[HBR_ARENA_NUM_PAGES];
+
+hbrArena* hbrArena::s_current = 0;
+
+static bool hbrArenaSetOwner(void* base, size_t bytes, hbrArena* owner)
+{
+	size_t first = (size_t)base / HBR_ARENA_PAGE_SIZE;
+	size_t last = ((size_t)base + bytes - 1) / HBR_ARENA_PAGE_SIZE;
+	if (last >= HBR_ARENA_NUM_PAGES)
+	{
+		return false;
+	}
+	for (size_t page = first; page <= last; page++)
+	{
+		hbrArenaOwners[page] = owner;
+	}
+	return true;
+}
+
+static int hbrArenaSizeClass(size_t bytes)
+{
+	if (bytes <= 1024)
+	{
+		return (int)((bytes + 15) / 16) - 1;
+	}
+	int sizeClass = 64;
+	size_t classBytes = 2048;
+	while (classBytes < bytes)
+	{
+		classBytes <<= 1;
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+static size_t hbrArenaClassBytes(int sizeClass)
+{
+	return sizeClass < 64 ? (size_t)(sizeClass + 1) * 16 : (size_t)2048 << (sizeClass - 64);
+}
+
+static void* hbrArenaAlloc(size_t size)
+{
+	hbrArena* arena = hbrArena::getCurrent();
+	void* ptr = arena ? arena->allocate(size) : 0;
+	// An arena that cannot grow leaves the allocation to the heap
+	return ptr ? ptr : malloc(size);
+}
+
+static void hbrArenaFree(void* ptr)
+{
+	hbrArena* owner = hbrArena::findOwner(ptr);
+	if (owner)
+	{
+		owner->deallocate(ptr);
+	}
+	else
+	{
+		free(ptr);
+	}
+}
+
+hbrArena::hbrArena()
+	: m_chunks(0),
+	  m_top(0),
+	  m_end(0),
+	  m_largeBlocks(0),
+	  m_numCategories(0),
+	  m_category(0)
+{
+	reset();
+	addCategory("default");
+}
+
+hbrArena::~hbrArena()
+{
+	deactivate();
+	reset();
+}
+
+void* hbrArena::operator new(size_t size)
+{
+	return malloc(size);
+}
+
+void hbrArena::operator delete(void* ptr)
+{
+	free(ptr);
+}
+
+void hbrArena::activate()
+{
+#if BT_THREADSAFE
+	// The arena is not locked and the workers allocate while the world steps, everything stays on the heap
+#else
+	// Installed on first use, blocks allocated by the default functions before are recognized as heap memory
+	static bool installed = false;
+	if (!installed)
+	{
+		btAlignedAllocSetCustom(hbrArenaAlloc, hbrArenaFree);
+		installed = true;
+	}
+	s_current = this;
+#endif
+}
+
+void hbrArena::deactivate()
+{
+	if (s_current == this)
+	{
+		s_current = 0;
+	}
+}
+
+void hbrArena::reset()
+{
+	while (m_chunks)
+	{
+		hbrArenaChunk* next = m_chunks->m_next;
+		hbrArenaSetOwner(m_chunks, HBR_ARENA_CHUNK_SIZE, 0);
+		free(m_chunks);
+		m_chunks = next;
+	}
+	while (m_largeBlocks)
+	{
+		hbrArenaLargeBlock* next = m_largeBlocks->m_next;
+		hbrArenaSetOwner(m_largeBlocks, m_largeBlocks->m_bytes, 0);
+		free(m_largeBlocks);
+		m_largeBlocks = next;
+	}
+	m_top = 0;
+	m_end = 0;
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+
+	for (int i = 0; i < m_numCategories; i++)
+	{
+		m_categories[i].m_liveBytes = 0;
+		m_categories[i].m_peakBytes = 0;
+		m_categories[i].m_numAllocations = 0;
+		m_categories[i].m_numLiveAllocations = 0;
+	}
+	m_reservedBytes = 0;
+	m_liveBytes = 0;
+	m_peakBytes = 0;
+}
+
+int hbrArena::addCategory(const char* name)
+{
+	for (int i = 0; i < m_numCategories; i++)
+	{
+		if (strncmp(m_categories[i].m_name, name, sizeof(m_categories[i].m_name) - 1) == 0)
+		{
+			return i;
+		}
+	}
+	if (m_numCategories == HBR_ARENA_MAX_CATEGORIES)
+	{
+		return -1;
+	}
+	Category& category = m_categories[m_numCategories];
+	strncpy(category.m_name, name, sizeof(category.m_name) - 1);
+	category.m_name[sizeof(category.m_name) - 1] = 0;
+	category.m_liveBytes = 0;
+	category.m_peakBytes = 0;
+	category.m_numAllocations = 0;
+	category.m_numLiveAllocations = 0;
+	return m_numCategories++;
+}
+
+void hbrArena::setCategory(int category)
+{
+	if (category >= 0 && category < m_numCategories)
+	{
+		m_category = category;
+	}
+}
+
+const char* hbrArena::getCategoryName(int category) const
+{
+	return category >= 0 && category < m_numCategories ? m_categories[category].m_name : "";
+}
+
+int hbrArena::getLiveBytes(int category) const
+{
+	if (category < 0)
+	{
+		return m_liveBytes;
+	}
+	return category < m_numCategories ? m_categories[category].m_liveBytes : 0;
+}
+
+int hbrArena::getPeakBytes(int category) const
+{
+	if (category < 0)
+	{
+		return m_peakBytes;
+	}
+	return category < m_numCategories ? m_categories[category].m_peakBytes : 0;
+}
+
+int hbrArena::getNumAllocations(int category) const
+{
+	int count = 0;
+	for (int i = 0; i < m_numCategories; i++)
+	{
+		if (category < 0 || category == i)
+		{
+			count += m_categories[i].m_numAllocations;
+		}
+	}
+	return count;
+}
+
+int hbrArena::getNumLiveAllocations(int category) const
+{
+	int count = 0;
+	for (int i = 0; i < m_numCategories; i++)
+	{
+		if (category < 0 || category == i)
+		{
+			count += m_categories[i].m_numLiveAllocations;
+		}
+	}
+	return count;
+}
+
+void hbrArena::count(int category, int bytes)
+{
+	Category& counters = m_categories[category];
+	counters.m_liveBytes += bytes;
+	m_liveBytes += bytes;
+	if (bytes > 0)
+	{
+		counters.m_numAllocations++;
+		counters.m_numLiveAllocations++;
+		if (counters.m_liveBytes > counters.m_peakBytes)
+		{
+			counters.m_peakBytes = counters.m_liveBytes;
+		}
+		if (m_liveBytes > m_peakBytes)
+		{
+			m_peakBytes = m_liveBytes;
+		}
+	}
+	else
+	{
+		counters.m_numLiveAllocations--;
+	}
+}
+
+bool hbrArena::addChunk()
+{
+	void* memory = 0;
+	if (posix_memalign(&memory, HBR_ARENA_PAGE_SIZE, HBR_ARENA_CHUNK_SIZE) != 0)
+	{
+		return false;
+	}
+	if (!hbrArenaSetOwner(memory, HBR_ARENA_CHUNK_SIZE, this))
+	{
+		free(memory);
+		return false;
+	}
+	hbrArenaChunk* chunk = (hbrArenaChunk*)memory;
+	chunk->m_next = m_chunks;
+	m_chunks = chunk;
+	m_top = (char*)memory + HBR_ARENA_BLOCK_OFFSET;
+	m_end = (char*)memory + HBR_ARENA_CHUNK_SIZE;
+	m_reservedBytes += HBR_ARENA_CHUNK_SIZE;
+	return true;
+}
+
+void* hbrArena::allocateLarge(size_t size)
+{
+	size_t bytes = (size + HBR_ARENA_LARGE_OFFSET + HBR_ARENA_PAGE_SIZE - 1) / HBR_ARENA_PAGE_SIZE * HBR_ARENA_PAGE_SIZE;
+	void* memory = 0;
+	if (posix_memalign(&memory, HBR_ARENA_PAGE_SIZE, bytes) != 0)
+	{
+		return 0;
+	}
+	if (!hbrArenaSetOwner(memory, bytes, this))
+	{
+		free(memory);
+		return 0;
+	}
+	hbrArenaLargeBlock* block = (hbrArenaLargeBlock*)memory;
+	block->m_previous = 0;
+	block->m_next = m_largeBlocks;
+	block->m_bytes = bytes;
+	if (m_largeBlocks)
+	{
+		m_largeBlocks->m_previous = block;
+	}
+	m_largeBlocks = block;
+	m_reservedBytes += (int)bytes;
+
+	char* ptr = (char*)memory + HBR_ARENA_LARGE_OFFSET;
+	hbrArenaHeader* header = (hbrArenaHeader*)ptr - 1;
+	header->m_size = (unsigned int)size;
+	header->m_sizeClass = HBR_ARENA_LARGE_CLASS;
+	header->m_category = (unsigned short)m_category;
+	count(m_category, (int)size);
+	return ptr;
+}
+
+void* hbrArena::allocate(size_t size)
+{
+	size_t bytes = size + sizeof(hbrArenaHeader);
+	if (bytes > HBR_ARENA_PAGE_SIZE)
+	{
+		return allocateLarge(size);
+	}
+	int sizeClass = hbrArenaSizeClass(bytes);
+	char* block = (char*)m_freeLists[sizeClass];
+	if (block)
+	{
+		m_freeLists[sizeClass] = *(void**)block;
+	}
+	else
+	{
+		size_t blockBytes = hbrArenaClassBytes(sizeClass);
+		if (m_top + blockBytes > m_end && !addChunk())
+		{
+			return 0;
+		}
+		block = m_top;
+		m_top += blockBytes;
+	}
+
+	hbrArenaHeader* header = (hbrArenaHeader*)block;
+	header->m_size = (unsigned int)size;
+	header->m_sizeClass = (unsigned short)sizeClass;
+	header->m_category = (unsigned short)m_category;
+	count(m_category, (int)size);
+	return header + 1;
+}
+
+void hbrArena::deallocate(void* ptr)
+{
+	hbrArenaHeader* header = (hbrArenaHeader*)ptr - 1;
+	count(header->m_category, -(int)header->m_size);
+	if (header->m_sizeClass == HBR_ARENA_LARGE_CLASS)
+	{
+		hbrArenaLargeBlock* block = (hbrArenaLargeBlock*)((char*)ptr - HBR_ARENA_LARGE_OFFSET);
+		if (block->m_previous)
+		{
+			block->m_previous->m_next = block->m_next;
+		}
+		else
+		{
+			m_largeBlocks = block->m_next;
+		}
+		if (block->m_next)
+		{
+			block->m_next->m_previous = block->m_previous;
+		}
+		m_reservedBytes -= (int)block->m_bytes;
+		hbrArenaSetOwner(block, block->m_bytes, 0);
+		free(block);
+		return;
+	}
+	// The free list link overwrites the header
+	int sizeClass = header->m_sizeClass;
+	*(void**)header = m_freeLists[sizeClass];
+	m_freeLists[sizeClass] = header;
+}
+
+hbrArena* hbrArena::findOwner(const void* ptr)
+{
+	size_t page = (size_t)ptr / HBR_ARENA_PAGE_SIZE;
+	return page < HBR_ARENA_NUM_PAGES ? hbrArenaOwners[page] : 0;
+}
@@ -0,0 +1,116 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_ARENA_H
+#define HBR_ARENA_H
+
+#include <stddef.h>
+
+///Arenas reserve heap memory in chunks of HBR_ARENA_CHUNK_SIZE and cut them into blocks of 16 byte steps up to 1 KB
+///and powers of two up to a page. Allocations above that get pages of their own.
+#define HBR_ARENA_PAGE_SIZE (64 * 1024)
+#define HBR_ARENA_CHUNK_SIZE (4 * HBR_ARENA_PAGE_SIZE)
+#define HBR_ARENA_NUM_SIZE_CLASSES 70
+#define HBR_ARENA_MAX_CATEGORIES 16
+
+struct hbrArenaChunk;
+struct hbrArenaLargeBlock;
+
+///hbrArena gives a world (or a level) memory of its own. While an arena is current, every btAlignedAlloc goes to it:
+///every object of a class that declares BT_DECLARE_ALIGNED_ALLOCATOR, i.e. the world, its shapes, bodies and motion
+///states but also btVector3, as well as the arrays they grow while stepping. reset() or destroying the arena then
+///releases all of that at once, in time proportional to the reserved chunks rather than the objects, and without
+///fragmenting the heap for the next level. Memory freed while the arena lives is kept in size class free lists and
+///reused by the arena. Only classes with the plain operator new stay on the heap.
+///
+///The arena has to be current whenever its objects are created, stepped or changed, and no other world may be used
+///while it is. Objects created while it was current, vectors included, must not be destroyed after it was reset, as
+///their memory is gone: drop the JS references instead. Memory allocated elsewhere can be freed at any time, also
+///while an arena is current.
+///The arena is not locked. In the threads build (BT_THREADSAFE) activate() does nothing, and an arena must not be
+///current while an hbrAsyncStepper steps on its own thread.
+///
+///Each allocation is counted in the category that is current in the arena, e.g. setCategory(addCategory("shapes"))
+///before creating the shapes. Category 0 is "default".
+class hbrArena
+{
+protected:
+	struct Category
+	{
+		char m_name[32];
+		int m_liveBytes;
+		int m_peakBytes;
+		int m_numAllocations;
+		int m_numLiveAllocations;
+	};
+
+	hbrArenaChunk* m_chunks;
+	char* m_top;
+	char* m_end;
+	hbrArenaLargeBlock* m_largeBlocks;
+	void* m_freeLists[HBR_ARENA_NUM_SIZE_CLASSES];
+
+	Category m_categories[HBR_ARENA_MAX_CATEGORIES];
+	int m_numCategories;
+	int m_category;
+
+	int m_reservedBytes;
+	int m_liveBytes;
+	int m_peakBytes;
+
+	static hbrArena* s_current;
+
+	bool addChunk();
+	void* allocateLarge(size_t size);
+	void count(int category, int bytes);
+
+public:
+	hbrArena();
+	~hbrArena();
+
+	///The arena object itself always lives on the heap.
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+
+	///Sends the following aligned allocations to this arena, until deactivate() or until another arena is activated.
+	void activate();
+	///Sends allocations back to the heap if this arena is current.
+	void deactivate();
+	bool isActive() const { return s_current == this; }
+	static hbrArena* getCurrent() { return s_current; }
+
+	///Frees everything allocated in the arena and resets the counters. The categories are kept.
+	void reset();
+
+	///Returns the category called name, adding it if needed. Returns -1 if HBR_ARENA_MAX_CATEGORIES are in use.
+	int addCategory(const char* name);
+	void setCategory(int category);
+	int getCategory() const { return m_category; }
+	int getNumCategories() const { return m_numCategories; }
+	const char* getCategoryName(int category) const;
+
+	///Counters of a category, or of the whole arena if category is -1. Allocation counts include the allocations that
+	///were freed again, live counts do not.
+	int getLiveBytes(int category) const;
+	int getPeakBytes(int category) const;
+	int getNumAllocations(int category) const;
+	int getNumLiveAllocations(int category) const;
+	///Heap memory held by the arena, including free lists and the unused end of the last chunk.
+	int getReservedBytes() const { return m_reservedBytes; }
+
+	void* allocate(size_t size);
+	void deallocate(void* ptr);
+	///The arena ptr was allocated in, or null if it came from the heap.
+	static hbrArena* findOwner(const void* ptr);
+};
+
+#endif  // HBR_ARENA_H
@@ -0,0 +1,77 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/CollisionShapes/btConvexPolyhedron.h"
+#include "BulletCollision/CollisionShapes/btShapeHull.h"
+#include "BulletCollision/CollisionShapes/btConvexHullShape.h"
+#include "hbrArrayView.h"
+
+const void* hbrArrayView::vector3ArrayData(const btAlignedObjectArray<btVector3>& array) const
+{
+	return array.size() ? &array[0] : 0;
+}
+
+const void* hbrArrayView::intArrayData(const btAlignedObjectArray<int>& array) const
+{
+	return array.size() ? &array[0] : 0;
+}
+
+int hbrArrayView::copyFaceIndices(const btAlignedObjectArray<btFace>& faces, void* out, int maxInts) const
+{
+	int* dst = static_cast<int*>(out);
+	int needed = 0;
+
+	for (int i = 0; i < faces.size(); i++)
+	{
+		const btAlignedObjectArray<int>& indices = faces[i].m_indices;
+		if (dst && needed + 1 + indices.size() <= maxInts)
+		{
+			dst[needed] = indices.size();
+			for (int j = 0; j < indices.size(); j++)
+			{
+				dst[needed + 1 + j] = indices[j];
+			}
+		}
+		needed += 1 + indices.size();
+	}
+	return needed;
+}
+
+int hbrArrayView::copyFacePlanes(const btAlignedObjectArray<btFace>& faces, void* out, int maxFaces) const
+{
+	float* dst = static_cast<float*>(out);
+	int count = btMin(faces.size(), maxFaces);
+
+	for (int i = 0; i < count; i++)
+	{
+		dst[i * 4 + 0] = faces[i].m_plane[0];
+		dst[i * 4 + 1] = faces[i].m_plane[1];
+		dst[i * 4 + 2] = faces[i].m_plane[2];
+		dst[i * 4 + 3] = faces[i].m_plane[3];
+	}
+	return count;
+}
+
+const void* hbrArrayView::shapeHullVertices(const btShapeHull& hull) const
+{
+	return hull.numVertices() ? hull.getVertexPointer() : 0;
+}
+
+const void* hbrArrayView::shapeHullIndices(const btShapeHull& hull) const
+{
+	return hull.numIndices() ? hull.getIndexPointer() : 0;
+}
+
+const void* hbrArrayView::convexHullPoints(const btConvexHullShape& shape) const
+{
+	return shape.getNumPoints() ? shape.getUnscaledPoints() : 0;
+}
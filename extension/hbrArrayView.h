@@ -0,0 +1,48 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_ARRAY_VIEW_H
+#define HBR_ARRAY_VIEW_H
+
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+struct btFace;
+class btShapeHull;
+class btConvexHullShape;
+
+///hbrArrayView exposes the storage behind btAlignedObjectArray bindings (btVector3Array, btIntArray) and a few
+///other arrays that are read often, so JS can wrap them in a Float32Array or Int32Array view instead of calling
+///at() once per element. btVector3 is stored as four floats, so vector data has a stride of vector3Stride() floats.
+///Views are only valid until the underlying array is resized or freed, and must be rebuilt when the heap grows.
+class hbrArrayView
+{
+public:
+	hbrArrayView() {}
+
+	int vector3Stride() const { return int(sizeof(btVector3) / sizeof(btScalar)); }
+
+	const void* vector3ArrayData(const btAlignedObjectArray<btVector3>& array) const;
+	const void* intArrayData(const btAlignedObjectArray<int>& array) const;
+
+	///btFace keeps its indices in a separate array per face, so faces are flattened into a caller buffer as
+	///[numIndices, index0, index1, ...] per face. Returns the number of ints needed (which may exceed maxInts).
+	int copyFaceIndices(const btAlignedObjectArray<btFace>& faces, void* out, int maxInts) const;
+	///Face planes as (nx, ny, nz, d) floats, up to maxFaces. Returns the number of faces written.
+	int copyFacePlanes(const btAlignedObjectArray<btFace>& faces, void* out, int maxFaces) const;
+
+	const void* shapeHullVertices(const btShapeHull& hull) const;
+	const void* shapeHullIndices(const btShapeHull& hull) const;
+	const void* convexHullPoints(const btConvexHullShape& shape) const;
+};
+
+#endif  // HBR_ARRAY_VIEW_H
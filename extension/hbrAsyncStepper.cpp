@@ -0,0 +1,288 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "hbrHandleTable.h"
+#include "hbrAsyncStepper.h"
+
+// Set in m_middle when it holds a frame the reader has not acquired yet
+#define HBR_FRAME_DIRTY 4
+#define HBR_FRAME_INDEX 3
+
+hbrAsyncStepper::hbrAsyncStepper(btDynamicsWorld* world, hbrHandleTable* handles, int commandCapacity)
+	: m_world(world),
+	  m_handles(handles),
+	  m_back(0),
+	  m_middle(1),
+	  m_front(2),
+	  m_stepsCompleted(0),
+	  m_commandHead(0),
+	  m_commandTail(0),
+	  m_timeStep(btScalar(1.) / btScalar(60.)),
+	  m_maxSubSteps(1),
+	  m_fixedTimeStep(btScalar(1.) / btScalar(60.)),
+	  m_stepsRequested(0),
+	  m_running(false)
+{
+	int capacity = 1;
+	while (capacity < commandCapacity)
+	{
+		capacity <<= 1;
+	}
+	m_commands.resize(capacity);
+	m_commandMask = capacity - 1;
+	m_frameNumbers[0] = m_frameNumbers[1] = m_frameNumbers[2] = 0;
+
+#ifdef HBR_ASYNC_THREADS
+	pthread_mutex_init(&m_mutex, 0);
+	pthread_cond_init(&m_wake, 0);
+#endif
+}
+
+hbrAsyncStepper::~hbrAsyncStepper()
+{
+	stop();
+#ifdef HBR_ASYNC_THREADS
+	pthread_cond_destroy(&m_wake);
+	pthread_mutex_destroy(&m_mutex);
+#endif
+}
+
+bool hbrAsyncStepper::setPublishedHandles(const void* handles, int count)
+{
+	if (m_running)
+	{
+		return false;
+	}
+	const int* h = static_cast<const int*>(handles);
+	m_published.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		m_published[i] = h[i];
+	}
+	m_frames.resize(count * 7 * 3);
+	// Old frames no longer match the handle list
+	for (int i = 0; i < m_frames.size(); i++)
+	{
+		m_frames[i] = (i % 7) == 6 ? 1.0f : 0.0f;
+	}
+	m_frameNumbers[0] = m_frameNumbers[1] = m_frameNumbers[2] = 0;
+	return true;
+}
+
+bool hbrAsyncStepper::pushCommand(int op, int handle, btScalar x, btScalar y, btScalar z, btScalar w)
+{
+	int head = m_commandHead;
+	if (head - __atomic_load_n(&m_commandTail, __ATOMIC_ACQUIRE) > m_commandMask)
+	{
+		return false;
+	}
+	Command& command = m_commands[head & m_commandMask];
+	command.m_op = op;
+	command.m_handle = handle;
+	command.m_args[0] = x;
+	command.m_args[1] = y;
+	command.m_args[2] = z;
+	command.m_args[3] = w;
+	__atomic_store_n(&m_commandHead, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+int hbrAsyncStepper::getNumPendingCommands() const
+{
+	return __atomic_load_n(&m_commandHead, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_commandTail, __ATOMIC_ACQUIRE);
+}
+
+void hbrAsyncStepper::applyCommands()
+{
+	// Commands pushed while this runs wait for the next step
+	int head = __atomic_load_n(&m_commandHead, __ATOMIC_ACQUIRE);
+	int tail = m_commandTail;
+	for (; tail != head; tail++)
+	{
+		const Command& c = m_commands[tail & m_commandMask];
+		const float* a = c.m_args;
+		switch (c.m_op)
+		{
+			case HBR_COMMAND_SET_POSITION:
+				m_handles->setPosition(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_SET_ROTATION:
+				m_handles->setRotation(c.m_handle, a[0], a[1], a[2], a[3]);
+				break;
+			case HBR_COMMAND_SET_LINEAR_VELOCITY:
+				m_handles->setLinearVelocity(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_SET_ANGULAR_VELOCITY:
+				m_handles->setAngularVelocity(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_APPLY_CENTRAL_IMPULSE:
+				m_handles->applyCentralImpulse(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_APPLY_CENTRAL_FORCE:
+				m_handles->applyCentralForce(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_ACTIVATE:
+				m_handles->activate(c.m_handle);
+				break;
+			case HBR_COMMAND_SET_WALK_DIRECTION:
+				m_handles->setWalkDirection(c.m_handle, a[0], a[1], a[2]);
+				break;
+			case HBR_COMMAND_JUMP:
+				m_handles->jump(c.m_handle);
+				break;
+			case HBR_COMMAND_WARP:
+				m_handles->warp(c.m_handle, a[0], a[1], a[2]);
+				break;
+		}
+	}
+	__atomic_store_n(&m_commandTail, tail, __ATOMIC_RELEASE);
+}
+
+void hbrAsyncStepper::publishFrame()
+{
+	int count = m_published.size();
+	if (count)
+	{
+		m_handles->readTransforms(&m_published[0], count, &m_frames[m_back * count * 7]);
+	}
+	m_frameNumbers[m_back] = m_stepsCompleted + 1;
+	m_back = __atomic_exchange_n(&m_middle, m_back | HBR_FRAME_DIRTY, __ATOMIC_ACQ_REL) & HBR_FRAME_INDEX;
+	__atomic_store_n(&m_stepsCompleted, m_stepsCompleted + 1, __ATOMIC_RELEASE);
+}
+
+void hbrAsyncStepper::step(btScalar timeStep, int maxSubSteps, btScalar fixedTimeStep)
+{
+	applyCommands();
+	m_world->stepSimulation(timeStep, maxSubSteps, fixedTimeStep);
+	publishFrame();
+}
+
+bool hbrAsyncStepper::acquireFrame()
+{
+	if (!(__atomic_load_n(&m_middle, __ATOMIC_ACQUIRE) & HBR_FRAME_DIRTY))
+	{
+		return false;
+	}
+	m_front = __atomic_exchange_n(&m_middle, m_front, __ATOMIC_ACQ_REL) & HBR_FRAME_INDEX;
+	return true;
+}
+
+const void* hbrAsyncStepper::getFrame() const
+{
+	if (!m_published.size())
+	{
+		return 0;
+	}
+	return &m_frames[m_front * m_published.size() * 7];
+}
+
+int hbrAsyncStepper::getStepsCompleted() const
+{
+	return __atomic_load_n(&m_stepsCompleted, __ATOMIC_ACQUIRE);
+}
+
+bool hbrAsyncStepper::isThreadingSupported() const
+{
+#ifdef HBR_ASYNC_THREADS
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef HBR_ASYNC_THREADS
+
+void* hbrAsyncStepper::threadMain(void* self)
+{
+	hbrAsyncStepper* stepper = static_cast<hbrAsyncStepper*>(self);
+	pthread_mutex_lock(&stepper->m_mutex);
+	for (;;)
+	{
+		while (stepper->m_running && !stepper->m_stepsRequested)
+		{
+			pthread_cond_wait(&stepper->m_wake, &stepper->m_mutex);
+		}
+		if (!stepper->m_stepsRequested)
+		{
+			break;
+		}
+		stepper->m_stepsRequested--;
+		pthread_mutex_unlock(&stepper->m_mutex);
+
+		stepper->step(stepper->m_timeStep, stepper->m_maxSubSteps, stepper->m_fixedTimeStep);
+
+		pthread_mutex_lock(&stepper->m_mutex);
+	}
+	pthread_mutex_unlock(&stepper->m_mutex);
+	return 0;
+}
+
+bool hbrAsyncStepper::start(btScalar timeStep, int maxSubSteps, btScalar fixedTimeStep)
+{
+	if (m_running)
+	{
+		return false;
+	}
+	m_timeStep = timeStep;
+	m_maxSubSteps = maxSubSteps;
+	m_fixedTimeStep = fixedTimeStep;
+	m_stepsRequested = 0;
+	m_running = true;
+	if (pthread_create(&m_thread, 0, threadMain, this) != 0)
+	{
+		m_running = false;
+		return false;
+	}
+	return true;
+}
+
+void hbrAsyncStepper::requestStep()
+{
+	pthread_mutex_lock(&m_mutex);
+	if (m_running)
+	{
+		m_stepsRequested++;
+		pthread_cond_signal(&m_wake);
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void hbrAsyncStepper::stop()
+{
+	if (!m_running)
+	{
+		return;
+	}
+	pthread_mutex_lock(&m_mutex);
+	m_running = false;
+	pthread_cond_signal(&m_wake);
+	pthread_mutex_unlock(&m_mutex);
+	pthread_join(m_thread, 0);
+}
+
+#else  // HBR_ASYNC_THREADS
+
+bool hbrAsyncStepper::start(btScalar, int, btScalar)
+{
+	return false;
+}
+
+void hbrAsyncStepper::requestStep()
+{
+}
+
+void hbrAsyncStepper::stop()
+{
+}
+
+#endif  // HBR_ASYNC_THREADS
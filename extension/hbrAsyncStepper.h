@@ -0,0 +1,128 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_ASYNC_STEPPER_H
+#define HBR_ASYNC_STEPPER_H
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+#if defined(__EMSCRIPTEN_PTHREADS__) || (!defined(__EMSCRIPTEN__) && !defined(_WIN32))
+#define HBR_ASYNC_THREADS 1
+#include <pthread.h>
+#endif
+
+class btDynamicsWorld;
+class hbrHandleTable;
+
+///hbrAsyncStepper steps a world off the calling thread and publishes every finished frame without blocking the reader.
+///Frames hold the transforms (7 floats each) of a fixed list of hbrHandleTable handles, bodies and characters alike,
+///and live in a lock-free triple buffer: the stepping thread always has a buffer of its own to write, and
+///acquireFrame() swaps the latest finished one to the front. In the threads build the heap is a SharedArrayBuffer,
+///so the main thread reads the front buffer straight from HEAPF32, without copies or postMessage.
+///Inputs go through a single producer, single consumer command queue that is drained at the start of each step.
+///While the stepper runs, only pushCommand, requestStep, acquireFrame and the frame getters may be called from other
+///threads; the world and the handle table belong to the stepping thread. Without pthreads, step() does the same work
+///synchronously.
+class hbrAsyncStepper
+{
+public:
+	///Command operations, x, y, z, w are the hbrHandleTable arguments of the same name
+	enum CommandOp
+	{
+		HBR_COMMAND_SET_POSITION = 1,
+		HBR_COMMAND_SET_ROTATION,
+		HBR_COMMAND_SET_LINEAR_VELOCITY,
+		HBR_COMMAND_SET_ANGULAR_VELOCITY,
+		HBR_COMMAND_APPLY_CENTRAL_IMPULSE,
+		HBR_COMMAND_APPLY_CENTRAL_FORCE,
+		HBR_COMMAND_ACTIVATE,
+		HBR_COMMAND_SET_WALK_DIRECTION,
+		HBR_COMMAND_JUMP,
+		HBR_COMMAND_WARP
+	};
+
+protected:
+	struct Command
+	{
+		int m_op;
+		int m_handle;
+		float m_args[4];
+	};
+
+	btDynamicsWorld* m_world;
+	hbrHandleTable* m_handles;
+
+	btAlignedObjectArray<int> m_published;
+	btAlignedObjectArray<float> m_frames;
+	int m_frameNumbers[3];
+	int m_back;
+	int m_middle;  // buffer index, HBR_FRAME_DIRTY set while the reader has not taken it
+	int m_front;
+	int m_stepsCompleted;
+
+	btAlignedObjectArray<Command> m_commands;
+	int m_commandMask;
+	int m_commandHead;  // written by the producer only
+	int m_commandTail;  // written by the stepping thread only
+
+	btScalar m_timeStep;
+	int m_maxSubSteps;
+	btScalar m_fixedTimeStep;
+	int m_stepsRequested;
+	bool m_running;
+#ifdef HBR_ASYNC_THREADS
+	pthread_t m_thread;
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_wake;
+
+	static void* threadMain(void* self);
+#endif
+
+	void applyCommands();
+	void publishFrame();
+
+public:
+	///commandCapacity is rounded up to a power of two
+	hbrAsyncStepper(btDynamicsWorld* world, hbrHandleTable* handles, int commandCapacity = 1024);
+	~hbrAsyncStepper();
+
+	///Handles whose transforms go into each frame. Returns false while running.
+	bool setPublishedHandles(const void* handles, int count);
+	int getNumPublished() const { return m_published.size(); }
+
+	///Queues a command for the next step. Returns false if the queue is full.
+	bool pushCommand(int op, int handle, btScalar x, btScalar y, btScalar z, btScalar w);
+	int getNumPendingCommands() const;
+
+	///Applies queued commands, steps the world and publishes the frame on the calling thread.
+	void step(btScalar timeStep, int maxSubSteps, btScalar fixedTimeStep);
+
+	///Starts the stepping thread, which runs one step(timeStep, maxSubSteps, fixedTimeStep) per requestStep().
+	///Returns false if threads are not available in this build or it is already running.
+	bool start(btScalar timeStep, int maxSubSteps, btScalar fixedTimeStep);
+	void requestStep();
+	///Finishes the requested steps and joins the thread.
+	void stop();
+	bool isRunning() const { return m_running; }
+	bool isThreadingSupported() const;
+
+	///Makes the latest finished frame the front buffer. Returns true if it is newer than the previous front buffer.
+	bool acquireFrame();
+	///Front buffer, getNumPublished() * 7 floats. Stays valid until the next acquireFrame().
+	const void* getFrame() const;
+	///Number of the step that produced the front buffer, 0 before the first one.
+	int getFrameNumber() const { return m_frameNumbers[m_front]; }
+	int getStepsCompleted() const;
+};
+
+#endif  // HBR_ASYNC_STEPPER_H
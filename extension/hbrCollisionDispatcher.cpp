@@ -0,0 +1,89 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btPoolAllocator.h"
+#include "hbrCollisionDispatcher.h"
+
+hbrCollisionDispatcher::hbrCollisionDispatcher(btCollisionConfiguration* collisionConfiguration)
+	: btCollisionDispatcher(collisionConfiguration),
+	  m_manifoldPoolHighWater(0),
+	  m_manifoldPoolOverflows(0),
+	  m_algorithmPoolHighWater(0),
+	  m_algorithmPoolOverflows(0),
+	  m_instancedCreateFunc(collisionConfiguration, false),
+	  m_swappedInstancedCreateFunc(collisionConfiguration, true)
+{
+	// Compound pairs keep btCompoundCompoundCollisionAlgorithm
+	for (int i = 0; i < MAX_BROADPHASE_COLLISION_TYPES; i++)
+	{
+		if (i == COMPOUND_SHAPE_PROXYTYPE)
+			continue;
+		registerCollisionCreateFunc(COMPOUND_SHAPE_PROXYTYPE, i, &m_instancedCreateFunc);
+		registerCollisionCreateFunc(i, COMPOUND_SHAPE_PROXYTYPE, &m_swappedInstancedCreateFunc);
+	}
+}
+
+btPersistentManifold* hbrCollisionDispatcher::getNewManifold(const btCollisionObject* b0, const btCollisionObject* b1)
+{
+	if (m_persistentManifoldPoolAllocator->getFreeCount() == 0)
+	{
+		m_manifoldPoolOverflows++;
+	}
+	btPersistentManifold* manifold = btCollisionDispatcher::getNewManifold(b0, b1);
+	m_manifoldPoolHighWater = btMax(m_manifoldPoolHighWater, getManifoldPoolUsed());
+	return manifold;
+}
+
+void* hbrCollisionDispatcher::allocateCollisionAlgorithm(int size)
+{
+	// Algorithms larger than the pool elements, e.g. of create functions registered later, do not fit into a slot
+	if (size > m_collisionAlgorithmPoolAllocator->getElementSize())
+	{
+		m_algorithmPoolOverflows++;
+		return btAlignedAlloc(static_cast<size_t>(size), 16);
+	}
+	if (m_collisionAlgorithmPoolAllocator->getFreeCount() == 0)
+	{
+		m_algorithmPoolOverflows++;
+	}
+	void* memory = btCollisionDispatcher::allocateCollisionAlgorithm(size);
+	m_algorithmPoolHighWater = btMax(m_algorithmPoolHighWater, getAlgorithmPoolUsed());
+	return memory;
+}
+
+int hbrCollisionDispatcher::getManifoldPoolSize() const
+{
+	return m_persistentManifoldPoolAllocator->getMaxCount();
+}
+
+int hbrCollisionDispatcher::getManifoldPoolUsed() const
+{
+	return m_persistentManifoldPoolAllocator->getMaxCount() - m_persistentManifoldPoolAllocator->getFreeCount();
+}
+
+int hbrCollisionDispatcher::getAlgorithmPoolSize() const
+{
+	return m_collisionAlgorithmPoolAllocator->getMaxCount();
+}
+
+int hbrCollisionDispatcher::getAlgorithmPoolUsed() const
+{
+	return m_collisionAlgorithmPoolAllocator->getMaxCount() - m_collisionAlgorithmPoolAllocator->getFreeCount();
+}
+
+void hbrCollisionDispatcher::resetCounters()
+{
+	m_manifoldPoolHighWater = getManifoldPoolUsed();
+	m_manifoldPoolOverflows = 0;
+	m_algorithmPoolHighWater = getAlgorithmPoolUsed();
+	m_algorithmPoolOverflows = 0;
+}
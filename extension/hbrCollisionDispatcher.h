@@ -0,0 +1,57 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_COLLISION_DISPATCHER_H
+#define HBR_COLLISION_DISPATCHER_H
+
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
+#include "hbrInstancedCollisionAlgorithm.h"
+
+///hbrCollisionDispatcher is a btCollisionDispatcher that watches the persistent manifold and collision algorithm pools
+///of its collision configuration. Once a pool is used up Bullet falls back to btAlignedAlloc for every further
+///manifold or algorithm, as does the dispatcher for algorithms larger than the pool elements. The overflow counters
+///count those allocations. Together with the high water marks they tell
+///how large to make the pools of a level through btDefaultCollisionConstructionInfo.
+///Counters are kept by the calling thread, do not use it with btDiscreteDynamicsWorldMt.
+///It also collides hbrInstancedShape with hbrInstancedCollisionAlgorithm, which only visits the overlapping instances.
+class hbrCollisionDispatcher : public btCollisionDispatcher
+{
+protected:
+	int m_manifoldPoolHighWater;
+	int m_manifoldPoolOverflows;
+	int m_algorithmPoolHighWater;
+	int m_algorithmPoolOverflows;
+
+	hbrInstancedCollisionAlgorithm::CreateFunc m_instancedCreateFunc;
+	hbrInstancedCollisionAlgorithm::CreateFunc m_swappedInstancedCreateFunc;
+
+public:
+	hbrCollisionDispatcher(btCollisionConfiguration * collisionConfiguration);
+
+	virtual btPersistentManifold* getNewManifold(const btCollisionObject* b0, const btCollisionObject* b1);
+	virtual void* allocateCollisionAlgorithm(int size);
+
+	int getManifoldPoolSize() const;
+	int getManifoldPoolUsed() const;
+	int getManifoldPoolHighWater() const { return m_manifoldPoolHighWater; }
+	int getManifoldPoolOverflows() const { return m_manifoldPoolOverflows; }
+
+	int getAlgorithmPoolSize() const;
+	int getAlgorithmPoolUsed() const;
+	int getAlgorithmPoolHighWater() const { return m_algorithmPoolHighWater; }
+	int getAlgorithmPoolOverflows() const { return m_algorithmPoolOverflows; }
+
+	///Clears the overflow counters and lowers the high water marks to the current use, e.g. when a level starts.
+	void resetCounters();
+};
+
+#endif  // HBR_COLLISION_DISPATCHER_H
@@ -0,0 +1,153 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "hbrCollisionLayers.h"
+
+static bool hbrValidLayer(int layer)
+{
+	return layer >= 0 && layer < HBR_MAX_COLLISION_LAYERS;
+}
+
+///Removes pairs that the layer matrix rejects, the pair cache cleans up their collision algorithms
+struct hbrLayerPairCleaner : public btOverlapCallback
+{
+	const hbrCollisionLayers* m_layers;
+	int m_removed;
+
+	hbrLayerPairCleaner(const hbrCollisionLayers* layers)
+		: m_layers(layers),
+		  m_removed(0)
+	{
+	}
+
+	virtual bool processOverlap(btBroadphasePair& pair)
+	{
+		if (m_layers->needBroadphaseCollision(pair.m_pProxy0, pair.m_pProxy1))
+			return false;
+
+		m_removed++;
+		return true;
+	}
+};
+
+hbrCollisionLayers::hbrCollisionLayers()
+{
+	enableAll();
+}
+
+void hbrCollisionLayers::setLayerCollision(int layerA, int layerB, bool enable)
+{
+	if (!hbrValidLayer(layerA) || !hbrValidLayer(layerB))
+		return;
+
+	if (enable)
+	{
+		m_matrix[layerA] |= 1u << layerB;
+		m_matrix[layerB] |= 1u << layerA;
+	}
+	else
+	{
+		m_matrix[layerA] &= ~(1u << layerB);
+		m_matrix[layerB] &= ~(1u << layerA);
+	}
+}
+
+bool hbrCollisionLayers::getLayerCollision(int layerA, int layerB) const
+{
+	return hbrValidLayer(layerA) && hbrValidLayer(layerB) && collides(layerA, layerB);
+}
+
+void hbrCollisionLayers::setLayerMask(int layer, int mask)
+{
+	if (!hbrValidLayer(layer))
+		return;
+
+	for (int other = 0; other < HBR_MAX_COLLISION_LAYERS; other++)
+	{
+		setLayerCollision(layer, other, ((unsigned int)mask >> other) & 1);
+	}
+}
+
+int hbrCollisionLayers::getLayerMask(int layer) const
+{
+	return hbrValidLayer(layer) ? int(m_matrix[layer]) : 0;
+}
+
+void hbrCollisionLayers::enableAll()
+{
+	for (int i = 0; i < HBR_MAX_COLLISION_LAYERS; i++)
+	{
+		m_matrix[i] = ~0u;
+	}
+}
+
+void hbrCollisionLayers::disableAll()
+{
+	for (int i = 0; i < HBR_MAX_COLLISION_LAYERS; i++)
+	{
+		m_matrix[i] = 0;
+	}
+}
+
+bool hbrCollisionLayers::setObjectLayer(btCollisionObject* object, int layer)
+{
+	if (!object || !object->getBroadphaseHandle() || !hbrValidLayer(layer))
+		return false;
+
+	btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+	proxy->m_collisionFilterGroup = getLayerGroup(layer);
+	proxy->m_collisionFilterMask = int(m_matrix[layer]);
+	return true;
+}
+
+int hbrCollisionLayers::getObjectLayer(const btCollisionObject* object) const
+{
+	if (!object || !object->getBroadphaseHandle())
+		return -1;
+	return layerOf(object->getBroadphaseHandle()->m_collisionFilterGroup);
+}
+
+void hbrCollisionLayers::setRayQueryLayer(btCollisionWorld::RayResultCallback& callback, int layer) const
+{
+	if (!hbrValidLayer(layer))
+		return;
+
+	callback.m_collisionFilterGroup = getLayerGroup(layer);
+	callback.m_collisionFilterMask = int(m_matrix[layer]);
+}
+
+void hbrCollisionLayers::setConvexQueryLayer(btCollisionWorld::ConvexResultCallback& callback, int layer) const
+{
+	if (!hbrValidLayer(layer))
+		return;
+
+	callback.m_collisionFilterGroup = getLayerGroup(layer);
+	callback.m_collisionFilterMask = int(m_matrix[layer]);
+}
+
+int hbrCollisionLayers::refresh(btCollisionWorld* world)
+{
+	btCollisionObjectArray& objects = world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btBroadphaseProxy* proxy = objects[i]->getBroadphaseHandle();
+		if (proxy)
+		{
+			proxy->m_collisionFilterMask = int(m_matrix[layerOf(proxy->m_collisionFilterGroup)]);
+		}
+	}
+
+	hbrLayerPairCleaner cleaner(this);
+	world->getPairCache()->processAllOverlappingPairs(&cleaner, world->getDispatcher());
+	return cleaner.m_removed;
+}
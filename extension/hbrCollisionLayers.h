@@ -0,0 +1,84 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_COLLISION_LAYERS_H
+#define HBR_COLLISION_LAYERS_H
+
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+
+#define HBR_MAX_COLLISION_LAYERS 32
+
+///hbrCollisionLayers is a symmetric 32x32 matrix of which collision layers interact, one bit per layer pair.
+///An object on layer n gets the broadphase group 1 << n and the matrix row of n as its mask, so queries and callbacks
+///that use the regular group/mask test agree with the matrix. Installed as the overlap filter callback of the pair
+///cache, pair creation reads the packed table directly with a single bit test.
+///Objects with a group of more than one bit are treated as being on the layer of their lowest bit.
+class hbrCollisionLayers : public btOverlapFilterCallback
+{
+protected:
+	unsigned int m_matrix[HBR_MAX_COLLISION_LAYERS];
+
+public:
+	hbrCollisionLayers();
+
+	static int layerOf(int group)
+	{
+		if (!group)
+			return 0;
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz((unsigned int)group);
+#else
+		int layer = 0;
+		while (!(group & (1 << layer)))
+			layer++;
+		return layer;
+#endif
+	}
+
+	bool collides(int layerA, int layerB) const { return (m_matrix[layerA] >> layerB) & 1; }
+
+	///Single bit test of a query or object group against a proxy.
+	bool needsCollision(int group, const btBroadphaseProxy* proxy) const
+	{
+		return (m_matrix[layerOf(group)] & (unsigned int)proxy->m_collisionFilterGroup) != 0;
+	}
+
+	virtual bool needBroadphaseCollision(btBroadphaseProxy * proxy0, btBroadphaseProxy * proxy1) const
+	{
+		return needsCollision(proxy0->m_collisionFilterGroup, proxy1);
+	}
+
+	void setLayerCollision(int layerA, int layerB, bool enable);
+	bool getLayerCollision(int layerA, int layerB) const;
+	///Sets the row of a layer and mirrors it into the other rows.
+	void setLayerMask(int layer, int mask);
+	int getLayerMask(int layer) const;
+	void enableAll();
+	void disableAll();
+
+	int getLayerGroup(int layer) const { return 1 << layer; }
+
+	///Moves an object that is already in a world to a layer. Existing pairs are kept until the next refresh.
+	bool setObjectLayer(btCollisionObject * object, int layer);
+	int getObjectLayer(const btCollisionObject* object) const;
+
+	///Filter for queries from the given layer.
+	void setRayQueryLayer(btCollisionWorld::RayResultCallback & callback, int layer) const;
+	void setConvexQueryLayer(btCollisionWorld::ConvexResultCallback & callback, int layer) const;
+
+	///After changing the matrix, rewrites the masks of all objects in the world from their layer's row and removes
+	///overlapping pairs the matrix no longer allows. Returns the number of removed pairs.
+	int refresh(btCollisionWorld * world);
+};
+
+#endif  // HBR_COLLISION_LAYERS_H
@@ -0,0 +1,197 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btMotionState.h"
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "BulletDynamics/ConstraintSolver/btPoint2PointConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btHingeConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btConeTwistConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btSliderConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btGeneric6DofConstraint.h"
+#if BT_BULLET_VERSION >= 283
+#include "BulletDynamics/ConstraintSolver/btGeneric6DofSpring2Constraint.h"
+#endif
+#include "hbrKinematicCharacterController.h"
+#include "hbrFloatingOrigin.h"
+
+hbrFloatingOrigin::hbrFloatingOrigin(btDiscreteDynamicsWorld* world)
+	: m_world(world),
+	  m_origin(0, 0, 0)
+{
+}
+
+void hbrFloatingOrigin::addCharacter(hbrKinematicCharacterController* character)
+{
+	if (character && m_characters.findLinearSearch(character) == m_characters.size())
+		m_characters.push_back(character);
+}
+
+void hbrFloatingOrigin::removeCharacter(hbrKinematicCharacterController* character)
+{
+	m_characters.remove(character);
+}
+
+void hbrFloatingOrigin::shiftTree(btDbvt& tree, const btVector3& offset)
+{
+	if (!tree.m_root)
+		return;
+
+	btAlignedObjectArray<btDbvtNode*> stack;
+	stack.push_back(tree.m_root);
+	while (stack.size())
+	{
+		btDbvtNode* node = stack[stack.size() - 1];
+		stack.pop_back();
+
+		// Margins and the shape of the tree stay the same, only the volumes move
+		node->volume.tMins() += offset;
+		node->volume.tMaxs() += offset;
+		if (node->isinternal())
+		{
+			stack.push_back(node->childs[0]);
+			stack.push_back(node->childs[1]);
+		}
+		else
+		{
+			btBroadphaseProxy* proxy = static_cast<btBroadphaseProxy*>(node->data);
+			proxy->m_aabbMin += offset;
+			proxy->m_aabbMax += offset;
+		}
+	}
+}
+
+static btTransform hbrShiftFrame(const btTransform& frame, bool anchored, const btVector3& offset)
+{
+	btTransform shifted = frame;
+	if (anchored)
+		shifted.getOrigin() += offset;
+	return shifted;
+}
+
+void hbrFloatingOrigin::shiftConstraint(btTypedConstraint* constraint, const btVector3& offset)
+{
+	// The single body constructors attach the other side to the fixed body, its pivot or frame is in world space
+	bool anchoredA = &constraint->getRigidBodyA() == &btTypedConstraint::getFixedBody();
+	bool anchoredB = &constraint->getRigidBodyB() == &btTypedConstraint::getFixedBody();
+	if (!anchoredA && !anchoredB)
+		return;
+
+	switch (constraint->getConstraintType())
+	{
+		case POINT2POINT_CONSTRAINT_TYPE:
+		{
+			btPoint2PointConstraint* p2p = static_cast<btPoint2PointConstraint*>(constraint);
+			if (anchoredA)
+				p2p->setPivotA(p2p->getPivotInA() + offset);
+			if (anchoredB)
+				p2p->setPivotB(p2p->getPivotInB() + offset);
+			break;
+		}
+		case HINGE_CONSTRAINT_TYPE:
+		{
+			btHingeConstraint* hinge = static_cast<btHingeConstraint*>(constraint);
+			hinge->setFrames(hbrShiftFrame(hinge->getAFrame(), anchoredA, offset), hbrShiftFrame(hinge->getBFrame(), anchoredB, offset));
+			break;
+		}
+		case CONETWIST_CONSTRAINT_TYPE:
+		{
+			btConeTwistConstraint* coneTwist = static_cast<btConeTwistConstraint*>(constraint);
+			coneTwist->setFrames(hbrShiftFrame(coneTwist->getAFrame(), anchoredA, offset), hbrShiftFrame(coneTwist->getBFrame(), anchoredB, offset));
+			break;
+		}
+		case SLIDER_CONSTRAINT_TYPE:
+		{
+			btSliderConstraint* slider = static_cast<btSliderConstraint*>(constraint);
+			slider->setFrames(hbrShiftFrame(slider->getFrameOffsetA(), anchoredA, offset), hbrShiftFrame(slider->getFrameOffsetB(), anchoredB, offset));
+			break;
+		}
+		case D6_CONSTRAINT_TYPE:
+		case D6_SPRING_CONSTRAINT_TYPE:
+		{
+			btGeneric6DofConstraint* dof = static_cast<btGeneric6DofConstraint*>(constraint);
+			dof->setFrames(hbrShiftFrame(dof->getFrameOffsetA(), anchoredA, offset), hbrShiftFrame(dof->getFrameOffsetB(), anchoredB, offset));
+			break;
+		}
+#if BT_BULLET_VERSION >= 283
+		case D6_SPRING_2_CONSTRAINT_TYPE:
+		{
+			btGeneric6DofSpring2Constraint* dof = static_cast<btGeneric6DofSpring2Constraint*>(constraint);
+			dof->setFrames(hbrShiftFrame(dof->getFrameOffsetA(), anchoredA, offset), hbrShiftFrame(dof->getFrameOffsetB(), anchoredB, offset));
+			break;
+		}
+#endif
+		default:
+			break;
+	}
+}
+
+void hbrFloatingOrigin::rebase(btScalar x, btScalar y, btScalar z)
+{
+	btVector3 offset(-x, -y, -z);
+	m_origin += btVector3(x, y, z);
+
+	btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btCollisionObject* object = objects[i];
+		object->getWorldTransform().getOrigin() += offset;
+		btTransform interpolation = object->getInterpolationWorldTransform();
+		interpolation.getOrigin() += offset;
+		object->setInterpolationWorldTransform(interpolation);
+
+		btRigidBody* body = btRigidBody::upcast(object);
+		if (body && body->getMotionState())
+		{
+			btTransform transform;
+			body->getMotionState()->getWorldTransform(transform);
+			transform.getOrigin() += offset;
+			body->getMotionState()->setWorldTransform(transform);
+		}
+	}
+
+	for (int i = 0; i < m_world->getNumConstraints(); i++)
+		shiftConstraint(m_world->getConstraint(i), offset);
+
+	for (int i = 0; i < m_characters.size(); i++)
+		m_characters[i]->shiftOrigin(offset);
+
+	// Contact points are refreshed from their local points every step, their world positions only until then
+	btDispatcher* dispatcher = m_world->getDispatcher();
+	for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+	{
+		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+		for (int j = 0; j < manifold->getNumContacts(); j++)
+		{
+			btManifoldPoint& point = manifold->getContactPoint(j);
+			point.m_positionWorldOnA += offset;
+			point.m_positionWorldOnB += offset;
+		}
+	}
+
+	btBroadphaseInterface* broadphase = m_world->getBroadphase();
+	btDbvtBroadphase* dbvt = dynamic_cast<btDbvtBroadphase*>(broadphase);
+	if (dbvt)
+	{
+		shiftTree(dbvt->m_sets[0], offset);
+		shiftTree(dbvt->m_sets[1], offset);
+		return;
+	}
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->getBroadphaseHandle())
+			m_world->updateSingleAabb(objects[i]);
+	}
+}
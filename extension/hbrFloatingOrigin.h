@@ -0,0 +1,55 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_FLOATING_ORIGIN_H
+#define HBR_FLOATING_ORIGIN_H
+
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btDiscreteDynamicsWorld;
+class btTypedConstraint;
+struct btDbvt;
+class hbrKinematicCharacterController;
+
+///hbrFloatingOrigin keeps large worlds precise by moving their origin close to the action. rebase(x, y, z) moves the
+///origin to x, y, z in one pass: every collision object (bodies, ghosts, static geometry) with its interpolation
+///transform, every rigid body's motion state, the cached contact points and the characters added with addCharacter
+///are translated by -(x, y, z). Constraints created with a single body are anchored to the world, their pivot or
+///frame there moves along (point to point, hinge, cone twist, slider and the 6dof constraints).
+///With a btDbvtBroadphase the tree is translated in place, so no proxy is reinserted and the pair cache stays as it
+///is. Other broadphases get the new AABB of every object.
+///Soft bodies, and positions the game keeps itself (kinematic targets, camera, ...), are not moved.
+class hbrFloatingOrigin
+{
+protected:
+	btDiscreteDynamicsWorld* m_world;
+	btAlignedObjectArray<hbrKinematicCharacterController*> m_characters;
+	btVector3 m_origin;
+
+	void shiftTree(btDbvt & tree, const btVector3& offset);
+	void shiftConstraint(btTypedConstraint * constraint, const btVector3& offset);
+
+public:
+	hbrFloatingOrigin(btDiscreteDynamicsWorld * world);
+
+	void addCharacter(hbrKinematicCharacterController * character);
+	void removeCharacter(hbrKinematicCharacterController * character);
+	int getNumCharacters() const { return m_characters.size(); }
+
+	///Moves the origin to x, y, z of the current coordinates.
+	void rebase(btScalar x, btScalar y, btScalar z);
+	///Sum of all rebases, i.e. where the current origin is in the coordinates the world started with.
+	const btVector3& getOrigin() const { return m_origin; }
+};
+
+#endif  // HBR_FLOATING_ORIGIN_H
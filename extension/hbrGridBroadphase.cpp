@@ -0,0 +1,464 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "LinearMath/btAabbUtil2.h"
+#include "hbrGridBroadphase.h"
+
+hbrGridBroadphase::hbrGridBroadphase(btScalar cellSize, int upAxis, btOverlappingPairCache* pairCache)
+	: m_cellSize(cellSize),
+	  m_invCellSize(btScalar(1) / cellSize),
+	  m_axis0((upAxis + 1) % 3),
+	  m_axis1((upAxis + 2) % 3),
+	  m_pairCache(pairCache),
+	  m_ownsPairCache(pairCache == 0),
+	  m_uniqueId(0),
+	  m_stamp(0)
+{
+	if (m_ownsPairCache)
+	{
+		void* memory = btAlignedAlloc(sizeof(btHashedOverlappingPairCache), 16);
+		m_pairCache = new (memory) btHashedOverlappingPairCache();
+	}
+}
+
+hbrGridBroadphase::~hbrGridBroadphase()
+{
+	for (int i = 0; i < m_proxies.size(); i++)
+		delete m_proxies[i];
+	for (int i = 0; i < m_largeProxies.size(); i++)
+		delete m_largeProxies[i];
+	if (m_ownsPairCache)
+	{
+		m_pairCache->~btOverlappingPairCache();
+		btAlignedFree(m_pairCache);
+	}
+}
+
+int hbrGridBroadphase::cellCoordinate(btScalar value) const
+{
+	btScalar cell = btFloor(value * m_invCellSize);
+	// Keeps the conversion defined for huge and infinite coordinates, the hash wraps long before this anyway
+	return int(btMax(btScalar(-(1 << 30)), btMin(cell, btScalar(1 << 30))));
+}
+
+bool hbrGridBroadphase::computeCells(const btVector3& aabbMin, const btVector3& aabbMax, int cellMin[2], int cellMax[2]) const
+{
+	btScalar extent0 = btFloor(aabbMax[m_axis0] * m_invCellSize) - btFloor(aabbMin[m_axis0] * m_invCellSize) + 1;
+	btScalar extent1 = btFloor(aabbMax[m_axis1] * m_invCellSize) - btFloor(aabbMin[m_axis1] * m_invCellSize) + 1;
+	// Written so that NaN extents count as large as well
+	if (!(extent0 * extent1 <= HBR_GRID_MAX_PROXY_CELLS))
+		return false;
+	cellMin[0] = cellCoordinate(aabbMin[m_axis0]);
+	cellMin[1] = cellCoordinate(aabbMin[m_axis1]);
+	cellMax[0] = cellCoordinate(aabbMax[m_axis0]);
+	cellMax[1] = cellCoordinate(aabbMax[m_axis1]);
+	return true;
+}
+
+static inline int hbrGridCellKey(int x, int y)
+{
+	return int((unsigned(x) & 0xffff) | (unsigned(y) << 16));
+}
+
+btAlignedObjectArray<hbrGridBroadphaseProxy*>* hbrGridBroadphase::findCell(int x, int y)
+{
+	int* index = m_cellIndices.find(btHashInt(hbrGridCellKey(x, y)));
+	return index ? &m_cells[*index] : 0;
+}
+
+btAlignedObjectArray<hbrGridBroadphaseProxy*>& hbrGridBroadphase::getCell(int x, int y)
+{
+	btHashInt key(hbrGridCellKey(x, y));
+	int* index = m_cellIndices.find(key);
+	if (index)
+		return m_cells[*index];
+	m_cellIndices.insert(key, m_cells.size());
+	return m_cells.expand();
+}
+
+static inline bool hbrGridInRange(int x, int y, const int cellMin[2], const int cellMax[2])
+{
+	return x >= cellMin[0] && x <= cellMax[0] && y >= cellMin[1] && y <= cellMax[1];
+}
+
+void hbrGridBroadphase::insertCells(hbrGridBroadphaseProxy* proxy, const int cellMin[2], const int cellMax[2], const int skipMin[2], const int skipMax[2])
+{
+	for (int x = cellMin[0]; x <= cellMax[0]; x++)
+	{
+		for (int y = cellMin[1]; y <= cellMax[1]; y++)
+		{
+			if (!hbrGridInRange(x, y, skipMin, skipMax))
+				getCell(x, y).push_back(proxy);
+		}
+	}
+}
+
+void hbrGridBroadphase::removeCells(hbrGridBroadphaseProxy* proxy, const int cellMin[2], const int cellMax[2], const int skipMin[2], const int skipMax[2])
+{
+	for (int x = cellMin[0]; x <= cellMax[0]; x++)
+	{
+		for (int y = cellMin[1]; y <= cellMax[1]; y++)
+		{
+			if (hbrGridInRange(x, y, skipMin, skipMax))
+				continue;
+			btAlignedObjectArray<hbrGridBroadphaseProxy*>* cell = findCell(x, y);
+			if (!cell)
+				continue;
+			int index = cell->findLinearSearch(proxy);
+			if (index < cell->size())
+			{
+				cell->swap(index, cell->size() - 1);
+				cell->pop_back();
+			}
+		}
+	}
+}
+
+void hbrGridBroadphase::insertProxy(hbrGridBroadphaseProxy* proxy)
+{
+	static const int none[2] = {1, 1}, noneMax[2] = {0, 0};
+	proxy->m_large = !computeCells(proxy->m_aabbMin, proxy->m_aabbMax, proxy->m_cellMin, proxy->m_cellMax);
+	btAlignedObjectArray<hbrGridBroadphaseProxy*>& list = proxy->m_large ? m_largeProxies : m_proxies;
+	proxy->m_index = list.size();
+	list.push_back(proxy);
+	if (!proxy->m_large)
+		insertCells(proxy, proxy->m_cellMin, proxy->m_cellMax, none, noneMax);
+}
+
+void hbrGridBroadphase::removeProxy(hbrGridBroadphaseProxy* proxy)
+{
+	static const int none[2] = {1, 1}, noneMax[2] = {0, 0};
+	btAlignedObjectArray<hbrGridBroadphaseProxy*>& list = proxy->m_large ? m_largeProxies : m_proxies;
+	if (!proxy->m_large)
+		removeCells(proxy, proxy->m_cellMin, proxy->m_cellMax, none, noneMax);
+	list[proxy->m_index] = list[list.size() - 1];
+	list[proxy->m_index]->m_index = proxy->m_index;
+	list.pop_back();
+	proxy->m_index = -1;
+}
+
+void hbrGridBroadphase::markMoved(hbrGridBroadphaseProxy* proxy)
+{
+	if (proxy->m_movedIndex >= 0)
+		return;
+	proxy->m_movedIndex = m_movedProxies.size();
+	m_movedProxies.push_back(proxy);
+}
+
+btBroadphaseProxy* hbrGridBroadphase::addProxy(const btVector3& aabbMin, const btVector3& aabbMax, void* userPtr, int collisionFilterGroup, int collisionFilterMask)
+{
+	hbrGridBroadphaseProxy* proxy = new hbrGridBroadphaseProxy(aabbMin, aabbMax, userPtr, collisionFilterGroup, collisionFilterMask);
+	proxy->m_uniqueId = ++m_uniqueId;
+	insertProxy(proxy);
+	// Its pairs are found with the next calculateOverlappingPairs
+	markMoved(proxy);
+	return proxy;
+}
+
+#if BT_BULLET_VERSION >= 285
+btBroadphaseProxy* hbrGridBroadphase::createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, int collisionFilterGroup, int collisionFilterMask, btDispatcher* dispatcher)
+{
+	(void)shapeType;
+	(void)dispatcher;
+	return addProxy(aabbMin, aabbMax, userPtr, collisionFilterGroup, collisionFilterMask);
+}
+#else
+btBroadphaseProxy* hbrGridBroadphase::createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, short int collisionFilterGroup, short int collisionFilterMask, btDispatcher* dispatcher, void* multiSapProxy)
+{
+	(void)shapeType;
+	(void)dispatcher;
+	(void)multiSapProxy;
+	return addProxy(aabbMin, aabbMax, userPtr, collisionFilterGroup, collisionFilterMask);
+}
+#endif
+
+void hbrGridBroadphase::destroyProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher)
+{
+	hbrGridBroadphaseProxy* gridProxy = static_cast<hbrGridBroadphaseProxy*>(proxy);
+	removeProxy(gridProxy);
+	if (gridProxy->m_movedIndex >= 0)
+	{
+		int index = gridProxy->m_movedIndex;
+		m_movedProxies[index] = m_movedProxies[m_movedProxies.size() - 1];
+		m_movedProxies[index]->m_movedIndex = index;
+		m_movedProxies.pop_back();
+	}
+	m_pairCache->removeOverlappingPairsContainingProxy(gridProxy, dispatcher);
+	delete gridProxy;
+}
+
+void hbrGridBroadphase::setAabb(btBroadphaseProxy* proxy, const btVector3& aabbMin, const btVector3& aabbMax, btDispatcher* dispatcher)
+{
+	(void)dispatcher;
+	hbrGridBroadphaseProxy* gridProxy = static_cast<hbrGridBroadphaseProxy*>(proxy);
+	// The world sets the AABB of every object each step, most of them did not move
+	if (gridProxy->m_aabbMin == aabbMin && gridProxy->m_aabbMax == aabbMax)
+		return;
+
+	int cellMin[2], cellMax[2];
+	bool large = !computeCells(aabbMin, aabbMax, cellMin, cellMax);
+	if (large != gridProxy->m_large)
+	{
+		removeProxy(gridProxy);
+		gridProxy->m_aabbMin = aabbMin;
+		gridProxy->m_aabbMax = aabbMax;
+		insertProxy(gridProxy);
+	}
+	else
+	{
+		gridProxy->m_aabbMin = aabbMin;
+		gridProxy->m_aabbMax = aabbMax;
+		if (!large && (cellMin[0] != gridProxy->m_cellMin[0] || cellMin[1] != gridProxy->m_cellMin[1] ||
+					   cellMax[0] != gridProxy->m_cellMax[0] || cellMax[1] != gridProxy->m_cellMax[1]))
+		{
+			// Only the cells it left and entered change
+			removeCells(gridProxy, gridProxy->m_cellMin, gridProxy->m_cellMax, cellMin, cellMax);
+			insertCells(gridProxy, cellMin, cellMax, gridProxy->m_cellMin, gridProxy->m_cellMax);
+			gridProxy->m_cellMin[0] = cellMin[0];
+			gridProxy->m_cellMin[1] = cellMin[1];
+			gridProxy->m_cellMax[0] = cellMax[0];
+			gridProxy->m_cellMax[1] = cellMax[1];
+		}
+	}
+	markMoved(gridProxy);
+}
+
+void hbrGridBroadphase::getAabb(btBroadphaseProxy* proxy, btVector3& aabbMin, btVector3& aabbMax) const
+{
+	aabbMin = proxy->m_aabbMin;
+	aabbMax = proxy->m_aabbMax;
+}
+
+void hbrGridBroadphase::testPair(hbrGridBroadphaseProxy* proxy, hbrGridBroadphaseProxy* other, btDispatcher* dispatcher)
+{
+	(void)dispatcher;
+	if (other == proxy)
+		return;
+	// When both moved the pair is tested from the proxy with the lower id
+	if (other->m_movedIndex >= 0 && other->m_uniqueId < proxy->m_uniqueId)
+		return;
+	if (TestAabbAgainstAabb2(proxy->m_aabbMin, proxy->m_aabbMax, other->m_aabbMin, other->m_aabbMax))
+		m_pairCache->addOverlappingPair(proxy, other);
+}
+
+void hbrGridBroadphase::findPairs(hbrGridBroadphaseProxy* proxy, btDispatcher* dispatcher)
+{
+	unsigned int stamp = ++m_stamp;
+	for (int i = 0; i < m_largeProxies.size(); i++)
+		testPair(proxy, m_largeProxies[i], dispatcher);
+
+	if (proxy->m_large)
+	{
+		for (int i = 0; i < m_proxies.size(); i++)
+			testPair(proxy, m_proxies[i], dispatcher);
+		return;
+	}
+
+	for (int x = proxy->m_cellMin[0]; x <= proxy->m_cellMax[0]; x++)
+	{
+		for (int y = proxy->m_cellMin[1]; y <= proxy->m_cellMax[1]; y++)
+		{
+			btAlignedObjectArray<hbrGridBroadphaseProxy*>* cell = findCell(x, y);
+			if (!cell)
+				continue;
+			for (int i = 0; i < cell->size(); i++)
+			{
+				hbrGridBroadphaseProxy* other = (*cell)[i];
+				if (other->m_stamp == stamp)
+					continue;
+				other->m_stamp = stamp;
+				testPair(proxy, other, dispatcher);
+			}
+		}
+	}
+}
+
+void hbrGridBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+{
+	if (!m_movedProxies.size())
+		return;
+
+	for (int i = 0; i < m_movedProxies.size(); i++)
+		findPairs(m_movedProxies[i], dispatcher);
+
+	// Pairs of proxies that did not move still overlap, the others are checked again
+	btBroadphasePairArray& pairs = m_pairCache->getOverlappingPairArray();
+	for (int i = 0; i < pairs.size();)
+	{
+		hbrGridBroadphaseProxy* proxy0 = static_cast<hbrGridBroadphaseProxy*>(pairs[i].m_pProxy0);
+		hbrGridBroadphaseProxy* proxy1 = static_cast<hbrGridBroadphaseProxy*>(pairs[i].m_pProxy1);
+		if ((proxy0->m_movedIndex >= 0 || proxy1->m_movedIndex >= 0) &&
+			!TestAabbAgainstAabb2(proxy0->m_aabbMin, proxy0->m_aabbMax, proxy1->m_aabbMin, proxy1->m_aabbMax))
+		{
+			// Moves the last pair into slot i
+			m_pairCache->removeOverlappingPair(proxy0, proxy1, dispatcher);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (int i = 0; i < m_movedProxies.size(); i++)
+		m_movedProxies[i]->m_movedIndex = -1;
+	m_movedProxies.resize(0);
+}
+
+void hbrGridBroadphase::rayTestProxy(hbrGridBroadphaseProxy* proxy, const btVector3& rayFrom, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	if (proxy->m_stamp == m_stamp)
+		return;
+	proxy->m_stamp = m_stamp;
+	// The proxy grown by the swept box, as btDbvtBroadphase does
+	btVector3 bounds[2] = {proxy->m_aabbMin - aabbMax, proxy->m_aabbMax - aabbMin};
+	btScalar tmin;
+	if (btRayAabb2(rayFrom, rayCallback.m_rayDirectionInverse, rayCallback.m_signs, bounds, tmin, 0, rayCallback.m_lambda_max))
+		rayCallback.process(proxy);
+}
+
+void hbrGridBroadphase::rayTestCell(int x, int y, const btVector3& rayFrom, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	btAlignedObjectArray<hbrGridBroadphaseProxy*>* cell = findCell(x, y);
+	if (!cell)
+		return;
+	for (int i = 0; i < cell->size(); i++)
+		rayTestProxy((*cell)[i], rayFrom, rayCallback, aabbMin, aabbMax);
+}
+
+void hbrGridBroadphase::rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	++m_stamp;
+	for (int i = 0; i < m_largeProxies.size(); i++)
+		rayTestProxy(m_largeProxies[i], rayFrom, rayCallback, aabbMin, aabbMax);
+
+	int x = cellCoordinate(rayFrom[m_axis0]), y = cellCoordinate(rayFrom[m_axis1]);
+	int endX = cellCoordinate(rayTo[m_axis0]), endY = cellCoordinate(rayTo[m_axis1]);
+	int steps = abs(endX - x) + abs(endY - y);
+	// Long rays test every proxy rather than walk more cells than there are proxies
+	if (steps > m_proxies.size())
+	{
+		for (int i = 0; i < m_proxies.size(); i++)
+			rayTestProxy(m_proxies[i], rayFrom, rayCallback, aabbMin, aabbMax);
+		return;
+	}
+
+	// Around each cell on the ray, the cells the swept box reaches into
+	int padMin0 = cellCoordinate(aabbMin[m_axis0]), padMin1 = cellCoordinate(aabbMin[m_axis1]);
+	int padMax0 = int(btCeil(aabbMax[m_axis0] * m_invCellSize)), padMax1 = int(btCeil(aabbMax[m_axis1] * m_invCellSize));
+
+	// Walks the cells the ray crosses in order (Amanatides and Woo), t runs from 0 at rayFrom to 1 at rayTo
+	btScalar delta0 = (rayTo[m_axis0] - rayFrom[m_axis0]) * m_invCellSize;
+	btScalar delta1 = (rayTo[m_axis1] - rayFrom[m_axis1]) * m_invCellSize;
+	btScalar start0 = rayFrom[m_axis0] * m_invCellSize, start1 = rayFrom[m_axis1] * m_invCellSize;
+	int step0 = delta0 > 0 ? 1 : -1, step1 = delta1 > 0 ? 1 : -1;
+	btScalar tDelta0 = delta0 != 0 ? btFabs(1 / delta0) : BT_LARGE_FLOAT;
+	btScalar tDelta1 = delta1 != 0 ? btFabs(1 / delta1) : BT_LARGE_FLOAT;
+	btScalar tMax0 = delta0 > 0 ? (x + 1 - start0) / delta0 : delta0 < 0 ? (x - start0) / delta0 : BT_LARGE_FLOAT;
+	btScalar tMax1 = delta1 > 0 ? (y + 1 - start1) / delta1 : delta1 < 0 ? (y - start1) / delta1 : BT_LARGE_FLOAT;
+
+	for (int i = 0;; i++)
+	{
+		for (int cx = x + padMin0; cx <= x + padMax0; cx++)
+		{
+			for (int cy = y + padMin1; cy <= y + padMax1; cy++)
+				rayTestCell(cx, cy, rayFrom, rayCallback, aabbMin, aabbMax);
+		}
+		if (i >= steps)
+			break;
+
+		if (tMax0 < tMax1)
+		{
+			tMax0 += tDelta0;
+			x += step0;
+		}
+		else
+		{
+			tMax1 += tDelta1;
+			y += step1;
+		}
+	}
+
+	// Rounding can end the walk a cell short of the end
+	if (x != endX || y != endY)
+	{
+		for (int cx = endX + padMin0; cx <= endX + padMax0; cx++)
+		{
+			for (int cy = endY + padMin1; cy <= endY + padMax1; cy++)
+				rayTestCell(cx, cy, rayFrom, rayCallback, aabbMin, aabbMax);
+		}
+	}
+}
+
+void hbrGridBroadphase::aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback)
+{
+	for (int i = 0; i < m_largeProxies.size(); i++)
+	{
+		hbrGridBroadphaseProxy* proxy = m_largeProxies[i];
+		if (TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+			callback.process(proxy);
+	}
+
+	int cellMin[2], cellMax[2];
+	if (!computeCells(aabbMin, aabbMax, cellMin, cellMax))
+	{
+		for (int i = 0; i < m_proxies.size(); i++)
+		{
+			hbrGridBroadphaseProxy* proxy = m_proxies[i];
+			if (TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+				callback.process(proxy);
+		}
+		return;
+	}
+
+	unsigned int stamp = ++m_stamp;
+	for (int x = cellMin[0]; x <= cellMax[0]; x++)
+	{
+		for (int y = cellMin[1]; y <= cellMax[1]; y++)
+		{
+			btAlignedObjectArray<hbrGridBroadphaseProxy*>* cell = findCell(x, y);
+			if (!cell)
+				continue;
+			for (int i = 0; i < cell->size(); i++)
+			{
+				hbrGridBroadphaseProxy* proxy = (*cell)[i];
+				if (proxy->m_stamp == stamp)
+					continue;
+				proxy->m_stamp = stamp;
+				if (TestAabbAgainstAabb2(aabbMin, aabbMax, proxy->m_aabbMin, proxy->m_aabbMax))
+					callback.process(proxy);
+			}
+		}
+	}
+}
+
+void hbrGridBroadphase::getBroadphaseAabb(btVector3& aabbMin, btVector3& aabbMax) const
+{
+	if (!getNumProxies())
+	{
+		aabbMin.setValue(0, 0, 0);
+		aabbMax.setValue(0, 0, 0);
+		return;
+	}
+	aabbMin.setValue(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+	aabbMax.setValue(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+	for (int i = 0; i < m_proxies.size(); i++)
+	{
+		aabbMin.setMin(m_proxies[i]->m_aabbMin);
+		aabbMax.setMax(m_proxies[i]->m_aabbMax);
+	}
+	for (int i = 0; i < m_largeProxies.size(); i++)
+	{
+		aabbMin.setMin(m_largeProxies[i]->m_aabbMin);
+		aabbMax.setMax(m_largeProxies[i]->m_aabbMax);
+	}
+}
@@ -0,0 +1,125 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_GRID_BROADPHASE_H
+#define HBR_GRID_BROADPHASE_H
+
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class btOverlappingPairCache;
+
+///Proxies covering more cells than this are kept in a list of their own and tested against every moved proxy.
+#define HBR_GRID_MAX_PROXY_CELLS 64
+
+struct hbrGridBroadphaseProxy : public btBroadphaseProxy
+{
+	int m_cellMin[2];
+	int m_cellMax[2];
+	///Index in hbrGridBroadphase::m_proxies, or in m_largeProxies when m_large is set.
+	int m_index;
+	///Last query that visited the proxy, so a proxy in several cells is tested once per query.
+	unsigned int m_stamp;
+	///Index in hbrGridBroadphase::m_movedProxies, -1 while the proxy did not move since the last pair update.
+	int m_movedIndex;
+	bool m_large;
+
+	hbrGridBroadphaseProxy(const btVector3& aabbMin, const btVector3& aabbMax, void* userPtr, int collisionFilterGroup, int collisionFilterMask)
+		: btBroadphaseProxy(aabbMin, aabbMax, userPtr, collisionFilterGroup, collisionFilterMask), m_index(-1), m_stamp(0), m_movedIndex(-1), m_large(false)
+	{
+	}
+};
+
+///hbrGridBroadphase hashes proxies into a uniform grid over the two horizontal axes, for wide and flat worlds with many
+///moving objects. Moving a proxy only touches the cells it enters or leaves, there is no tree to refit or rebalance,
+///and setAabb with an unchanged AABB (static and resting objects) costs a compare.
+///calculateOverlappingPairs tests the proxies that moved since the last call against the proxies sharing a cell with
+///them, and drops their pairs that no longer overlap.
+///The cell size should be a few times the size of the typical moving object. Cells are hashed, far apart coordinates
+///may share a cell, which costs some extra AABB tests but never misses a pair. Large proxies such as the ground are not
+///put in cells, see HBR_GRID_MAX_PROXY_CELLS.
+class hbrGridBroadphase : public btBroadphaseInterface
+{
+protected:
+	btScalar m_cellSize;
+	btScalar m_invCellSize;
+	int m_axis0;
+	int m_axis1;
+
+	btOverlappingPairCache* m_pairCache;
+	bool m_ownsPairCache;
+
+	btHashMap<btHashInt, int> m_cellIndices;
+	btAlignedObjectArray<btAlignedObjectArray<hbrGridBroadphaseProxy*> > m_cells;
+	btAlignedObjectArray<hbrGridBroadphaseProxy*> m_proxies;
+	btAlignedObjectArray<hbrGridBroadphaseProxy*> m_largeProxies;
+	btAlignedObjectArray<hbrGridBroadphaseProxy*> m_movedProxies;
+
+	int m_uniqueId;
+	unsigned int m_stamp;
+
+	int cellCoordinate(btScalar value) const;
+	bool computeCells(const btVector3& aabbMin, const btVector3& aabbMax, int cellMin[2], int cellMax[2]) const;
+	btAlignedObjectArray<hbrGridBroadphaseProxy*>* findCell(int x, int y);
+	btAlignedObjectArray<hbrGridBroadphaseProxy*>& getCell(int x, int y);
+
+	void insertProxy(hbrGridBroadphaseProxy * proxy);
+	void removeProxy(hbrGridBroadphaseProxy * proxy);
+	void insertCells(hbrGridBroadphaseProxy * proxy, const int cellMin[2], const int cellMax[2], const int skipMin[2], const int skipMax[2]);
+	void removeCells(hbrGridBroadphaseProxy * proxy, const int cellMin[2], const int cellMax[2], const int skipMin[2], const int skipMax[2]);
+	void markMoved(hbrGridBroadphaseProxy * proxy);
+
+	void findPairs(hbrGridBroadphaseProxy * proxy, btDispatcher* dispatcher);
+	void testPair(hbrGridBroadphaseProxy * proxy, hbrGridBroadphaseProxy * other, btDispatcher* dispatcher);
+	void rayTestCell(int x, int y, const btVector3& rayFrom, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax);
+	void rayTestProxy(hbrGridBroadphaseProxy * proxy, const btVector3& rayFrom, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin, const btVector3& aabbMax);
+
+	btBroadphaseProxy* addProxy(const btVector3& aabbMin, const btVector3& aabbMax, void* userPtr, int collisionFilterGroup, int collisionFilterMask);
+
+public:
+	///upAxis is the axis the grid is not divided along. Without a pair cache the broadphase creates a
+	///btHashedOverlappingPairCache of its own.
+	hbrGridBroadphase(btScalar cellSize, int upAxis = 1, btOverlappingPairCache* pairCache = 0);
+	virtual ~hbrGridBroadphase();
+
+#if BT_BULLET_VERSION >= 285
+	virtual btBroadphaseProxy* createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, int collisionFilterGroup, int collisionFilterMask, btDispatcher* dispatcher);
+#else
+	virtual btBroadphaseProxy* createProxy(const btVector3& aabbMin, const btVector3& aabbMax, int shapeType, void* userPtr, short int collisionFilterGroup, short int collisionFilterMask, btDispatcher* dispatcher, void* multiSapProxy);
+#endif
+	virtual void destroyProxy(btBroadphaseProxy * proxy, btDispatcher * dispatcher);
+	virtual void setAabb(btBroadphaseProxy * proxy, const btVector3& aabbMin, const btVector3& aabbMax, btDispatcher* dispatcher);
+	virtual void getAabb(btBroadphaseProxy * proxy, btVector3 & aabbMin, btVector3 & aabbMax) const;
+
+	virtual void rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin = btVector3(0, 0, 0), const btVector3& aabbMax = btVector3(0, 0, 0));
+	virtual void aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback);
+
+	virtual void calculateOverlappingPairs(btDispatcher * dispatcher);
+
+	virtual btOverlappingPairCache* getOverlappingPairCache() { return m_pairCache; }
+	virtual const btOverlappingPairCache* getOverlappingPairCache() const { return m_pairCache; }
+
+	virtual void getBroadphaseAabb(btVector3 & aabbMin, btVector3 & aabbMax) const;
+	virtual void printStats() {}
+
+	btScalar getCellSize() const { return m_cellSize; }
+	int getNumProxies() const { return m_proxies.size() + m_largeProxies.size(); }
+	int getNumLargeProxies() const { return m_largeProxies.size(); }
+	///Cells that ever held a proxy, cells are kept once created.
+	int getNumCells() const { return m_cells.size(); }
+	///Proxies moved since the last calculateOverlappingPairs.
+	int getNumMovedProxies() const { return m_movedProxies.size(); }
+};
+
+#endif  // HBR_GRID_BROADPHASE_H
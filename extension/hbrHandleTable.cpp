@@ -0,0 +1,499 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btMotionState.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "hbrKinematicCharacterController.h"
+#include "hbrHandleTable.h"
+
+#define HBR_HANDLE_SLOT_BITS 20
+#define HBR_HANDLE_SLOT_MASK ((1 << HBR_HANDLE_SLOT_BITS) - 1)
+#define HBR_HANDLE_GENERATION_MASK 0x7ff
+
+static void hbrWriteTransform(const btTransform& xform, float* out)
+{
+	const btVector3& origin = xform.getOrigin();
+	btQuaternion rotation = xform.getRotation();
+	out[0] = origin.getX();
+	out[1] = origin.getY();
+	out[2] = origin.getZ();
+	out[3] = rotation.getX();
+	out[4] = rotation.getY();
+	out[5] = rotation.getZ();
+	out[6] = rotation.getW();
+}
+
+static void hbrWriteVector(const btVector3& v, float* out)
+{
+	out[0] = v.getX();
+	out[1] = v.getY();
+	out[2] = v.getZ();
+}
+
+hbrHandleTable::hbrHandleTable()
+	: m_firstFree(-1),
+	  m_count(0)
+{
+}
+
+int hbrHandleTable::add(btCollisionObject* object, hbrKinematicCharacterController* character, int kind)
+{
+	if (!object)
+		return 0;
+
+	int existing = findHandle(object);
+	if (existing)
+		return existing;
+
+	int index;
+	if (m_firstFree >= 0)
+	{
+		index = m_firstFree;
+		m_firstFree = m_slots[index].m_nextFree;
+	}
+	else
+	{
+		index = m_slots.size();
+		if (index > HBR_HANDLE_SLOT_MASK)
+			return 0;
+
+		Slot slot;
+		slot.m_generation = 1;
+		m_slots.push_back(slot);
+	}
+
+	Slot& slot = m_slots[index];
+	slot.m_object = object;
+	slot.m_character = character;
+	slot.m_kind = kind;
+	slot.m_nextFree = -1;
+
+	int handle = (slot.m_generation << HBR_HANDLE_SLOT_BITS) | index;
+	m_handlesByObject.insert(btHashPtr(object), handle);
+	m_count++;
+	return handle;
+}
+
+hbrHandleTable::Slot* hbrHandleTable::lookup(int handle)
+{
+	int index = handle & HBR_HANDLE_SLOT_MASK;
+	if (handle <= 0 || index >= m_slots.size())
+		return 0;
+
+	Slot& slot = m_slots[index];
+	if (slot.m_kind == HBR_HANDLE_NONE || slot.m_generation != (handle >> HBR_HANDLE_SLOT_BITS))
+		return 0;
+	return &slot;
+}
+
+const hbrHandleTable::Slot* hbrHandleTable::lookup(int handle) const
+{
+	return const_cast<hbrHandleTable*>(this)->lookup(handle);
+}
+
+btRigidBody* hbrHandleTable::rigidBody(int handle)
+{
+	Slot* slot = lookup(handle);
+	if (!slot || slot->m_kind != HBR_HANDLE_RIGID_BODY)
+		return 0;
+	return static_cast<btRigidBody*>(slot->m_object);
+}
+
+int hbrHandleTable::addRigidBody(btRigidBody* body)
+{
+	return add(body, 0, HBR_HANDLE_RIGID_BODY);
+}
+
+int hbrHandleTable::addGhostObject(btGhostObject* ghost)
+{
+	return add(ghost, 0, HBR_HANDLE_GHOST_OBJECT);
+}
+
+int hbrHandleTable::addCharacter(hbrKinematicCharacterController* character)
+{
+	if (!character)
+		return 0;
+	return add(character->getGhostObject(), character, HBR_HANDLE_CHARACTER);
+}
+
+bool hbrHandleTable::remove(int handle)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	m_handlesByObject.remove(btHashPtr(slot->m_object));
+
+	int index = handle & HBR_HANDLE_SLOT_MASK;
+	slot->m_object = 0;
+	slot->m_character = 0;
+	slot->m_kind = HBR_HANDLE_NONE;
+	// generation 0 is skipped so that a handle can never be 0
+	slot->m_generation = (slot->m_generation % HBR_HANDLE_GENERATION_MASK) + 1;
+	slot->m_nextFree = m_firstFree;
+	m_firstFree = index;
+	m_count--;
+	return true;
+}
+
+int hbrHandleTable::getKind(int handle) const
+{
+	const Slot* slot = lookup(handle);
+	return slot ? slot->m_kind : HBR_HANDLE_NONE;
+}
+
+int hbrHandleTable::findHandle(const btCollisionObject* object) const
+{
+	const int* handle = m_handlesByObject.find(btHashPtr(object));
+	return handle ? *handle : 0;
+}
+
+btCollisionObject* hbrHandleTable::getCollisionObject(int handle)
+{
+	Slot* slot = lookup(handle);
+	return slot ? slot->m_object : 0;
+}
+
+hbrKinematicCharacterController* hbrHandleTable::getCharacter(int handle)
+{
+	Slot* slot = lookup(handle);
+	return slot ? slot->m_character : 0;
+}
+
+bool hbrHandleTable::getTransform(int handle, void* out)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	hbrWriteTransform(slot->m_object->getWorldTransform(), static_cast<float*>(out));
+	return true;
+}
+
+bool hbrHandleTable::setTransform(int handle, const void* in)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	const float* t = static_cast<const float*>(in);
+	btTransform xform(btQuaternion(t[3], t[4], t[5], t[6]), btVector3(t[0], t[1], t[2]));
+
+	if (slot->m_kind == HBR_HANDLE_RIGID_BODY)
+	{
+		btRigidBody* body = static_cast<btRigidBody*>(slot->m_object);
+		body->setCenterOfMassTransform(xform);
+		if (body->getMotionState())
+			body->getMotionState()->setWorldTransform(xform);
+		body->activate();
+	}
+	else
+	{
+		slot->m_object->setWorldTransform(xform);
+	}
+	return true;
+}
+
+bool hbrHandleTable::setPosition(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	float t[7];
+	hbrWriteTransform(slot->m_object->getWorldTransform(), t);
+	t[0] = x;
+	t[1] = y;
+	t[2] = z;
+	return setTransform(handle, t);
+}
+
+bool hbrHandleTable::setRotation(int handle, btScalar x, btScalar y, btScalar z, btScalar w)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	float t[7];
+	hbrWriteTransform(slot->m_object->getWorldTransform(), t);
+	t[3] = x;
+	t[4] = y;
+	t[5] = z;
+	t[6] = w;
+	return setTransform(handle, t);
+}
+
+bool hbrHandleTable::getLinearVelocity(int handle, void* out)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	switch (slot->m_kind)
+	{
+		case HBR_HANDLE_RIGID_BODY:
+			hbrWriteVector(static_cast<btRigidBody*>(slot->m_object)->getLinearVelocity(), static_cast<float*>(out));
+			break;
+		case HBR_HANDLE_CHARACTER:
+			hbrWriteVector(slot->m_character->getLinearVelocity(), static_cast<float*>(out));
+			break;
+		default:
+			hbrWriteVector(slot->m_object->getInterpolationLinearVelocity(), static_cast<float*>(out));
+			break;
+	}
+	return true;
+}
+
+bool hbrHandleTable::setLinearVelocity(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	switch (slot->m_kind)
+	{
+		case HBR_HANDLE_RIGID_BODY:
+			static_cast<btRigidBody*>(slot->m_object)->setLinearVelocity(btVector3(x, y, z));
+			slot->m_object->activate();
+			break;
+		case HBR_HANDLE_CHARACTER:
+			slot->m_character->setLinearVelocity(btVector3(x, y, z));
+			break;
+		default:
+			slot->m_object->setInterpolationLinearVelocity(btVector3(x, y, z));
+			break;
+	}
+	return true;
+}
+
+bool hbrHandleTable::getAngularVelocity(int handle, void* out)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	switch (slot->m_kind)
+	{
+		case HBR_HANDLE_RIGID_BODY:
+			hbrWriteVector(static_cast<btRigidBody*>(slot->m_object)->getAngularVelocity(), static_cast<float*>(out));
+			break;
+		case HBR_HANDLE_CHARACTER:
+			hbrWriteVector(slot->m_character->getAngularVelocity(), static_cast<float*>(out));
+			break;
+		default:
+			hbrWriteVector(slot->m_object->getInterpolationAngularVelocity(), static_cast<float*>(out));
+			break;
+	}
+	return true;
+}
+
+bool hbrHandleTable::setAngularVelocity(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	switch (slot->m_kind)
+	{
+		case HBR_HANDLE_RIGID_BODY:
+			static_cast<btRigidBody*>(slot->m_object)->setAngularVelocity(btVector3(x, y, z));
+			slot->m_object->activate();
+			break;
+		case HBR_HANDLE_CHARACTER:
+			slot->m_character->setAngularVelocity(btVector3(x, y, z));
+			break;
+		default:
+			slot->m_object->setInterpolationAngularVelocity(btVector3(x, y, z));
+			break;
+	}
+	return true;
+}
+
+bool hbrHandleTable::applyCentralImpulse(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	if (slot->m_kind == HBR_HANDLE_RIGID_BODY)
+	{
+		static_cast<btRigidBody*>(slot->m_object)->applyCentralImpulse(btVector3(x, y, z));
+		slot->m_object->activate();
+		return true;
+	}
+	if (slot->m_kind == HBR_HANDLE_CHARACTER)
+	{
+		slot->m_character->applyCentralImpulse(btVector3(x, y, z));
+		return true;
+	}
+	return false;
+}
+
+bool hbrHandleTable::applyCentralForce(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	if (slot->m_kind == HBR_HANDLE_RIGID_BODY)
+	{
+		static_cast<btRigidBody*>(slot->m_object)->applyCentralForce(btVector3(x, y, z));
+		slot->m_object->activate();
+		return true;
+	}
+	if (slot->m_kind == HBR_HANDLE_CHARACTER)
+	{
+		slot->m_character->applyCentralForce(btVector3(x, y, z));
+		return true;
+	}
+	return false;
+}
+
+bool hbrHandleTable::activate(int handle)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	slot->m_object->activate(true);
+	return true;
+}
+
+int hbrHandleTable::getActivationState(int handle)
+{
+	Slot* slot = lookup(handle);
+	return slot ? slot->m_object->getActivationState() : 0;
+}
+
+int hbrHandleTable::getUserIndex(int handle)
+{
+	Slot* slot = lookup(handle);
+	return slot ? slot->m_object->getUserIndex() : -1;
+}
+
+bool hbrHandleTable::setUserIndex(int handle, int index)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	slot->m_object->setUserIndex(index);
+	return true;
+}
+
+bool hbrHandleTable::setWalkDirection(int handle, btScalar x, btScalar y, btScalar z)
+{
+	hbrKinematicCharacterController* character = getCharacter(handle);
+	if (!character)
+		return false;
+
+	character->setWalkDirection(btVector3(x, y, z));
+	return true;
+}
+
+bool hbrHandleTable::jump(int handle)
+{
+	hbrKinematicCharacterController* character = getCharacter(handle);
+	if (!character)
+		return false;
+
+	character->jump();
+	return true;
+}
+
+bool hbrHandleTable::onGround(int handle)
+{
+	hbrKinematicCharacterController* character = getCharacter(handle);
+	return character && character->onGround();
+}
+
+bool hbrHandleTable::warp(int handle, btScalar x, btScalar y, btScalar z)
+{
+	Slot* slot = lookup(handle);
+	if (!slot)
+		return false;
+
+	if (slot->m_kind == HBR_HANDLE_CHARACTER)
+	{
+		slot->m_character->warp(btVector3(x, y, z));
+		return true;
+	}
+	return setPosition(handle, x, y, z);
+}
+
+int hbrHandleTable::readTransforms(const void* handles, int count, void* out)
+{
+	const int* h = static_cast<const int*>(handles);
+	float* dst = static_cast<float*>(out);
+	int valid = 0;
+
+	for (int i = 0; i < count; i++, dst += 7)
+	{
+		Slot* slot = lookup(h[i]);
+		if (slot)
+		{
+			hbrWriteTransform(slot->m_object->getWorldTransform(), dst);
+			valid++;
+		}
+		else
+		{
+			dst[0] = dst[1] = dst[2] = 0.0f;
+			dst[3] = dst[4] = dst[5] = 0.0f;
+			dst[6] = 1.0f;
+		}
+	}
+	return valid;
+}
+
+int hbrHandleTable::readLinearVelocities(const void* handles, int count, void* out)
+{
+	const int* h = static_cast<const int*>(handles);
+	float* dst = static_cast<float*>(out);
+	int valid = 0;
+
+	for (int i = 0; i < count; i++, dst += 3)
+	{
+		if (getLinearVelocity(h[i], dst))
+		{
+			valid++;
+		}
+		else
+		{
+			dst[0] = dst[1] = dst[2] = 0.0f;
+		}
+	}
+	return valid;
+}
+
+int hbrHandleTable::rayTestClosest(btCollisionWorld* world, btScalar fromX, btScalar fromY, btScalar fromZ, btScalar toX, btScalar toY, btScalar toZ, void* out)
+{
+	btVector3 from(fromX, fromY, fromZ);
+	btVector3 to(toX, toY, toZ);
+	btCollisionWorld::ClosestRayResultCallback callback(from, to);
+	world->rayTest(from, to, callback);
+
+	if (!callback.hasHit())
+		return 0;
+
+	float* dst = static_cast<float*>(out);
+	if (dst)
+	{
+		hbrWriteVector(callback.m_hitPointWorld, dst);
+		hbrWriteVector(callback.m_hitNormalWorld, dst + 3);
+		dst[6] = callback.m_closestHitFraction;
+	}
+
+	int handle = findHandle(callback.m_collisionObject);
+	return handle ? handle : -1;
+}
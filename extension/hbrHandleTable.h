@@ -0,0 +1,112 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_HANDLE_TABLE_H
+#define HBR_HANDLE_TABLE_H
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class btCollisionObject;
+class btCollisionWorld;
+class btRigidBody;
+class btGhostObject;
+class hbrKinematicCharacterController;
+
+///hbrHandleTable addresses rigid bodies, ghost objects and character controllers through small integer handles,
+///so per frame code in JS only passes numbers and heap buffers around and never creates wrapper objects.
+///A handle packs a slot index (low 20 bits) with the slot's generation (next 11 bits). Removing an object bumps
+///the generation, so stale handles are rejected instead of reaching whatever reuses the slot. 0 is never a valid handle.
+///Vectors are read and written as x, y, z floats, transforms as px, py, pz, qx, qy, qz, qw.
+class hbrHandleTable
+{
+public:
+	enum HandleKind
+	{
+		HBR_HANDLE_NONE = 0,
+		HBR_HANDLE_RIGID_BODY,
+		HBR_HANDLE_GHOST_OBJECT,
+		HBR_HANDLE_CHARACTER
+	};
+
+protected:
+	struct Slot
+	{
+		btCollisionObject* m_object;
+		hbrKinematicCharacterController* m_character;
+		int m_kind;
+		int m_generation;
+		int m_nextFree;
+	};
+
+	btAlignedObjectArray<Slot> m_slots;
+	btHashMap<btHashPtr, int> m_handlesByObject;
+	int m_firstFree;
+	int m_count;
+
+	int add(btCollisionObject * object, hbrKinematicCharacterController * character, int kind);
+	Slot* lookup(int handle);
+	const Slot* lookup(int handle) const;
+	btRigidBody* rigidBody(int handle);
+
+public:
+	hbrHandleTable();
+
+	int addRigidBody(btRigidBody * body);
+	int addGhostObject(btGhostObject * ghost);
+	int addCharacter(hbrKinematicCharacterController * character);
+	bool remove(int handle);
+
+	bool isValid(int handle) const { return lookup(handle) != 0; }
+	int getKind(int handle) const;
+	int getCount() const { return m_count; }
+
+	///Handle of a registered object (for characters, their ghost object), 0 if it is not in the table.
+	int findHandle(const btCollisionObject* object) const;
+	btCollisionObject* getCollisionObject(int handle);
+	hbrKinematicCharacterController* getCharacter(int handle);
+
+	bool getTransform(int handle, void* out);
+	bool setTransform(int handle, const void* in);
+	bool setPosition(int handle, btScalar x, btScalar y, btScalar z);
+	bool setRotation(int handle, btScalar x, btScalar y, btScalar z, btScalar w);
+
+	bool getLinearVelocity(int handle, void* out);
+	bool setLinearVelocity(int handle, btScalar x, btScalar y, btScalar z);
+	bool getAngularVelocity(int handle, void* out);
+	bool setAngularVelocity(int handle, btScalar x, btScalar y, btScalar z);
+	bool applyCentralImpulse(int handle, btScalar x, btScalar y, btScalar z);
+	bool applyCentralForce(int handle, btScalar x, btScalar y, btScalar z);
+
+	bool activate(int handle);
+	int getActivationState(int handle);
+	int getUserIndex(int handle);
+	bool setUserIndex(int handle, int index);
+
+	bool setWalkDirection(int handle, btScalar x, btScalar y, btScalar z);
+	bool jump(int handle);
+	bool onGround(int handle);
+	bool warp(int handle, btScalar x, btScalar y, btScalar z);
+
+	///Transforms of count handles into out (7 floats each). Invalid handles get an identity transform.
+	///Returns the number of valid handles.
+	int readTransforms(const void* handles, int count, void* out);
+	///Linear velocities of count handles into out (3 floats each), zero for invalid handles.
+	int readLinearVelocities(const void* handles, int count, void* out);
+
+	///Closest hit along a ray. Writes hit point, hit normal and hit fraction (7 floats) to out and returns the
+	///handle of the hit object, -1 if the hit object is not in the table, or 0 if nothing was hit.
+	int rayTestClosest(btCollisionWorld * world, btScalar fromX, btScalar fromY, btScalar fromZ, btScalar toX, btScalar toY, btScalar toZ, void* out);
+};
+
+#endif  // HBR_HANDLE_TABLE_H
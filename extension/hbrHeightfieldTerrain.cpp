@@ -0,0 +1,356 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "hbrHeightfieldTerrain.h"
+
+///wakes up everything whose AABB overlaps an edited terrain region
+struct hbrTerrainActivateCallback : public btBroadphaseAabbCallback
+{
+	const btCollisionObject* m_tileObject;
+
+	hbrTerrainActivateCallback(const btCollisionObject* tileObject) : m_tileObject(tileObject) {}
+
+	virtual bool process(const btBroadphaseProxy* proxy)
+	{
+		btCollisionObject* obj = static_cast<btCollisionObject*>(proxy->m_clientObject);
+		if (obj && obj != m_tileObject && !obj->isStaticObject())
+			obj->activate();
+		return true;
+	}
+};
+
+hbrHeightfieldTerrain::hbrHeightfieldTerrain(btCollisionWorld* world, int tileSamples, btScalar sampleSpacing, int upAxis)
+	: m_world(world),
+	  m_tileSamples(btMax(tileSamples, 2)),
+	  m_sampleSpacing(sampleSpacing),
+	  m_upAxis(upAxis),
+	  m_origin(0, 0, 0),
+	  m_collisionFilterGroup(btBroadphaseProxy::StaticFilter),
+	  m_collisionFilterMask(btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter),
+	  m_friction(btScalar(0.5)),
+	  m_restitution(btScalar(0.0)),
+	  m_memoryBudget(0),
+	  m_memoryUsed(0),
+	  m_frame(0)
+{
+	// btHeightfieldTerrainShape lays its grid out along the two remaining axes, in order
+	switch (m_upAxis)
+	{
+		case 0:
+			m_gridAxis0 = 1;
+			m_gridAxis1 = 2;
+			break;
+		case 2:
+			m_gridAxis0 = 0;
+			m_gridAxis1 = 1;
+			break;
+		default:
+			m_upAxis = 1;
+			m_gridAxis0 = 0;
+			m_gridAxis1 = 2;
+			break;
+	}
+}
+
+hbrHeightfieldTerrain::~hbrHeightfieldTerrain()
+{
+	for (int i = 0; i < m_tiles.size(); i++)
+	{
+		destroyTile(m_tiles[i]);
+	}
+	m_tiles.clear();
+	m_tileMap.clear();
+}
+
+hbrHeightfieldTerrain::Tile* hbrHeightfieldTerrain::findTile(int tileX, int tileZ) const
+{
+	Tile* const* tile = m_tileMap.find(btHashInt(tileKey(tileX, tileZ)));
+	return tile ? *tile : 0;
+}
+
+btVector3 hbrHeightfieldTerrain::gridToWorld(btScalar gridX, btScalar gridZ, btScalar height) const
+{
+	btVector3 pos = m_origin;
+	pos[m_gridAxis0] += gridX * m_sampleSpacing;
+	pos[m_gridAxis1] += gridZ * m_sampleSpacing;
+	pos[m_upAxis] += height;
+	return pos;
+}
+
+int hbrHeightfieldTerrain::tileMemory(const Tile* tile) const
+{
+	return int(sizeof(Tile) + sizeof(btHeightfieldTerrainShape) + sizeof(btCollisionObject) + tile->m_heights.size() * sizeof(float));
+}
+
+void hbrHeightfieldTerrain::buildShape(Tile* tile)
+{
+	btHeightfieldTerrainShape* shape = new btHeightfieldTerrainShape(m_tileSamples, m_tileSamples, &tile->m_heights[0],
+																	 btScalar(1.0), tile->m_minHeight, tile->m_maxHeight,
+																	 m_upAxis, PHY_FLOAT, false);
+	btVector3 scaling(m_sampleSpacing, m_sampleSpacing, m_sampleSpacing);
+	scaling[m_upAxis] = btScalar(1.0);
+	shape->setLocalScaling(scaling);
+
+	// the shape is centered on its grid and on the middle of its height range
+	btScalar halfTile = btScalar(m_tileSamples - 1) * btScalar(0.5);
+	btTransform xform;
+	xform.setIdentity();
+	xform.setOrigin(gridToWorld(tile->m_tileX * (m_tileSamples - 1) + halfTile,
+								tile->m_tileZ * (m_tileSamples - 1) + halfTile,
+								(tile->m_minHeight + tile->m_maxHeight) * btScalar(0.5)));
+
+	if (tile->m_object)
+	{
+		// drop cached pairs, their algorithms still reference the old shape
+		btBroadphaseProxy* proxy = tile->m_object->getBroadphaseHandle();
+		if (proxy)
+			m_world->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(proxy, m_world->getDispatcher());
+
+		tile->m_object->setCollisionShape(shape);
+		tile->m_object->setWorldTransform(xform);
+		delete tile->m_shape;
+		tile->m_shape = shape;
+		m_world->updateSingleAabb(tile->m_object);
+		return;
+	}
+
+	tile->m_shape = shape;
+	tile->m_object = new btCollisionObject();
+	tile->m_object->setCollisionShape(shape);
+	tile->m_object->setWorldTransform(xform);
+	tile->m_object->setFriction(m_friction);
+	tile->m_object->setRestitution(m_restitution);
+	tile->m_object->setCollisionFlags(tile->m_object->getCollisionFlags() | btCollisionObject::CF_STATIC_OBJECT);
+	m_world->addCollisionObject(tile->m_object, m_collisionFilterGroup, m_collisionFilterMask);
+}
+
+void hbrHeightfieldTerrain::destroyTile(Tile* tile)
+{
+	m_world->removeCollisionObject(tile->m_object);
+	delete tile->m_object;
+	delete tile->m_shape;
+	delete tile;
+}
+
+void hbrHeightfieldTerrain::setCollisionFilter(int group, int mask)
+{
+	m_collisionFilterGroup = group;
+	m_collisionFilterMask = mask;
+
+	for (int i = 0; i < m_tiles.size(); i++)
+	{
+		btBroadphaseProxy* proxy = m_tiles[i]->m_object->getBroadphaseHandle();
+		if (proxy)
+		{
+			proxy->m_collisionFilterGroup = group;
+			proxy->m_collisionFilterMask = mask;
+		}
+	}
+}
+
+bool hbrHeightfieldTerrain::loadTile(int tileX, int tileZ, const void* heights)
+{
+	if (!heights)
+		return false;
+
+	Tile* tile = findTile(tileX, tileZ);
+	if (tile)
+	{
+		unloadTile(tileX, tileZ);
+	}
+
+	tile = new Tile;
+	tile->m_tileX = tileX;
+	tile->m_tileZ = tileZ;
+	tile->m_shape = 0;
+	tile->m_object = 0;
+	tile->m_lastUsed = m_frame;
+
+	const float* src = static_cast<const float*>(heights);
+	int numSamples = m_tileSamples * m_tileSamples;
+	tile->m_heights.resize(numSamples);
+	tile->m_minHeight = src[0];
+	tile->m_maxHeight = src[0];
+	for (int i = 0; i < numSamples; i++)
+	{
+		tile->m_heights[i] = src[i];
+		tile->m_minHeight = btMin(tile->m_minHeight, btScalar(src[i]));
+		tile->m_maxHeight = btMax(tile->m_maxHeight, btScalar(src[i]));
+	}
+
+	buildShape(tile);
+
+	m_tiles.push_back(tile);
+	m_tileMap.insert(btHashInt(tileKey(tileX, tileZ)), tile);
+	m_memoryUsed += tileMemory(tile);
+
+	evict();
+	return true;
+}
+
+bool hbrHeightfieldTerrain::unloadTile(int tileX, int tileZ)
+{
+	Tile* tile = findTile(tileX, tileZ);
+	if (!tile)
+		return false;
+
+	m_tileMap.remove(btHashInt(tileKey(tileX, tileZ)));
+	m_tiles.remove(tile);
+	m_memoryUsed -= tileMemory(tile);
+	destroyTile(tile);
+	return true;
+}
+
+btCollisionObject* hbrHeightfieldTerrain::getTileObject(int tileX, int tileZ) const
+{
+	Tile* tile = findTile(tileX, tileZ);
+	return tile ? tile->m_object : 0;
+}
+
+int hbrHeightfieldTerrain::setHeights(int sampleX, int sampleZ, int width, int length, const void* heights)
+{
+	if (!heights || width <= 0 || length <= 0)
+		return 0;
+
+	const float* src = static_cast<const float*>(heights);
+	int tileSpan = m_tileSamples - 1;
+	int updated = 0;
+
+	for (int i = 0; i < m_tiles.size(); i++)
+	{
+		Tile* tile = m_tiles[i];
+		int tileStartX = tile->m_tileX * tileSpan;
+		int tileStartZ = tile->m_tileZ * tileSpan;
+
+		int x0 = btMax(sampleX, tileStartX);
+		int z0 = btMax(sampleZ, tileStartZ);
+		int x1 = btMin(sampleX + width, tileStartX + m_tileSamples);
+		int z1 = btMin(sampleZ + length, tileStartZ + m_tileSamples);
+		if (x0 >= x1 || z0 >= z1)
+			continue;
+
+		btScalar editMin = src[(z0 - sampleZ) * width + (x0 - sampleX)];
+		btScalar editMax = editMin;
+		for (int z = z0; z < z1; z++)
+		{
+			for (int x = x0; x < x1; x++)
+			{
+				float h = src[(z - sampleZ) * width + (x - sampleX)];
+				tile->m_heights[(z - tileStartZ) * m_tileSamples + (x - tileStartX)] = h;
+				editMin = btMin(editMin, btScalar(h));
+				editMax = btMax(editMax, btScalar(h));
+			}
+		}
+
+		if (editMin < tile->m_minHeight || editMax > tile->m_maxHeight)
+		{
+			// the height range is baked into the shape, so grow it and rebuild this tile only
+			tile->m_minHeight = btMin(tile->m_minHeight, editMin);
+			tile->m_maxHeight = btMax(tile->m_maxHeight, editMax);
+			buildShape(tile);
+		}
+
+		btVector3 aabbMin = gridToWorld(btScalar(x0), btScalar(z0), tile->m_minHeight);
+		btVector3 aabbMax = gridToWorld(btScalar(x1 - 1), btScalar(z1 - 1), tile->m_maxHeight);
+		hbrTerrainActivateCallback callback(tile->m_object);
+		m_world->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+
+		tile->m_lastUsed = m_frame;
+		updated++;
+	}
+	return updated;
+}
+
+void hbrHeightfieldTerrain::setMemoryBudget(int bytes)
+{
+	m_memoryBudget = bytes;
+	evict();
+}
+
+void hbrHeightfieldTerrain::evict()
+{
+	if (m_memoryBudget <= 0)
+		return;
+
+	while (m_memoryUsed > m_memoryBudget)
+	{
+		// never evict tiles touched since the last streaming update
+		Tile* oldest = 0;
+		for (int i = 0; i < m_tiles.size(); i++)
+		{
+			Tile* tile = m_tiles[i];
+			if (tile->m_lastUsed < m_frame && (!oldest || tile->m_lastUsed < oldest->m_lastUsed))
+				oldest = tile;
+		}
+		if (!oldest)
+			break;
+
+		unloadTile(oldest->m_tileX, oldest->m_tileZ);
+	}
+}
+
+int hbrHeightfieldTerrain::updateStreaming(const void* positions, int numPositions, btScalar radius, void* missingTiles, int maxMissing)
+{
+	m_frame++;
+
+	const float* pos = static_cast<const float*>(positions);
+	int* missing = static_cast<int*>(missingTiles);
+	int numMissing = 0;
+	btScalar tileSize = btScalar(m_tileSamples - 1) * m_sampleSpacing;
+
+	for (int i = 0; i < numPositions; i++)
+	{
+		btVector3 p(pos[i * 3], pos[i * 3 + 1], pos[i * 3 + 2]);
+		p -= m_origin;
+
+		int minX = int(btFloor((p[m_gridAxis0] - radius) / tileSize));
+		int maxX = int(btFloor((p[m_gridAxis0] + radius) / tileSize));
+		int minZ = int(btFloor((p[m_gridAxis1] - radius) / tileSize));
+		int maxZ = int(btFloor((p[m_gridAxis1] + radius) / tileSize));
+
+		for (int tz = minZ; tz <= maxZ; tz++)
+		{
+			for (int tx = minX; tx <= maxX; tx++)
+			{
+				Tile* tile = findTile(tx, tz);
+				if (tile)
+				{
+					tile->m_lastUsed = m_frame;
+					continue;
+				}
+
+				if (!missing || numMissing >= maxMissing)
+					continue;
+
+				bool listed = false;
+				for (int m = 0; m < numMissing && !listed; m++)
+				{
+					listed = missing[m * 2] == tx && missing[m * 2 + 1] == tz;
+				}
+				if (!listed)
+				{
+					missing[numMissing * 2] = tx;
+					missing[numMissing * 2 + 1] = tz;
+					numMissing++;
+				}
+			}
+		}
+	}
+
+	evict();
+	return numMissing;
+}
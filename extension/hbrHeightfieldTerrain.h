@@ -0,0 +1,111 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_HEIGHTFIELD_TERRAIN_H
+#define HBR_HEIGHTFIELD_TERRAIN_H
+
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+class btHeightfieldTerrainShape;
+
+///hbrHeightfieldTerrain is a large terrain made of square btHeightfieldTerrainShape tiles, each in its own static collision object.
+///Tile (tileX, tileZ) owns the global samples [tileX * (tileSamples - 1), (tileX + 1) * (tileSamples - 1)] along both grid axes,
+///so neighbouring tiles share their border row. Height data is copied in from JS heap buffers, row major with x running fastest.
+///Tiles can be streamed in and out around a set of positions and are evicted least recently used first once the memory budget is exceeded.
+ATTRIBUTE_ALIGNED16(class)
+hbrHeightfieldTerrain
+{
+protected:
+	struct Tile
+	{
+		int m_tileX;
+		int m_tileZ;
+		btAlignedObjectArray<float> m_heights;
+		btHeightfieldTerrainShape* m_shape;
+		btCollisionObject* m_object;
+		btScalar m_minHeight;
+		btScalar m_maxHeight;
+		unsigned int m_lastUsed;
+	};
+
+	btCollisionWorld* m_world;
+	int m_tileSamples;
+	btScalar m_sampleSpacing;
+	int m_upAxis;
+	int m_gridAxis0;
+	int m_gridAxis1;
+	btVector3 m_origin;
+
+	int m_collisionFilterGroup;
+	int m_collisionFilterMask;
+	btScalar m_friction;
+	btScalar m_restitution;
+
+	btHashMap<btHashInt, Tile*> m_tileMap;
+	btAlignedObjectArray<Tile*> m_tiles;
+
+	int m_memoryBudget;
+	int m_memoryUsed;
+	unsigned int m_frame;
+
+	static int tileKey(int tileX, int tileZ) { return (tileX & 0xffff) | (tileZ << 16); }
+
+	Tile* findTile(int tileX, int tileZ) const;
+	btVector3 gridToWorld(btScalar gridX, btScalar gridZ, btScalar height) const;
+	int tileMemory(const Tile* tile) const;
+	void buildShape(Tile * tile);
+	void destroyTile(Tile * tile);
+	void evict();
+
+public:
+	BT_DECLARE_ALIGNED_ALLOCATOR();
+
+	///tileSamples is the number of height samples along each tile edge (at least 2), sampleSpacing the world distance between samples.
+	hbrHeightfieldTerrain(btCollisionWorld * world, int tileSamples, btScalar sampleSpacing, int upAxis = 1);
+	~hbrHeightfieldTerrain();
+
+	///World position of global sample (0, 0). Only affects tiles loaded afterwards.
+	void setOrigin(const btVector3& origin) { m_origin = origin; }
+	const btVector3& getOrigin() const { return m_origin; }
+
+	void setCollisionFilter(int group, int mask);
+	void setFriction(btScalar friction) { m_friction = friction; }
+	void setRestitution(btScalar restitution) { m_restitution = restitution; }
+
+	///heights points to tileSamples * tileSamples floats. Replaces the tile if it is already loaded.
+	bool loadTile(int tileX, int tileZ, const void* heights);
+	bool unloadTile(int tileX, int tileZ);
+	bool isTileLoaded(int tileX, int tileZ) const { return findTile(tileX, tileZ) != 0; }
+	int getNumLoadedTiles() const { return m_tiles.size(); }
+	btCollisionObject* getTileObject(int tileX, int tileZ) const;
+
+	///Write width * length heights (row major) starting at global sample (sampleX, sampleZ) into every loaded tile they touch.
+	///Only the collision objects of the touched tiles get their AABB refreshed, and bodies resting there are woken up.
+	///Returns the number of tiles that were updated.
+	int setHeights(int sampleX, int sampleZ, int width, int length, const void* heights);
+
+	///Budget in bytes for height data plus per tile overhead, 0 means unlimited.
+	void setMemoryBudget(int bytes);
+	int getMemoryBudget() const { return m_memoryBudget; }
+	int getMemoryUsed() const { return m_memoryUsed; }
+
+	///Mark every tile within radius of the numPositions x, y, z floats at positions as in use, then evict
+	///least recently used tiles until the memory budget is met. Tiles in range that are not loaded are written
+	///to missingTiles as (tileX, tileZ) int pairs, up to maxMissing pairs. Returns the number of pairs written.
+	int updateStreaming(const void* positions, int numPositions, btScalar radius, void* missingTiles, int maxMissing);
+};
+
+#endif  // HBR_HEIGHTFIELD_TERRAIN_H
@@ -0,0 +1,210 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btDbvt.h"
+#include "BulletCollision/CollisionDispatch/btCollisionConfiguration.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h"
+#include "BulletCollision/CollisionDispatch/btManifoldResult.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "LinearMath/btAabbUtil2.h"
+#include "hbrInstancedShape.h"
+#include "hbrInstancedCollisionAlgorithm.h"
+
+struct hbrInstanceOverlapCallback : public btDbvt::ICollide
+{
+	hbrInstancedCollisionAlgorithm* m_algorithm;
+	const btCollisionObjectWrapper* m_instancedWrap;
+	const btCollisionObjectWrapper* m_otherWrap;
+	btVector3 m_otherAabbMin;
+	btVector3 m_otherAabbMax;
+	const btDispatcherInfo& m_dispatchInfo;
+	btManifoldResult* m_resultOut;
+
+	hbrInstanceOverlapCallback(hbrInstancedCollisionAlgorithm* algorithm, const btCollisionObjectWrapper* instancedWrap, const btCollisionObjectWrapper* otherWrap, const btVector3& otherAabbMin, const btVector3& otherAabbMax, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut)
+		: m_algorithm(algorithm),
+		  m_instancedWrap(instancedWrap),
+		  m_otherWrap(otherWrap),
+		  m_otherAabbMin(otherAabbMin),
+		  m_otherAabbMax(otherAabbMax),
+		  m_dispatchInfo(dispatchInfo),
+		  m_resultOut(resultOut)
+	{
+	}
+
+	void Process(const btDbvtNode* leaf)
+	{
+		m_algorithm->processInstance(leaf->dataAsInt, m_instancedWrap, m_otherWrap, m_otherAabbMin, m_otherAabbMax, m_dispatchInfo, m_resultOut);
+	}
+};
+
+hbrInstancedCollisionAlgorithm::hbrInstancedCollisionAlgorithm(const btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap, bool isSwapped)
+	: btActivatingCollisionAlgorithm(ci, body0Wrap, body1Wrap),
+	  m_sharedManifold(ci.m_manifold),
+	  m_isSwapped(isSwapped),
+	  m_stamp(0)
+{
+	const btCollisionObjectWrapper* instancedWrap = isSwapped ? body1Wrap : body0Wrap;
+	m_shapeRevision = static_cast<const hbrInstancedShape*>(instancedWrap->getCollisionShape())->getUpdateRevision();
+}
+
+hbrInstancedCollisionAlgorithm::~hbrInstancedCollisionAlgorithm()
+{
+	removeInstancePairs();
+}
+
+void hbrInstancedCollisionAlgorithm::removeInstancePairs()
+{
+	for (int i = 0; i < m_pairs.size(); i++)
+	{
+		btCollisionAlgorithm* algorithm = m_pairs.getAtIndex(i)->m_algorithm;
+		algorithm->~btCollisionAlgorithm();
+		m_dispatcher->freeCollisionAlgorithm(algorithm);
+	}
+	m_pairs.clear();
+}
+
+void hbrInstancedCollisionAlgorithm::processCollision(const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut)
+{
+	const btCollisionObjectWrapper* instancedWrap = m_isSwapped ? body1Wrap : body0Wrap;
+	const btCollisionObjectWrapper* otherWrap = m_isSwapped ? body0Wrap : body1Wrap;
+	const hbrInstancedShape* shape = static_cast<const hbrInstancedShape*>(instancedWrap->getCollisionShape());
+
+	// Instances were added or removed, the indices of the pairs may have changed
+	if (shape->getUpdateRevision() != m_shapeRevision)
+	{
+		removeInstancePairs();
+		m_shapeRevision = shape->getUpdateRevision();
+	}
+
+	// The child algorithms keep their manifolds, refresh the contact points of the ones that have some
+	btManifoldArray manifoldArray;
+	for (int i = 0; i < m_pairs.size(); i++)
+	{
+		m_pairs.getAtIndex(i)->m_algorithm->getAllContactManifolds(manifoldArray);
+		for (int m = 0; m < manifoldArray.size(); m++)
+		{
+			if (manifoldArray[m]->getNumContacts())
+			{
+				resultOut->setPersistentManifold(manifoldArray[m]);
+				resultOut->refreshContactPoints();
+				resultOut->setPersistentManifold(0);
+			}
+		}
+		manifoldArray.resize(0);
+	}
+
+	// The bounds of the other object in the space of the instances
+	btTransform otherInInstancedSpace = instancedWrap->getWorldTransform().inverse() * otherWrap->getWorldTransform();
+	btVector3 otherAabbMin, otherAabbMax;
+	otherWrap->getCollisionShape()->getAabb(otherInInstancedSpace, otherAabbMin, otherAabbMax);
+
+	m_stamp++;
+	const btDbvt* tree = shape->getDynamicAabbTree();
+	if (tree)
+	{
+		btDbvtVolume bounds = btDbvtVolume::FromMM(otherAabbMin, otherAabbMax);
+		hbrInstanceOverlapCallback callback(this, instancedWrap, otherWrap, otherAabbMin, otherAabbMax, dispatchInfo, resultOut);
+		tree->collideTV(tree->m_root, bounds, callback);
+	}
+
+	// Instances the other object left, remove() moves the last pair into the slot and that one was already visited
+	for (int i = m_pairs.size() - 1; i >= 0; i--)
+	{
+		const InstancePair* pair = m_pairs.getAtIndex(i);
+		if (pair->m_stamp != m_stamp)
+		{
+			btCollisionAlgorithm* algorithm = pair->m_algorithm;
+			algorithm->~btCollisionAlgorithm();
+			m_dispatcher->freeCollisionAlgorithm(algorithm);
+			m_pairs.remove(m_pairs.getKeyAtIndex(i));
+		}
+	}
+}
+
+void hbrInstancedCollisionAlgorithm::processInstance(int index, const btCollisionObjectWrapper* instancedWrap, const btCollisionObjectWrapper* otherWrap, const btVector3& otherAabbMin, const btVector3& otherAabbMax, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut)
+{
+	const hbrInstancedShape* shape = static_cast<const hbrInstancedShape*>(instancedWrap->getCollisionShape());
+	const btCollisionShape* childShape = shape->getChildShape(index);
+	const btTransform& childTransform = shape->getChildTransform(index);
+
+	// The tree leaves are enlarged by the margin, test the exact bounds of the instance
+	btVector3 aabbMin, aabbMax;
+	childShape->getAabb(childTransform, aabbMin, aabbMax);
+	if (!TestAabbAgainstAabb2(aabbMin, aabbMax, otherAabbMin, otherAabbMax))
+		return;
+
+	btTransform childWorldTransform = instancedWrap->getWorldTransform() * childTransform;
+	btCollisionObjectWrapper childWrap(instancedWrap, childShape, instancedWrap->getCollisionObject(), childWorldTransform, -1, index);
+
+	InstancePair* pair = m_pairs.find(btHashInt(index));
+	if (!pair)
+	{
+		InstancePair newPair;
+#if BT_BULLET_VERSION >= 285
+		newPair.m_algorithm = m_dispatcher->findAlgorithm(&childWrap, otherWrap, m_sharedManifold, BT_CONTACT_POINT_ALGORITHMS);
+#else
+		newPair.m_algorithm = m_dispatcher->findAlgorithm(&childWrap, otherWrap, m_sharedManifold);
+#endif
+		newPair.m_stamp = m_stamp;
+		m_pairs.insert(btHashInt(index), newPair);
+		pair = m_pairs.find(btHashInt(index));
+	}
+	pair->m_stamp = m_stamp;
+
+	// Report the instance as the index of the shape, like btCompoundCollisionAlgorithm does for its children
+	const btCollisionObjectWrapper* previousWrap;
+	if (resultOut->getBody0Internal() == instancedWrap->getCollisionObject())
+	{
+		previousWrap = resultOut->getBody0Wrap();
+		resultOut->setBody0Wrap(&childWrap);
+		resultOut->setShapeIdentifiersA(-1, index);
+	}
+	else
+	{
+		previousWrap = resultOut->getBody1Wrap();
+		resultOut->setBody1Wrap(&childWrap);
+		resultOut->setShapeIdentifiersB(-1, index);
+	}
+
+	pair->m_algorithm->processCollision(&childWrap, otherWrap, dispatchInfo, resultOut);
+
+	if (resultOut->getBody0Internal() == instancedWrap->getCollisionObject())
+		resultOut->setBody0Wrap(previousWrap);
+	else
+		resultOut->setBody1Wrap(previousWrap);
+}
+
+btScalar hbrInstancedCollisionAlgorithm::calculateTimeOfImpact(btCollisionObject* body0, btCollisionObject* body1, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut)
+{
+	// Only used by continuous dispatch, the discrete world sweeps fast bodies with convexSweepTest instead
+	return btScalar(1.);
+}
+
+void hbrInstancedCollisionAlgorithm::getAllContactManifolds(btManifoldArray& manifoldArray)
+{
+	for (int i = 0; i < m_pairs.size(); i++)
+	{
+		m_pairs.getAtIndex(i)->m_algorithm->getAllContactManifolds(manifoldArray);
+	}
+}
+
+btCollisionAlgorithm* hbrInstancedCollisionAlgorithm::CreateFunc::CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap)
+{
+	const btCollisionShape* instancedShape = (m_swapped ? body1Wrap : body0Wrap)->getCollisionShape();
+	if (!dynamic_cast<const hbrInstancedShape*>(instancedShape))
+	{
+		btCollisionAlgorithmCreateFunc* createFunc = m_configuration->getCollisionAlgorithmCreateFunc(body0Wrap->getCollisionShape()->getShapeType(), body1Wrap->getCollisionShape()->getShapeType());
+		return createFunc->CreateCollisionAlgorithm(ci, body0Wrap, body1Wrap);
+	}
+	void* memory = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(hbrInstancedCollisionAlgorithm));
+	return new (memory) hbrInstancedCollisionAlgorithm(ci, body0Wrap, body1Wrap, m_swapped);
+}
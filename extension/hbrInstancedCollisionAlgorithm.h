@@ -0,0 +1,74 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_INSTANCED_COLLISION_ALGORITHM_H
+#define HBR_INSTANCED_COLLISION_ALGORITHM_H
+
+#include "BulletCollision/CollisionDispatch/btActivatingCollisionAlgorithm.h"
+#include "BulletCollision/CollisionDispatch/btCollisionCreateFunc.h"
+#include "LinearMath/btHashMap.h"
+
+class btCollisionConfiguration;
+
+///hbrInstancedCollisionAlgorithm collides an hbrInstancedShape with a shape that is not a compound. Unlike
+///btCompoundCollisionAlgorithm, which keeps a slot per child and visits all of them every step, it only keeps the
+///child algorithms of the instances that currently overlap the other object, found through the dynamic AABB tree of
+///the shape. A step costs the overlapping instances rather than all of them.
+///hbrCollisionDispatcher registers it, other compounds and compound pairs keep the algorithms of the configuration.
+class hbrInstancedCollisionAlgorithm : public btActivatingCollisionAlgorithm
+{
+protected:
+	struct InstancePair
+	{
+		btCollisionAlgorithm* m_algorithm;
+		int m_stamp;
+	};
+
+	// Child algorithms of the overlapping instances by instance index, stamped with the last step that touched them
+	btHashMap<btHashInt, InstancePair> m_pairs;
+	btPersistentManifold* m_sharedManifold;
+	bool m_isSwapped;
+	int m_stamp;
+	int m_shapeRevision;
+
+	void removeInstancePairs();
+
+public:
+	hbrInstancedCollisionAlgorithm(const btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap, bool isSwapped);
+	virtual ~hbrInstancedCollisionAlgorithm();
+
+	virtual void processCollision(const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut);
+	virtual btScalar calculateTimeOfImpact(btCollisionObject* body0, btCollisionObject* body1, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut);
+	virtual void getAllContactManifolds(btManifoldArray& manifoldArray);
+
+	///Collides the instance with the other object, called for the instances the tree reports.
+	void processInstance(int index, const btCollisionObjectWrapper* instancedWrap, const btCollisionObjectWrapper* otherWrap, const btVector3& otherAabbMin, const btVector3& otherAabbMax, const btDispatcherInfo& dispatchInfo, btManifoldResult* resultOut);
+
+	int getNumInstancePairs() const { return m_pairs.size(); }
+
+	///Registered for compounds against every shape type but compounds. Pairs without an hbrInstancedShape get the
+	///algorithm of the collision configuration.
+	struct CreateFunc : public btCollisionAlgorithmCreateFunc
+	{
+		btCollisionConfiguration* m_configuration;
+
+		CreateFunc(btCollisionConfiguration* configuration, bool swapped)
+			: m_configuration(configuration)
+		{
+			m_swapped = swapped;
+		}
+
+		virtual btCollisionAlgorithm* CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci, const btCollisionObjectWrapper* body0Wrap, const btCollisionObjectWrapper* body1Wrap);
+	};
+};
+
+#endif  // HBR_INSTANCED_COLLISION_ALGORITHM_H
@@ -0,0 +1,56 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btDbvt.h"
+#include "hbrInstancedShape.h"
+
+hbrInstancedShape::hbrInstancedShape(btCollisionShape* instanceShape)
+	: btCompoundShape(true),
+	  m_instanceShape(instanceShape)
+{
+}
+
+int hbrInstancedShape::addInstance(const btTransform& transform)
+{
+	addChildShape(transform, m_instanceShape);
+	return m_children.size() - 1;
+}
+
+int hbrInstancedShape::addInstances(const void* transforms, int count)
+{
+	const float* data = static_cast<const float*>(transforms);
+	int first = m_children.size();
+	if (count <= 0)
+		return first;
+
+	m_children.reserve(first + count);
+	for (int i = 0; i < count; i++, data += 7)
+	{
+		btTransform transform(btQuaternion(data[3], data[4], data[5], data[6]), btVector3(data[0], data[1], data[2]));
+		addChildShape(transform, m_instanceShape);
+	}
+
+	// Leaves inserted one by one give a tree that depends on the order of the instances, rebuild it top-down. The
+	// leaves stay, so the child nodes remain valid.
+	if (m_dynamicAabbTree)
+		m_dynamicAabbTree->optimizeTopDown();
+	return first;
+}
+
+bool hbrInstancedShape::removeInstance(int index)
+{
+	if (index < 0 || index >= m_children.size())
+		return false;
+
+	removeChildShapeByIndex(index);
+	return true;
+}
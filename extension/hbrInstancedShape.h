@@ -0,0 +1,91 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_INSTANCED_SHAPE_H
+#define HBR_INSTANCED_SHAPE_H
+
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+
+///hbrInstancedShape places one shared shape many times, e.g. the rocks or fences of a level. Put it on a single static
+///body instead of creating a body per prop: the world then holds one broadphase proxy and one object for all of them.
+///The instances are the children of a btCompoundShape with its dynamic AABB tree, so narrowphase only runs against the
+///instances whose bounds overlap the other object. Each instance costs a transform, the tree leaf and a few pointers.
+///Ray and convex sweep results report the instance as the triangle index of LocalShapeInfo, see
+///hbrClosestRayResultCallback and hbrClosestConvexResultCallback.
+///Use an hbrCollisionDispatcher: btCompoundCollisionAlgorithm keeps a slot per instance for every pair the body is in
+///and visits all of them each step, hbrInstancedCollisionAlgorithm only the instances the other object overlaps.
+class hbrInstancedShape : public btCompoundShape
+{
+protected:
+	btCollisionShape* m_instanceShape;
+
+public:
+	hbrInstancedShape(btCollisionShape * instanceShape);
+
+	///Returns the index of the new instance.
+	int addInstance(const btTransform& transform);
+	///transforms holds count * 7 floats (px, py, pz, qx, qy, qz, qw). Rebuilds the tree once for the whole set.
+	///Returns the index of the first new instance.
+	int addInstances(const void* transforms, int count);
+	///The last instance takes the index of the removed one.
+	bool removeInstance(int index);
+
+	int getNumInstances() const { return getNumChildShapes(); }
+	btCollisionShape* getInstanceShape() const { return m_instanceShape; }
+};
+
+///Closest ray hit that also keeps the shape part and triangle index of the hit. For an hbrInstancedShape (or any
+///compound of convex shapes) the index is the instance, for a triangle mesh it is the triangle. Both are -1 when the
+///shape reports neither.
+struct hbrClosestRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+	int m_hitShapePart;
+	int m_hitIndex;
+
+	hbrClosestRayResultCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld)
+		: btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld),
+		  m_hitShapePart(-1),
+		  m_hitIndex(-1)
+	{
+	}
+
+	virtual btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+	{
+		m_hitShapePart = rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_shapePart : -1;
+		m_hitIndex = rayResult.m_localShapeInfo ? rayResult.m_localShapeInfo->m_triangleIndex : -1;
+		return ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+	}
+};
+
+///The sweep counterpart of hbrClosestRayResultCallback.
+struct hbrClosestConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+	int m_hitShapePart;
+	int m_hitIndex;
+
+	hbrClosestConvexResultCallback(const btVector3& convexFromWorld, const btVector3& convexToWorld)
+		: btCollisionWorld::ClosestConvexResultCallback(convexFromWorld, convexToWorld),
+		  m_hitShapePart(-1),
+		  m_hitIndex(-1)
+	{
+	}
+
+	virtual btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+	{
+		m_hitShapePart = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_shapePart : -1;
+		m_hitIndex = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_triangleIndex : -1;
+		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+	}
+};
+
+#endif  // HBR_INSTANCED_SHAPE_H
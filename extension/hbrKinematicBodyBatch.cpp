@@ -0,0 +1,115 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btTransformUtil.h"
+#include "LinearMath/btMotionState.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "hbrKinematicBodyBatch.h"
+#include "hbrActiveSetDynamicsWorld.h"
+
+hbrKinematicBodyBatch::hbrKinematicBodyBatch(btCollisionWorld* world)
+	: m_world(world),
+	  m_numBodies(0)
+{
+}
+
+int hbrKinematicBodyBatch::addBody(btCollisionObject* body)
+{
+	if (!body)
+		return -1;
+
+	// activate() ignores static and kinematic objects, so keep them awake for good instead
+	body->setCollisionFlags(body->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+	body->forceActivationState(DISABLE_DEACTIVATION);
+	// A body added static is not in the awake set of the world
+	if (hbrActiveSetDynamicsWorld* activeSet = dynamic_cast<hbrActiveSetDynamicsWorld*>(m_world))
+		activeSet->activateBody(body);
+
+	int index;
+	if (m_freeSlots.size())
+	{
+		index = m_freeSlots[m_freeSlots.size() - 1];
+		m_freeSlots.pop_back();
+		m_bodies[index] = body;
+	}
+	else
+	{
+		index = m_bodies.size();
+		m_bodies.push_back(body);
+	}
+	m_numBodies++;
+	return index;
+}
+
+bool hbrKinematicBodyBatch::removeBody(int index)
+{
+	if (index < 0 || index >= m_bodies.size() || !m_bodies[index])
+		return false;
+
+	m_bodies[index] = 0;
+	m_freeSlots.push_back(index);
+	m_numBodies--;
+	return true;
+}
+
+btCollisionObject* hbrKinematicBodyBatch::getBody(int index) const
+{
+	if (index < 0 || index >= m_bodies.size())
+		return 0;
+	return m_bodies[index];
+}
+
+int hbrKinematicBodyBatch::setTransforms(const void* indices, const void* transforms, int count, btScalar timeStep)
+{
+	const int* idx = static_cast<const int*>(indices);
+	const float* data = static_cast<const float*>(transforms);
+	int moved = 0;
+
+	for (int i = 0; i < count; i++, data += 7)
+	{
+		btCollisionObject* body = getBody(idx[i]);
+		if (!body)
+			continue;
+
+		btTransform target(btQuaternion(data[3], data[4], data[5], data[6]), btVector3(data[0], data[1], data[2]));
+		btTransform previous = body->getWorldTransform();
+
+		btVector3 linearVelocity(0, 0, 0);
+		btVector3 angularVelocity(0, 0, 0);
+		if (timeStep > btScalar(0.0))
+		{
+			btTransformUtil::calculateVelocity(previous, target, timeStep, linearVelocity, angularVelocity);
+		}
+
+		body->setInterpolationWorldTransform(previous);
+		body->setInterpolationLinearVelocity(linearVelocity);
+		body->setInterpolationAngularVelocity(angularVelocity);
+		body->setWorldTransform(target);
+
+		// stepSimulation derives kinematic velocities from the motion state, keep it in sync
+		// so saveKinematicState ends up with the same velocities we just computed
+		btRigidBody* rigidBody = btRigidBody::upcast(body);
+		if (rigidBody)
+		{
+			rigidBody->setLinearVelocity(linearVelocity);
+			rigidBody->setAngularVelocity(angularVelocity);
+			if (rigidBody->getMotionState())
+				rigidBody->getMotionState()->setWorldTransform(target);
+		}
+
+		if (body->getBroadphaseHandle())
+			m_world->updateSingleAabb(body);
+		moved++;
+	}
+	return moved;
+}
@@ -0,0 +1,47 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_KINEMATIC_BODY_BATCH_H
+#define HBR_KINEMATIC_BODY_BATCH_H
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+
+///hbrKinematicBodyBatch moves many kinematic objects (platforms, doors, elevators) with a single call per frame.
+///For each moved object the interpolation velocities are derived from the previous and the target transform, so
+///hbrKinematicCharacterController::inheritVelocity and contacts with dynamic bodies see the platform motion.
+class hbrKinematicBodyBatch
+{
+protected:
+	btCollisionWorld* m_world;
+	btAlignedObjectArray<btCollisionObject*> m_bodies;
+	btAlignedObjectArray<int> m_freeSlots;
+	int m_numBodies;
+
+public:
+	hbrKinematicBodyBatch(btCollisionWorld* world);
+
+	///Registers an object, flags it kinematic and disables its deactivation. Returns the index to use in setTransforms.
+	int addBody(btCollisionObject* body);
+	bool removeBody(int index);
+	btCollisionObject* getBody(int index) const;
+	int getNumBodies() const { return m_numBodies; }
+
+	///indices holds count ints, transforms holds count * 7 floats (px, py, pz, qx, qy, qz, qw).
+	///Call once per stepSimulation with the same time step. Returns the number of objects moved.
+	int setTransforms(const void* indices, const void* transforms, int count, btScalar timeStep);
+};
+
+#endif  // HBR_KINEMATIC_BODY_BATCH_H
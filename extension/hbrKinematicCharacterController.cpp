@@ -22,6 +22,7 @@ subject to the following restrictions:
 #include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
 #include "LinearMath/btDefaultMotionState.h"
 #include "hbrKinematicCharacterController.h"
+#include "hbrCollisionLayers.h"
 
 // static helper method
 static btVector3
@@ -66,10 +67,18 @@ class btKinematicClosestNotMeConvexResultCallback : public btCollisionWorld::Clo
 {
 public:
 	btKinematicClosestNotMeConvexResultCallback(btCollisionObject *me, const btVector3 &up, btScalar minSlopeDot)
-		: btCollisionWorld::ClosestConvexResultCallback(btVector3(0.0, 0.0, 0.0), btVector3(0.0, 0.0, 0.0)), m_me(me), m_up(up), m_minSlopeDot(minSlopeDot)
+		: btCollisionWorld::ClosestConvexResultCallback(btVector3(0.0, 0.0, 0.0), btVector3(0.0, 0.0, 0.0)), m_layers(0), m_hitIndex(-1), m_me(me), m_up(up), m_minSlopeDot(minSlopeDot)
 	{
 	}
 
+	virtual bool needsCollision(btBroadphaseProxy *proxy0) const
+	{
+		if (m_layers)
+			return m_layers->needsCollision(m_collisionFilterGroup, proxy0);
+
+		return ClosestConvexResultCallback::needsCollision(proxy0);
+	}
+
 	virtual btScalar addSingleResult(btCollisionWorld::LocalConvexResult &convexResult, bool normalInWorldSpace)
 	{
 		if (convexResult.m_hitCollisionObject == m_me)
@@ -95,9 +104,15 @@ public:
 			return btScalar(1.0);
 		}
 
+		m_hitIndex = convexResult.m_localShapeInfo ? convexResult.m_localShapeInfo->m_triangleIndex : -1;
 		return ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
 	}
 
+	///Layer matrix of the controller, replaces the group/mask test when set
+	const hbrCollisionLayers *m_layers;
+	///Instance or triangle of the closest hit, -1 when the shape reports neither
+	int m_hitIndex;
+
 protected:
 	btCollisionObject *m_me;
 	const btVector3 m_up;
@@ -173,6 +188,7 @@ btVector3 hbrKinematicCharacterController::perpindicularComponent(const btVector
 hbrKinematicCharacterController::hbrKinematicCharacterController(btPairCachingGhostObject *ghostObject, btConvexShape *convexShape, btScalar stepHeight, const btVector3 &up)
 {
 	m_ghostObject = ghostObject;
+	m_collisionLayers = 0;
 	m_up.setValue(0.0f, 0.0f, 1.0f);
 	m_jumpAxis.setValue(0.0f, 0.0f, 1.0f);
 	m_addedMargin = 0.02;
@@ -191,6 +207,8 @@ hbrKinematicCharacterController::hbrKinematicCharacterController(btPairCachingGh
 	m_jumpSpeed = 10.0;	// ?
 	m_SetjumpSpeed = m_jumpSpeed;
 	m_wasOnGround = false;
+	m_groundObject = 0;
+	m_groundIndex = -1;
 	m_wasJumping = false;
 	m_interpolateUp = true;
 	m_currentStepOffset = 0.0;
@@ -342,6 +360,7 @@ void hbrKinematicCharacterController::stepUp(btCollisionWorld *world)
 	btKinematicClosestNotMeConvexResultCallback callback(m_ghostObject, -m_up, m_maxSlopeCosine);
 	callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
+	callback.m_layers = m_collisionLayers;
 
 	if (m_useGhostObjectSweepTest)
 	{
@@ -352,7 +371,7 @@ void hbrKinematicCharacterController::stepUp(btCollisionWorld *world)
 		world->convexSweepTest(m_convexShape, start, end, callback, world->getDispatchInfo().m_allowedCcdPenetration);
 	}
 
-	if (callback.hasHit() && m_ghostObject->hasContactResponse() && needsCollision(m_ghostObject, callback.m_hitCollisionObject))
+	if (callback.hasHit() && m_ghostObject->hasContactResponse())
 	{
 		// printf("Step_m_hitNormalWorld=%f,%f,%f\n",callback.m_hitNormalWorld[0],callback.m_hitNormalWorld[1],callback.m_hitNormalWorld[2]);
 
@@ -405,6 +424,9 @@ void hbrKinematicCharacterController::stepUp(btCollisionWorld *world)
 
 bool hbrKinematicCharacterController::needsCollision(const btCollisionObject *body0, const btCollisionObject *body1)
 {
+	if (m_collisionLayers)
+		return m_collisionLayers->needBroadphaseCollision(body0->getBroadphaseHandle(), body1->getBroadphaseHandle());
+
 	bool collides = (body0->getBroadphaseHandle()->m_collisionFilterGroup & body1->getBroadphaseHandle()->m_collisionFilterMask) != 0;
 	collides = collides && (body1->getBroadphaseHandle()->m_collisionFilterGroup & body0->getBroadphaseHandle()->m_collisionFilterMask);
 	return collides;
@@ -480,6 +502,7 @@ void hbrKinematicCharacterController::stepForwardAndStrafe(btCollisionWorld *col
 		btKinematicClosestNotMeConvexResultCallback callback(m_ghostObject, sweepDirNegative, btScalar(0.0));
 		callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 		callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
+		callback.m_layers = m_collisionLayers;
 
 		btScalar margin = m_convexShape->getMargin();
 		m_convexShape->setMargin(margin + m_addedMargin);
@@ -500,7 +523,7 @@ void hbrKinematicCharacterController::stepForwardAndStrafe(btCollisionWorld *col
 		fraction -= callback.m_closestHitFraction;
 
 		updatePosition = true;
-		if (callback.hasHit() && m_ghostObject->hasContactResponse() && needsCollision(m_ghostObject, callback.m_hitCollisionObject))
+		if (callback.hasHit() && m_ghostObject->hasContactResponse())
 		{
 			// we moved only a fraction
 			//btScalar hitDistance;
@@ -575,10 +598,12 @@ void hbrKinematicCharacterController::stepDown(btCollisionWorld *collisionWorld,
 	btKinematicClosestNotMeConvexResultCallback callback(m_ghostObject, m_up, m_maxSlopeCosine);
 	callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
+	callback.m_layers = m_collisionLayers;
 
 	btKinematicClosestNotMeConvexResultCallback callback2(m_ghostObject, m_up, m_maxSlopeCosine);
 	callback2.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback2.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
+	callback2.m_layers = m_collisionLayers;
 
 	while (1)
 	{
@@ -620,9 +645,9 @@ void hbrKinematicCharacterController::stepDown(btCollisionWorld *collisionWorld,
 		btScalar downVelocity2 = (m_verticalVelocity < 0.f ? -m_verticalVelocity : 0.f) * dt;
 		bool has_hit;
 		if (bounce_fix == true)
-			has_hit = (callback.hasHit() || callback2.hasHit()) && m_ghostObject->hasContactResponse() && needsCollision(m_ghostObject, callback.m_hitCollisionObject);
+			has_hit = (callback.hasHit() || callback2.hasHit()) && m_ghostObject->hasContactResponse();
 		else
-			has_hit = callback2.hasHit() && m_ghostObject->hasContactResponse() && needsCollision(m_ghostObject, callback2.m_hitCollisionObject);
+			has_hit = callback2.hasHit() && m_ghostObject->hasContactResponse();
 
 		btScalar stepHeight = 0.0f;
 		if (m_verticalVelocity < 0.0)
@@ -644,7 +669,7 @@ void hbrKinematicCharacterController::stepDown(btCollisionWorld *collisionWorld,
 		break;
 	}
 
-	if ((m_ghostObject->hasContactResponse() && (callback.hasHit() && needsCollision(m_ghostObject, callback.m_hitCollisionObject))) || runonce == true)
+	if ((m_ghostObject->hasContactResponse() && callback.hasHit()) || runonce == true)
 	{
 		// we dropped a fraction of the height -> hit floor
 		btScalar fraction = (m_currentPosition.getY() - callback.m_hitPointWorld.getY()) / 2;
@@ -668,6 +693,10 @@ void hbrKinematicCharacterController::stepDown(btCollisionWorld *collisionWorld,
 		m_verticalOffset = 0.0;
 		m_wasJumping = false;
 		m_onGround = true;
+
+		const btKinematicClosestNotMeConvexResultCallback &ground = callback.hasHit() ? callback : callback2;
+		m_groundObject = ground.m_hitCollisionObject;
+		m_groundIndex = ground.m_hitIndex;
 	}
 	else
 	{
@@ -771,6 +800,8 @@ void hbrKinematicCharacterController::reset(btCollisionWorld *collisionWorld)
 	m_verticalOffset = 0.0;
 	m_wasOnGround = false;
 	m_wasJumping = false;
+	m_groundObject = 0;
+	m_groundIndex = -1;
 	m_walkDirection.setValue(0, 0, 0);
 	m_velocityTimeInterval = 0.0;
 
@@ -790,6 +821,13 @@ void hbrKinematicCharacterController::warp(const btVector3 &origin)
 	m_ghostObject->setWorldTransform(xform);
 }
 
+void hbrKinematicCharacterController::shiftOrigin(const btVector3 &offset)
+{
+	m_currentPosition += offset;
+	m_targetPosition += offset;
+	m_jumpPosition += offset;
+}
+
 void hbrKinematicCharacterController::preStep(btCollisionWorld *collisionWorld)
 {
 	m_currentPosition = m_ghostObject->getWorldTransform().getOrigin();
@@ -837,6 +875,8 @@ void hbrKinematicCharacterController::playerStep(btCollisionWorld *collisionWorl
 	m_wasOnGround = m_onGround;
 
 	m_onGround = false;
+	m_groundObject = 0;
+	m_groundIndex = -1;
 
 	inheritVelocity(collisionWorld, dt);
 
@@ -984,6 +1024,7 @@ void hbrKinematicCharacterController::inheritVelocity(btCollisionWorld *collisio
 	btKinematicClosestNotMeConvexResultCallback callback(m_ghostObject, m_up, m_maxSlopeCosine);
 	callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
+	callback.m_layers = m_collisionLayers;
 
 	btVector3 startVec = m_currentPosition + m_externalVelocity * dt * 0.5;
 
@@ -1040,6 +1081,8 @@ void hbrKinematicCharacterController::inheritVelocity(btCollisionWorld *collisio
 
 		m_externalVelocity = newVelocity;
 		m_onGround = true;
+		m_groundObject = callback.m_hitCollisionObject;
+		m_groundIndex = callback.m_hitIndex;
 	}
 }
 
@@ -1257,6 +1300,16 @@ bool hbrKinematicCharacterController::onGround() const
 	return m_onGround;
 }
 
+const btCollisionObject *hbrKinematicCharacterController::getGroundObject() const
+{
+	return m_groundObject;
+}
+
+int hbrKinematicCharacterController::getGroundIndex() const
+{
+	return m_groundIndex;
+}
+
 void hbrKinematicCharacterController::setStepHeight(btScalar h)
 {
 	m_stepHeight = h;
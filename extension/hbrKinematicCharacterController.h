@@ -25,9 +25,11 @@ subject to the following restrictions:
 class btCollisionShape;
 class btConvexShape;
 class btRigidBody;
+class btCollisionObject;
 class btCollisionWorld;
 class btCollisionDispatcher;
 class btPairCachingGhostObject;
+class hbrCollisionLayers;
 
 ///hbrKinematicCharacterController is an object that supports a sliding motion in a world.
 ///It uses a ghost object and convex sweep test to test for upcoming collisions. This is combined with discrete collision detection to recover from penetrations.
@@ -86,6 +88,9 @@ protected:
 	bool m_isAirWalking;
 
 	bool m_onGround;
+	///What the character stands on and the instance or triangle of it, see getGroundIndex
+	const btCollisionObject* m_groundObject;
+	int m_groundIndex;
 
 	btVector3 m_jumpPosition;
 
@@ -100,6 +105,8 @@ protected:
 	///keep track of the contact manifolds
 	btManifoldArray m_manifoldArray;
 
+	hbrCollisionLayers* m_collisionLayers;
+
 	bool m_touchingContact;
 	btVector3 m_touchingNormal;
 
@@ -186,6 +193,9 @@ public:
 
 	void reset(btCollisionWorld * collisionWorld);
 	void warp(const btVector3& origin);
+	///Moves the positions the controller keeps between steps by offset, for a world whose origin moved. The ghost object
+	///is not moved, that is done with the rest of the world (see hbrFloatingOrigin).
+	void shiftOrigin(const btVector3& offset);
 
 	void preStep(btCollisionWorld * collisionWorld);
 	void playerStep(btCollisionWorld * collisionWorld, btScalar dt);
@@ -239,7 +249,16 @@ public:
 		m_useGhostObjectSweepTest = useGhostObjectSweepTest;
 	}
 
+	///Filters sweeps and penetration recovery through a layer matrix instead of the ghost's group and mask.
+	void setCollisionLayers(hbrCollisionLayers * layers) { m_collisionLayers = layers; }
+	hbrCollisionLayers* getCollisionLayers() const { return m_collisionLayers; }
+
 	bool onGround() const;
+	///The object found below the character in the last step, 0 when it is not on ground.
+	const btCollisionObject* getGroundObject() const;
+	///The instance of an hbrInstancedShape (or child of a compound, triangle of a mesh) the character stands on, -1
+	///when the ground shape reports none.
+	int getGroundIndex() const;
 	void setUpInterpolate(bool value);
 };
 
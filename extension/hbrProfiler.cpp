@@ -0,0 +1,132 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btQuickprof.h"
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "hbrProfiler.h"
+
+hbrProfiler::hbrProfiler()
+	: m_capturedTime(0),
+	  m_numCollisionObjects(0),
+	  m_numActiveObjects(0),
+	  m_numOverlappingPairs(0),
+	  m_numManifolds(0),
+	  m_numContactPoints(0),
+	  m_numConstraints(0),
+	  m_configuredSolverIterations(0)
+{
+	reset();
+}
+
+bool hbrProfiler::isEnabled() const
+{
+#ifdef BT_NO_PROFILE
+	return false;
+#else
+	return true;
+#endif
+}
+
+void hbrProfiler::reset()
+{
+#ifndef BT_NO_PROFILE
+	CProfileManager::Reset();
+#endif
+}
+
+const char* hbrProfiler::getScopeName(int index) const
+{
+	if (index < 0 || index >= m_names.size())
+		return "";
+	return m_names[index];
+}
+
+void hbrProfiler::captureChildren(CProfileIterator* iterator, int depth, int parent)
+{
+#ifndef BT_NO_PROFILE
+	int index = 0;
+	for (iterator->First(); !iterator->Is_Done(); index++)
+	{
+		// Reset keeps the nodes of earlier steps around, skip the ones that did not run since then
+		if (!iterator->Get_Current_Total_Calls())
+		{
+			iterator->Next();
+			continue;
+		}
+
+		int self = m_names.size();
+		m_names.push_back(iterator->Get_Current_Name());
+		m_scopes.push_back(float(depth));
+		m_scopes.push_back(float(parent));
+		m_scopes.push_back(iterator->Get_Current_Total_Time());
+		m_scopes.push_back(float(iterator->Get_Current_Total_Calls()));
+
+		iterator->Enter_Child(index);
+		captureChildren(iterator, depth + 1, self);
+		iterator->Enter_Parent();
+
+		// Enter_Parent rewinds to the first child, walk back to the next sibling
+		iterator->First();
+		for (int i = 0; i <= index && !iterator->Is_Done(); i++)
+		{
+			iterator->Next();
+		}
+	}
+#endif
+}
+
+int hbrProfiler::capture(btDynamicsWorld* world)
+{
+	m_scopes.resize(0);
+	m_names.resize(0);
+	m_capturedTime = 0;
+
+#ifndef BT_NO_PROFILE
+	CProfileIterator* iterator = CProfileManager::Get_Iterator();
+	if (iterator)
+	{
+		captureChildren(iterator, 0, -1);
+		CProfileManager::Release_Iterator(iterator);
+	}
+	m_capturedTime = CProfileManager::Get_Time_Since_Reset();
+	CProfileManager::Reset();
+#endif
+
+	if (world)
+	{
+		const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+		m_numCollisionObjects = objects.size();
+		m_numActiveObjects = 0;
+		for (int i = 0; i < objects.size(); i++)
+		{
+			if (objects[i]->isActive() && !objects[i]->isStaticObject())
+				m_numActiveObjects++;
+		}
+
+		m_numOverlappingPairs = world->getPairCache()->getNumOverlappingPairs();
+
+		btDispatcher* dispatcher = world->getDispatcher();
+		m_numManifolds = dispatcher->getNumManifolds();
+		m_numContactPoints = 0;
+		for (int i = 0; i < m_numManifolds; i++)
+		{
+			m_numContactPoints += dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+		}
+
+		m_numConstraints = world->getNumConstraints();
+		m_configuredSolverIterations = world->getSolverInfo().m_numIterations;
+	}
+	return m_names.size();
+}
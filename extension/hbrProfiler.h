@@ -0,0 +1,71 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_PROFILER_H
+#define HBR_PROFILER_H
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btDynamicsWorld;
+class CProfileIterator;
+
+///hbrProfiler reads Bullet's BT_PROFILE scopes after a step. Scopes are only compiled into the profile build
+///(python make.py profile), the regular builds define BT_NO_PROFILE and report world counters only.
+///capture() flattens the scope tree depth first into 4 floats per scope: depth, index of the parent scope (-1 for
+///roots), total time in milliseconds and number of calls. Timings cover everything since the previous capture, so
+///calling it after every stepSimulation gives per step numbers. Scopes that did not run in that window are left out.
+class hbrProfiler
+{
+protected:
+	btAlignedObjectArray<float> m_scopes;
+	btAlignedObjectArray<const char*> m_names;
+	float m_capturedTime;
+
+	int m_numCollisionObjects;
+	int m_numActiveObjects;
+	int m_numOverlappingPairs;
+	int m_numManifolds;
+	int m_numContactPoints;
+	int m_numConstraints;
+	int m_configuredSolverIterations;
+
+	void captureChildren(CProfileIterator * iterator, int depth, int parent);
+
+public:
+	hbrProfiler();
+
+	bool isEnabled() const;
+
+	///Reads the scope tree and the counters of world (if not null), then resets the scope timings.
+	///Returns the number of scopes.
+	int capture(btDynamicsWorld * world);
+	///Discards the timings gathered so far.
+	void reset();
+
+	int getNumScopes() const { return m_names.size(); }
+	const void* getScopes() const { return m_scopes.size() ? &m_scopes[0] : 0; }
+	const char* getScopeName(int index) const;
+	///Wall time covered by the last capture, in milliseconds.
+	float getCapturedTime() const { return m_capturedTime; }
+
+	int getNumCollisionObjects() const { return m_numCollisionObjects; }
+	int getNumActiveObjects() const { return m_numActiveObjects; }
+	int getNumOverlappingPairs() const { return m_numOverlappingPairs; }
+	int getNumManifolds() const { return m_numManifolds; }
+	int getNumContactPoints() const { return m_numContactPoints; }
+	int getNumConstraints() const { return m_numConstraints; }
+	///m_numIterations of the solver info, not the iterations run. hbrAdaptiveConstraintSolver counts those.
+	int getConfiguredSolverIterations() const { return m_configuredSolverIterations; }
+};
+
+#endif  // HBR_PROFILER_H
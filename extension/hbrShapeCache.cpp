@@ -0,0 +1,324 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <string.h>
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletCollision/CollisionShapes/btCapsuleShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btConeShape.h"
+#include "BulletCollision/CollisionShapes/btConvexHullShape.h"
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "hbrShapeCache.h"
+
+void hbrShapeKey::addWord(unsigned int word)
+{
+	m_words.push_back(word);
+
+	// FNV-1a, one byte at a time
+	for (int i = 0; i < 4; i++)
+	{
+		m_hash ^= (word >> (i * 8)) & 0xff;
+		m_hash *= 16777619u;
+	}
+}
+
+void hbrShapeKey::addScalar(btScalar value)
+{
+	// fold -0 into +0 so both hash the same
+	float f = float(value) + 0.0f;
+	unsigned int word;
+	memcpy(&word, &f, sizeof(word));
+	addWord(word);
+}
+
+void hbrShapeKey::addVector(const btVector3& v)
+{
+	addScalar(v.getX());
+	addScalar(v.getY());
+	addScalar(v.getZ());
+}
+
+bool hbrShapeKey::equals(const hbrShapeKey& other) const
+{
+	if (m_hash != other.m_hash || m_words.size() != other.m_words.size())
+		return false;
+
+	for (int i = 0; i < m_words.size(); i++)
+	{
+		if (m_words[i] != other.m_words[i])
+			return false;
+	}
+	return true;
+}
+
+hbrShapeCache::hbrShapeCache()
+	: m_hitCount(0),
+	  m_missCount(0)
+{
+}
+
+hbrShapeCache::~hbrShapeCache()
+{
+	for (int i = 0; i < m_entriesByShape.size(); i++)
+	{
+		destroyEntry(*m_entriesByShape.getAtIndex(i));
+	}
+	m_entriesByShape.clear();
+	m_entriesByKey.clear();
+}
+
+btCollisionShape* hbrShapeCache::acquire(const hbrShapeKey& key)
+{
+	Entry** entry = m_entriesByKey.find(key);
+	if (!entry)
+	{
+		m_missCount++;
+		return 0;
+	}
+
+	m_hitCount++;
+	(*entry)->m_refCount++;
+	return (*entry)->m_shape;
+}
+
+btCollisionShape* hbrShapeCache::insert(const hbrShapeKey& key, btCollisionShape* shape, Entry* entry)
+{
+	if (!entry)
+	{
+		entry = new Entry;
+		entry->m_meshInterface = 0;
+	}
+	entry->m_shape = shape;
+	entry->m_key = key;
+	entry->m_refCount = 1;
+
+	m_entriesByKey.insert(key, entry);
+	m_entriesByShape.insert(btHashPtr(shape), entry);
+	return shape;
+}
+
+void hbrShapeCache::destroyEntry(Entry* entry)
+{
+	delete entry->m_shape;
+	delete entry->m_meshInterface;
+	delete entry;
+}
+
+btCollisionShape* hbrShapeCache::getBoxShape(const btVector3& halfExtents)
+{
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_BOX);
+	key.addVector(halfExtents);
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	return insert(key, new btBoxShape(halfExtents));
+}
+
+btCollisionShape* hbrShapeCache::getSphereShape(btScalar radius)
+{
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_SPHERE);
+	key.addScalar(radius);
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	return insert(key, new btSphereShape(radius));
+}
+
+btCollisionShape* hbrShapeCache::getCapsuleShape(btScalar radius, btScalar height, int upAxis)
+{
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_CAPSULE);
+	key.addWord(upAxis);
+	key.addScalar(radius);
+	key.addScalar(height);
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	switch (upAxis)
+	{
+		case 0:
+			shape = new btCapsuleShapeX(radius, height);
+			break;
+		case 2:
+			shape = new btCapsuleShapeZ(radius, height);
+			break;
+		default:
+			shape = new btCapsuleShape(radius, height);
+			break;
+	}
+	return insert(key, shape);
+}
+
+btCollisionShape* hbrShapeCache::getCylinderShape(const btVector3& halfExtents, int upAxis)
+{
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_CYLINDER);
+	key.addWord(upAxis);
+	key.addVector(halfExtents);
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	switch (upAxis)
+	{
+		case 0:
+			shape = new btCylinderShapeX(halfExtents);
+			break;
+		case 2:
+			shape = new btCylinderShapeZ(halfExtents);
+			break;
+		default:
+			shape = new btCylinderShape(halfExtents);
+			break;
+	}
+	return insert(key, shape);
+}
+
+btCollisionShape* hbrShapeCache::getConeShape(btScalar radius, btScalar height, int upAxis)
+{
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_CONE);
+	key.addWord(upAxis);
+	key.addScalar(radius);
+	key.addScalar(height);
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	switch (upAxis)
+	{
+		case 0:
+			shape = new btConeShapeX(radius, height);
+			break;
+		case 2:
+			shape = new btConeShapeZ(radius, height);
+			break;
+		default:
+			shape = new btConeShape(radius, height);
+			break;
+	}
+	return insert(key, shape);
+}
+
+btCollisionShape* hbrShapeCache::getConvexHullShape(const void* points, int numPoints)
+{
+	const float* p = static_cast<const float*>(points);
+
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_CONVEX_HULL);
+	key.addWord(numPoints);
+	for (int i = 0; i < numPoints * 3; i++)
+	{
+		key.addScalar(p[i]);
+	}
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	btConvexHullShape* hull = new btConvexHullShape();
+	for (int i = 0; i < numPoints; i++)
+	{
+		hull->addPoint(btVector3(p[i * 3], p[i * 3 + 1], p[i * 3 + 2]), false);
+	}
+	hull->recalcLocalAabb();
+	return insert(key, hull);
+}
+
+btCollisionShape* hbrShapeCache::getTriangleMeshShape(const void* vertices, int numVertices, const void* indices, int numTriangles)
+{
+	const float* v = static_cast<const float*>(vertices);
+	const int* idx = static_cast<const int*>(indices);
+
+	hbrShapeKey key;
+	key.addWord(HBR_SHAPE_TRIANGLE_MESH);
+	key.addWord(numVertices);
+	key.addWord(numTriangles);
+	for (int i = 0; i < numVertices * 3; i++)
+	{
+		key.addScalar(v[i]);
+	}
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		key.addWord(idx[i]);
+	}
+
+	btCollisionShape* shape = acquire(key);
+	if (shape)
+		return shape;
+
+	// the mesh interface only references its arrays, so the entry keeps its own copy
+	Entry* entry = new Entry;
+	entry->m_vertices.resize(numVertices * 3);
+	for (int i = 0; i < numVertices * 3; i++)
+	{
+		entry->m_vertices[i] = v[i];
+	}
+	entry->m_indices.resize(numTriangles * 3);
+	for (int i = 0; i < numTriangles * 3; i++)
+	{
+		entry->m_indices[i] = idx[i];
+	}
+
+	entry->m_meshInterface = new btTriangleIndexVertexArray(numTriangles,
+															 numTriangles ? &entry->m_indices[0] : 0,
+															 3 * sizeof(int),
+															 numVertices,
+															 numVertices ? &entry->m_vertices[0] : 0,
+															 3 * sizeof(btScalar));
+
+	return insert(key, new btBvhTriangleMeshShape(entry->m_meshInterface, true), entry);
+}
+
+bool hbrShapeCache::retain(btCollisionShape* shape)
+{
+	Entry** entry = m_entriesByShape.find(btHashPtr(shape));
+	if (!entry)
+		return false;
+
+	(*entry)->m_refCount++;
+	return true;
+}
+
+bool hbrShapeCache::release(btCollisionShape* shape)
+{
+	Entry** found = m_entriesByShape.find(btHashPtr(shape));
+	if (!found)
+		return false;
+
+	Entry* entry = *found;
+	if (--entry->m_refCount > 0)
+		return false;
+
+	m_entriesByShape.remove(btHashPtr(shape));
+	m_entriesByKey.remove(entry->m_key);
+	destroyEntry(entry);
+	return true;
+}
+
+int hbrShapeCache::getRefCount(btCollisionShape* shape) const
+{
+	Entry* const* entry = m_entriesByShape.find(btHashPtr(shape));
+	return entry ? (*entry)->m_refCount : 0;
+}
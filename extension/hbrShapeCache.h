@@ -0,0 +1,127 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_SHAPE_CACHE_H
+#define HBR_SHAPE_CACHE_H
+
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class btCollisionShape;
+class btStridingMeshInterface;
+
+///hbrShapeKey identifies a shape by its type and the raw bits of every parameter that went into building it.
+struct hbrShapeKey
+{
+	unsigned int m_hash;
+	btAlignedObjectArray<unsigned int> m_words;
+
+	hbrShapeKey() : m_hash(2166136261u) {}
+	hbrShapeKey(const hbrShapeKey& other) : m_hash(other.m_hash), m_words(other.m_words) {}
+
+	//btAlignedObjectArray hides its assignment operator, but btHashMap needs one for its key array
+	hbrShapeKey& operator=(const hbrShapeKey& other)
+	{
+		m_hash = other.m_hash;
+		m_words.copyFromArray(other.m_words);
+		return *this;
+	}
+
+	void addWord(unsigned int word);
+	void addScalar(btScalar value);
+	void addVector(const btVector3& v);
+
+	unsigned int getHash() const
+	{
+		return m_hash;
+	}
+
+	bool equals(const hbrShapeKey& other) const;
+};
+
+///hbrShapeCache hands out shared, reference counted collision shapes.
+///Two requests with the same shape type and parameters (including hull points or mesh data) return the same btCollisionShape.
+///Every get call takes a reference, release drops one and the shape is deleted together with any mesh data once the last user is gone.
+///Shapes returned by the cache are shared, so they must not be modified (margin, scaling) by a single user.
+class hbrShapeCache
+{
+public:
+	enum ShapeKind
+	{
+		HBR_SHAPE_BOX = 1,
+		HBR_SHAPE_SPHERE,
+		HBR_SHAPE_CAPSULE,
+		HBR_SHAPE_CYLINDER,
+		HBR_SHAPE_CONE,
+		HBR_SHAPE_CONVEX_HULL,
+		HBR_SHAPE_TRIANGLE_MESH
+	};
+
+protected:
+	struct Entry
+	{
+		btCollisionShape* m_shape;
+		btStridingMeshInterface* m_meshInterface;
+		btAlignedObjectArray<btScalar> m_vertices;
+		btAlignedObjectArray<int> m_indices;
+		hbrShapeKey m_key;
+		int m_refCount;
+	};
+
+	btHashMap<hbrShapeKey, Entry*> m_entriesByKey;
+	btHashMap<btHashPtr, Entry*> m_entriesByShape;
+
+	int m_hitCount;
+	int m_missCount;
+
+	btCollisionShape* acquire(const hbrShapeKey& key);
+	btCollisionShape* insert(const hbrShapeKey& key, btCollisionShape* shape, Entry* entry = 0);
+	void destroyEntry(Entry* entry);
+
+public:
+	hbrShapeCache();
+	~hbrShapeCache();
+
+	///upAxis is 0, 1 or 2 (X, Y, Z) for the axis aligned shapes.
+	btCollisionShape* getBoxShape(const btVector3& halfExtents);
+	btCollisionShape* getSphereShape(btScalar radius);
+	btCollisionShape* getCapsuleShape(btScalar radius, btScalar height, int upAxis);
+	btCollisionShape* getCylinderShape(const btVector3& halfExtents, int upAxis);
+	btCollisionShape* getConeShape(btScalar radius, btScalar height, int upAxis);
+
+	///points are numPoints tightly packed x, y, z floats.
+	btCollisionShape* getConvexHullShape(const void* points, int numPoints);
+
+	///vertices are numVertices tightly packed x, y, z floats, indices are 3 * numTriangles ints.
+	///The data is copied, the caller may free its buffers afterwards.
+	btCollisionShape* getTriangleMeshShape(const void* vertices, int numVertices, const void* indices, int numTriangles);
+
+	///Take another reference on a shape that came from this cache. Returns false for foreign shapes.
+	bool retain(btCollisionShape* shape);
+
+	///Drop a reference. Returns true if this was the last reference and the shape was deleted.
+	bool release(btCollisionShape* shape);
+
+	int getRefCount(btCollisionShape* shape) const;
+
+	int getHitCount() const { return m_hitCount; }
+	int getMissCount() const { return m_missCount; }
+	int getLiveShapeCount() const { return m_entriesByShape.size(); }
+	void resetStats()
+	{
+		m_hitCount = 0;
+		m_missCount = 0;
+	}
+};
+
+#endif  // HBR_SHAPE_CACHE_H
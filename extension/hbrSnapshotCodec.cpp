@@ -0,0 +1,517 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <string.h>
+#include "LinearMath/btMotionState.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "hbrKinematicCharacterController.h"
+#include "hbrHandleTable.h"
+#include "hbrSnapshotCodec.h"
+
+// Fields of a state record
+#define HBR_SNAPSHOT_ID 0
+#define HBR_SNAPSHOT_FLAGS 1
+#define HBR_SNAPSHOT_POSITION 2
+#define HBR_SNAPSHOT_ROTATION 5
+#define HBR_SNAPSHOT_LINEAR_VELOCITY 6
+#define HBR_SNAPSHOT_ANGULAR_VELOCITY 9
+
+// Bits of the change mask of an encoded object
+#define HBR_SNAPSHOT_CHANGED_POSITION 1
+#define HBR_SNAPSHOT_CHANGED_ROTATION 2
+#define HBR_SNAPSHOT_CHANGED_LINEAR_VELOCITY 4
+#define HBR_SNAPSHOT_CHANGED_ANGULAR_VELOCITY 8
+#define HBR_SNAPSHOT_CHANGED_FLAGS 16
+#define HBR_SNAPSHOT_REMOVED 32
+
+// Smallest three components are in [-1/sqrt(2), 1/sqrt(2)], mapped to 0..1022 so that 0 is exact
+#define HBR_SNAPSHOT_ROTATION_STEPS 1022
+
+struct hbrSnapshotWriter
+{
+	unsigned char* m_data;
+	int m_size;
+	int m_capacity;
+
+	void writeByte(unsigned int value)
+	{
+		if (m_size < m_capacity)
+			m_data[m_size] = (unsigned char)value;
+		m_size++;
+	}
+
+	void writeVarint(unsigned int value)
+	{
+		while (value >= 0x80)
+		{
+			writeByte((value & 0x7f) | 0x80);
+			value >>= 7;
+		}
+		writeByte(value);
+	}
+
+	// Zigzag encoding keeps small negative deltas small
+	void writeDelta(int value, int base)
+	{
+		int delta = (int)((unsigned int)value - (unsigned int)base);
+		writeVarint(((unsigned int)delta << 1) ^ (unsigned int)(delta >> 31));
+	}
+
+	void writeFixed(unsigned int value)
+	{
+		for (int i = 0; i < 4; i++)
+			writeByte((value >> (i * 8)) & 0xff);
+	}
+};
+
+struct hbrSnapshotReader
+{
+	const unsigned char* m_data;
+	int m_position;
+	int m_size;
+	bool m_error;
+
+	unsigned int readByte()
+	{
+		if (m_position >= m_size)
+		{
+			m_error = true;
+			return 0;
+		}
+		return m_data[m_position++];
+	}
+
+	unsigned int readVarint()
+	{
+		unsigned int value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			unsigned int byte = readByte();
+			value |= (byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		m_error = true;
+		return 0;
+	}
+
+	int readDelta(int base)
+	{
+		unsigned int zigzag = readVarint();
+		unsigned int delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+		return (int)((unsigned int)base + delta);
+	}
+
+	unsigned int readFixed()
+	{
+		unsigned int value = 0;
+		for (int i = 0; i < 4; i++)
+			value |= readByte() << (i * 8);
+		return value;
+	}
+};
+
+static int hbrSnapshotQuantize(btScalar value, btScalar precision)
+{
+	btScalar steps = btScalar(floor(value / precision + btScalar(0.5)));
+	return (int)btClamped(steps, btScalar(-2147483520), btScalar(2147483520));
+}
+
+static int hbrSnapshotPackRotation(const btQuaternion& rotation)
+{
+	btQuaternion q = rotation.normalized();
+	btScalar c[4] = {q.x(), q.y(), q.z(), q.w()};
+	int largest = 0;
+	for (int i = 1; i < 4; i++)
+	{
+		if (btFabs(c[i]) > btFabs(c[largest]))
+			largest = i;
+	}
+	// q and -q are the same rotation, flipping the sign makes the dropped component positive
+	btScalar sign = c[largest] < 0 ? btScalar(-1) : btScalar(1);
+
+	unsigned int packed = largest;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+		btScalar v = c[i] * sign * SIMDSQRT12 * 2;
+		int bits = (int)floor((v + 1) * btScalar(0.5) * HBR_SNAPSHOT_ROTATION_STEPS + btScalar(0.5));
+		packed = (packed << 10) | (unsigned int)btClamped(bits, 0, HBR_SNAPSHOT_ROTATION_STEPS);
+	}
+	return (int)packed;
+}
+
+static btQuaternion hbrSnapshotUnpackRotation(int packedRotation)
+{
+	unsigned int packed = (unsigned int)packedRotation;
+	int largest = packed >> 30;
+	btScalar c[4];
+	btScalar sum = 0;
+	int shift = 20;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+		btScalar v = btScalar((packed >> shift) & 0x3ff) / HBR_SNAPSHOT_ROTATION_STEPS * 2 - 1;
+		c[i] = v * SIMDSQRT12;
+		sum += c[i] * c[i];
+		shift -= 10;
+	}
+	c[largest] = btSqrt(btMax(btScalar(0), 1 - sum));
+	return btQuaternion(c[0], c[1], c[2], c[3]).normalized();
+}
+
+hbrSnapshotCodec::hbrSnapshotCodec(hbrHandleTable* handles, btScalar positionPrecision, btScalar velocityPrecision)
+	: m_handles(handles),
+	  m_positionPrecision(positionPrecision > 0 ? positionPrecision : btScalar(0.001)),
+	  m_velocityPrecision(velocityPrecision > 0 ? velocityPrecision : btScalar(0.01))
+{
+}
+
+void hbrSnapshotCodec::bindId(int id, int handle)
+{
+	m_handlesById.insert(btHashInt(id), handle);
+}
+
+void hbrSnapshotCodec::unbindId(int id)
+{
+	m_handlesById.remove(btHashInt(id));
+}
+
+int hbrSnapshotCodec::getHandle(int id) const
+{
+	const int* handle = m_handlesById.find(btHashInt(id));
+	return handle ? *handle : 0;
+}
+
+void hbrSnapshotCodec::indexBaseline(const int* baseline, int baselineCount)
+{
+	m_baselineIndices.clear();
+	for (int i = 0; i < baselineCount; i++)
+		m_baselineIndices.insert(btHashInt(baseline[i * HBR_SNAPSHOT_RECORD_SIZE + HBR_SNAPSHOT_ID]), i);
+}
+
+int hbrSnapshotCodec::capture(const void* ids, int count, void* state)
+{
+	const int* id = static_cast<const int*>(ids);
+	int* record = static_cast<int*>(state);
+	int written = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		int handle = getHandle(id[i]);
+		btCollisionObject* object = m_handles->getCollisionObject(handle);
+		if (!object)
+			continue;
+
+		btVector3 linearVelocity(0, 0, 0);
+		btVector3 angularVelocity(0, 0, 0);
+		int flags = 0;
+		switch (m_handles->getKind(handle))
+		{
+			case hbrHandleTable::HBR_HANDLE_RIGID_BODY:
+			{
+				btRigidBody* body = static_cast<btRigidBody*>(object);
+				linearVelocity = body->getLinearVelocity();
+				angularVelocity = body->getAngularVelocity();
+				if (body->getActivationState() == ISLAND_SLEEPING)
+					flags |= HBR_SNAPSHOT_SLEEPING;
+				break;
+			}
+			case hbrHandleTable::HBR_HANDLE_CHARACTER:
+			{
+				hbrKinematicCharacterController* character = m_handles->getCharacter(handle);
+				linearVelocity = character->getLinearVelocity();
+				flags |= HBR_SNAPSHOT_CHARACTER;
+				if (character->onGround())
+					flags |= HBR_SNAPSHOT_ON_GROUND;
+				break;
+			}
+			default:
+				break;
+		}
+
+		const btTransform& transform = object->getWorldTransform();
+		record[HBR_SNAPSHOT_ID] = id[i];
+		record[HBR_SNAPSHOT_FLAGS] = flags;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			record[HBR_SNAPSHOT_POSITION + axis] = hbrSnapshotQuantize(transform.getOrigin()[axis], m_positionPrecision);
+			record[HBR_SNAPSHOT_LINEAR_VELOCITY + axis] = hbrSnapshotQuantize(linearVelocity[axis], m_velocityPrecision);
+			record[HBR_SNAPSHOT_ANGULAR_VELOCITY + axis] = hbrSnapshotQuantize(angularVelocity[axis], m_velocityPrecision);
+		}
+		record[HBR_SNAPSHOT_ROTATION] = hbrSnapshotPackRotation(transform.getRotation());
+
+		record += HBR_SNAPSHOT_RECORD_SIZE;
+		written++;
+	}
+	return written;
+}
+
+int hbrSnapshotCodec::encode(const void* state, int count, const void* baseline, int baselineCount, void* out, int capacity)
+{
+	static const int zero[HBR_SNAPSHOT_RECORD_SIZE] = {0};
+	const int* records = static_cast<const int*>(state);
+	const int* baseRecords = static_cast<const int*>(baseline);
+	indexBaseline(baseRecords, baselineCount);
+
+	// First pass: what changed, and which baseline objects are gone
+	btAlignedObjectArray<unsigned char>& masks = m_masks;
+	btAlignedObjectArray<bool>& present = m_present;
+	masks.resize(count);
+	present.resize(0);
+	present.resize(baselineCount, false);
+	int numEntries = 0;
+	for (int i = 0; i < count; i++)
+	{
+		const int* record = records + i * HBR_SNAPSHOT_RECORD_SIZE;
+		const int* index = m_baselineIndices.find(btHashInt(record[HBR_SNAPSHOT_ID]));
+		const int* base = index ? baseRecords + *index * HBR_SNAPSHOT_RECORD_SIZE : zero;
+		unsigned char mask = 0;
+		if (index)
+		{
+			present[*index] = true;
+			// At rest on both sides, anything else would be noise
+			if ((record[HBR_SNAPSHOT_FLAGS] & base[HBR_SNAPSHOT_FLAGS] & HBR_SNAPSHOT_SLEEPING) && record[HBR_SNAPSHOT_FLAGS] == base[HBR_SNAPSHOT_FLAGS])
+			{
+				masks[i] = 0;
+				continue;
+			}
+		}
+		else
+		{
+			// New objects are always sent, even if all their fields are 0
+			mask |= HBR_SNAPSHOT_CHANGED_FLAGS;
+		}
+		if (memcmp(record + HBR_SNAPSHOT_POSITION, base + HBR_SNAPSHOT_POSITION, 3 * sizeof(int)))
+			mask |= HBR_SNAPSHOT_CHANGED_POSITION;
+		if (record[HBR_SNAPSHOT_ROTATION] != base[HBR_SNAPSHOT_ROTATION])
+			mask |= HBR_SNAPSHOT_CHANGED_ROTATION;
+		if (memcmp(record + HBR_SNAPSHOT_LINEAR_VELOCITY, base + HBR_SNAPSHOT_LINEAR_VELOCITY, 3 * sizeof(int)))
+			mask |= HBR_SNAPSHOT_CHANGED_LINEAR_VELOCITY;
+		if (memcmp(record + HBR_SNAPSHOT_ANGULAR_VELOCITY, base + HBR_SNAPSHOT_ANGULAR_VELOCITY, 3 * sizeof(int)))
+			mask |= HBR_SNAPSHOT_CHANGED_ANGULAR_VELOCITY;
+		if (record[HBR_SNAPSHOT_FLAGS] != base[HBR_SNAPSHOT_FLAGS])
+			mask |= HBR_SNAPSHOT_CHANGED_FLAGS;
+		masks[i] = mask;
+		if (mask)
+			numEntries++;
+	}
+	for (int i = 0; i < baselineCount; i++)
+	{
+		if (!present[i])
+			numEntries++;
+	}
+
+	hbrSnapshotWriter writer;
+	writer.m_data = static_cast<unsigned char*>(out);
+	writer.m_size = 0;
+	writer.m_capacity = capacity;
+	writer.writeVarint(numEntries);
+
+	int previousId = 0;
+	for (int i = 0; i < count; i++)
+	{
+		unsigned char mask = masks[i];
+		if (!mask)
+			continue;
+
+		const int* record = records + i * HBR_SNAPSHOT_RECORD_SIZE;
+		const int* index = m_baselineIndices.find(btHashInt(record[HBR_SNAPSHOT_ID]));
+		const int* base = index ? baseRecords + *index * HBR_SNAPSHOT_RECORD_SIZE : zero;
+
+		writer.writeDelta(record[HBR_SNAPSHOT_ID], previousId);
+		previousId = record[HBR_SNAPSHOT_ID];
+		writer.writeByte(mask);
+		if (mask & HBR_SNAPSHOT_CHANGED_POSITION)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				writer.writeDelta(record[HBR_SNAPSHOT_POSITION + axis], base[HBR_SNAPSHOT_POSITION + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_ROTATION)
+			writer.writeFixed(record[HBR_SNAPSHOT_ROTATION]);
+		if (mask & HBR_SNAPSHOT_CHANGED_LINEAR_VELOCITY)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				writer.writeDelta(record[HBR_SNAPSHOT_LINEAR_VELOCITY + axis], base[HBR_SNAPSHOT_LINEAR_VELOCITY + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_ANGULAR_VELOCITY)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				writer.writeDelta(record[HBR_SNAPSHOT_ANGULAR_VELOCITY + axis], base[HBR_SNAPSHOT_ANGULAR_VELOCITY + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_FLAGS)
+			writer.writeVarint(record[HBR_SNAPSHOT_FLAGS]);
+	}
+	for (int i = 0; i < baselineCount; i++)
+	{
+		if (present[i])
+			continue;
+		int id = baseRecords[i * HBR_SNAPSHOT_RECORD_SIZE + HBR_SNAPSHOT_ID];
+		writer.writeDelta(id, previousId);
+		previousId = id;
+		writer.writeByte(HBR_SNAPSHOT_REMOVED);
+	}
+
+	return writer.m_size <= capacity ? writer.m_size : -1;
+}
+
+int hbrSnapshotCodec::decode(const void* in, int size, const void* baseline, int baselineCount, void* out, int capacity, bool apply)
+{
+	if (baselineCount > capacity)
+		return -1;
+
+	int* records = static_cast<int*>(out);
+	indexBaseline(static_cast<const int*>(baseline), baselineCount);
+	// out may be the baseline itself
+	if (baselineCount)
+		memmove(records, baseline, baselineCount * HBR_SNAPSHOT_RECORD_SIZE * sizeof(int));
+	int count = baselineCount;
+
+	hbrSnapshotReader reader;
+	reader.m_data = static_cast<const unsigned char*>(in);
+	reader.m_position = 0;
+	reader.m_size = size;
+	reader.m_error = false;
+
+	int numEntries = (int)reader.readVarint();
+	int previousId = 0;
+	for (int entry = 0; entry < numEntries && !reader.m_error; entry++)
+	{
+		int id = reader.readDelta(previousId);
+		previousId = id;
+		unsigned int mask = reader.readByte();
+
+		int* record;
+		const int* index = m_baselineIndices.find(btHashInt(id));
+		if (index)
+		{
+			record = records + *index * HBR_SNAPSHOT_RECORD_SIZE;
+		}
+		else
+		{
+			if (mask & HBR_SNAPSHOT_REMOVED)
+				continue;
+			if (count == capacity)
+				return -1;
+			record = records + count * HBR_SNAPSHOT_RECORD_SIZE;
+			memset(record, 0, HBR_SNAPSHOT_RECORD_SIZE * sizeof(int));
+			record[HBR_SNAPSHOT_ID] = id;
+			count++;
+		}
+
+		if (mask & HBR_SNAPSHOT_REMOVED)
+		{
+			// Dropped below, once all entries are read
+			record[HBR_SNAPSHOT_FLAGS] = -1;
+			continue;
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_POSITION)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				record[HBR_SNAPSHOT_POSITION + axis] = reader.readDelta(record[HBR_SNAPSHOT_POSITION + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_ROTATION)
+			record[HBR_SNAPSHOT_ROTATION] = (int)reader.readFixed();
+		if (mask & HBR_SNAPSHOT_CHANGED_LINEAR_VELOCITY)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				record[HBR_SNAPSHOT_LINEAR_VELOCITY + axis] = reader.readDelta(record[HBR_SNAPSHOT_LINEAR_VELOCITY + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_ANGULAR_VELOCITY)
+		{
+			for (int axis = 0; axis < 3; axis++)
+				record[HBR_SNAPSHOT_ANGULAR_VELOCITY + axis] = reader.readDelta(record[HBR_SNAPSHOT_ANGULAR_VELOCITY + axis]);
+		}
+		if (mask & HBR_SNAPSHOT_CHANGED_FLAGS)
+			record[HBR_SNAPSHOT_FLAGS] = (int)reader.readVarint();
+
+		if (apply && !reader.m_error)
+			applyRecord(record);
+	}
+	if (reader.m_error)
+		return -1;
+
+	int kept = 0;
+	for (int i = 0; i < count; i++)
+	{
+		const int* record = records + i * HBR_SNAPSHOT_RECORD_SIZE;
+		if (record[HBR_SNAPSHOT_FLAGS] == -1)
+			continue;
+		if (kept != i)
+			memmove(records + kept * HBR_SNAPSHOT_RECORD_SIZE, record, HBR_SNAPSHOT_RECORD_SIZE * sizeof(int));
+		kept++;
+	}
+	return kept;
+}
+
+bool hbrSnapshotCodec::applyRecord(const int* record)
+{
+	int handle = getHandle(record[HBR_SNAPSHOT_ID]);
+	btCollisionObject* object = m_handles->getCollisionObject(handle);
+	if (!object)
+		return false;
+
+	btVector3 position(record[HBR_SNAPSHOT_POSITION] * m_positionPrecision,
+					   record[HBR_SNAPSHOT_POSITION + 1] * m_positionPrecision,
+					   record[HBR_SNAPSHOT_POSITION + 2] * m_positionPrecision);
+	btVector3 linearVelocity(record[HBR_SNAPSHOT_LINEAR_VELOCITY] * m_velocityPrecision,
+							 record[HBR_SNAPSHOT_LINEAR_VELOCITY + 1] * m_velocityPrecision,
+							 record[HBR_SNAPSHOT_LINEAR_VELOCITY + 2] * m_velocityPrecision);
+	btVector3 angularVelocity(record[HBR_SNAPSHOT_ANGULAR_VELOCITY] * m_velocityPrecision,
+							  record[HBR_SNAPSHOT_ANGULAR_VELOCITY + 1] * m_velocityPrecision,
+							  record[HBR_SNAPSHOT_ANGULAR_VELOCITY + 2] * m_velocityPrecision);
+	btTransform transform(hbrSnapshotUnpackRotation(record[HBR_SNAPSHOT_ROTATION]), position);
+
+	switch (m_handles->getKind(handle))
+	{
+		case hbrHandleTable::HBR_HANDLE_RIGID_BODY:
+		{
+			btRigidBody* body = static_cast<btRigidBody*>(object);
+			body->setCenterOfMassTransform(transform);
+			if (body->getMotionState())
+				body->getMotionState()->setWorldTransform(transform);
+			body->setLinearVelocity(linearVelocity);
+			body->setAngularVelocity(angularVelocity);
+			if (record[HBR_SNAPSHOT_FLAGS] & HBR_SNAPSHOT_SLEEPING)
+				body->setActivationState(ISLAND_SLEEPING);
+			else
+				body->activate();
+			break;
+		}
+		case hbrHandleTable::HBR_HANDLE_CHARACTER:
+		{
+			hbrKinematicCharacterController* character = m_handles->getCharacter(handle);
+			character->warp(position);
+			character->setLinearVelocity(linearVelocity);
+			break;
+		}
+		default:
+			object->setWorldTransform(transform);
+			break;
+	}
+	return true;
+}
+
+int hbrSnapshotCodec::apply(const void* state, int count)
+{
+	const int* record = static_cast<const int*>(state);
+	int applied = 0;
+	for (int i = 0; i < count; i++, record += HBR_SNAPSHOT_RECORD_SIZE)
+	{
+		if (applyRecord(record))
+			applied++;
+	}
+	return applied;
+}
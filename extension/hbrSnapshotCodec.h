@@ -0,0 +1,91 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_SNAPSHOT_CODEC_H
+#define HBR_SNAPSHOT_CODEC_H
+
+#include "LinearMath/btScalar.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class hbrHandleTable;
+
+///Ints per record of a snapshot state: id, flags, position (3), rotation, linear velocity (3), angular velocity (3).
+#define HBR_SNAPSHOT_RECORD_SIZE 12
+
+///hbrSnapshotCodec turns the state of networked bodies and characters into compact deltas and back.
+///Objects are known by ids the game picks, bound to the handles of each side's hbrHandleTable with bindId.
+///
+///capture() quantizes the bound objects into a state buffer (HBR_SNAPSHOT_RECORD_SIZE ints per object): positions
+///and velocities to multiples of the precisions given to the constructor, rotations with smallest three encoding
+///(2 bits for the largest component, 10 bits for each of the others). The server keeps the state of every snapshot
+///until the client acknowledges one, and encodes later snapshots against that baseline.
+///
+///encode() writes only the objects that differ from the baseline, which leaves out everything at rest and sleeping.
+///Per object it writes the id, a mask of the changed fields and those fields, as variable length deltas. Objects
+///missing in the baseline are sent in full, objects missing in the state are sent as removed. Changes of the
+///activation state are part of the flags, so clients see bodies fall asleep and wake up.
+///
+///decode() rebuilds the full state from a delta and the same baseline, which then serves as the client's baseline for
+///the next snapshot, and can apply the changed objects on the way: bodies get their transform, velocities and
+///activation state, characters are warped and get their linear velocity.
+class hbrSnapshotCodec
+{
+public:
+	enum Flags
+	{
+		HBR_SNAPSHOT_SLEEPING = 1,
+		HBR_SNAPSHOT_CHARACTER = 2,
+		HBR_SNAPSHOT_ON_GROUND = 4
+	};
+
+protected:
+	hbrHandleTable* m_handles;
+	btScalar m_positionPrecision;
+	btScalar m_velocityPrecision;
+	btHashMap<btHashInt, int> m_handlesById;
+	btHashMap<btHashInt, int> m_baselineIndices;
+	btAlignedObjectArray<unsigned char> m_masks;
+	btAlignedObjectArray<bool> m_present;
+
+	void indexBaseline(const int* baseline, int baselineCount);
+	bool applyRecord(const int* record);
+
+public:
+	hbrSnapshotCodec(hbrHandleTable * handles, btScalar positionPrecision, btScalar velocityPrecision);
+
+	void bindId(int id, int handle);
+	void unbindId(int id);
+	///Handle bound to id, 0 if there is none.
+	int getHandle(int id) const;
+
+	btScalar getPositionPrecision() const { return m_positionPrecision; }
+	btScalar getVelocityPrecision() const { return m_velocityPrecision; }
+
+	///Quantizes the objects bound to count ids into state. Ids that are not bound to a valid handle are skipped.
+	///Returns the number of records written.
+	int capture(const void* ids, int count, void* state);
+
+	///Writes the delta from baseline (baselineCount records, may be 0) to state into out.
+	///Returns the number of bytes written, or -1 if they do not fit into capacity bytes.
+	int encode(const void* state, int count, const void* baseline, int baselineCount, void* out, int capacity);
+
+	///Reads a delta of size bytes written against baseline and writes the resulting state into out.
+	///With apply the changed objects are also written to the bound bodies and characters.
+	///Returns the number of records in out, or -1 if the delta is malformed or more than capacity records result.
+	int decode(const void* in, int size, const void* baseline, int baselineCount, void* out, int capacity, bool apply);
+
+	///Writes count records of state to the bound bodies and characters. Returns the number applied.
+	int apply(const void* state, int count);
+};
+
+#endif  // HBR_SNAPSHOT_CODEC_H
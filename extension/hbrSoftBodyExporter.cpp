@@ -0,0 +1,70 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletSoftBody/btSoftBody.h"
+#include "hbrSoftBodyExporter.h"
+
+static void hbrWriteNodeVector(float* out, int vertex, const btVector3& v)
+{
+	out[vertex * 3 + 0] = v.getX();
+	out[vertex * 3 + 1] = v.getY();
+	out[vertex * 3 + 2] = v.getZ();
+}
+
+void hbrSoftBodyExporter::setRemap(const void* remap, int numVertices)
+{
+	const int* src = static_cast<const int*>(remap);
+
+	m_remap.resize(src ? btMax(numVertices, 0) : 0);
+	for (int i = 0; i < m_remap.size(); i++)
+	{
+		m_remap[i] = src[i];
+	}
+}
+
+int hbrSoftBodyExporter::getNumVertices(const btSoftBody* body) const
+{
+	return hasRemap() ? m_remap.size() : body->m_nodes.size();
+}
+
+int hbrSoftBodyExporter::exportNodes(const btSoftBody* body, void* positions, void* normals) const
+{
+	const btSoftBody::tNodeArray& nodes = body->m_nodes;
+	float* outPositions = static_cast<float*>(positions);
+	float* outNormals = static_cast<float*>(normals);
+
+	if (!hasRemap())
+	{
+		for (int i = 0; i < nodes.size(); i++)
+		{
+			hbrWriteNodeVector(outPositions, i, nodes[i].m_x);
+			if (outNormals)
+			{
+				hbrWriteNodeVector(outNormals, i, nodes[i].m_n);
+			}
+		}
+		return nodes.size();
+	}
+
+	const btVector3 zero(0, 0, 0);
+	for (int i = 0; i < m_remap.size(); i++)
+	{
+		int node = m_remap[i];
+		bool valid = node >= 0 && node < nodes.size();
+		hbrWriteNodeVector(outPositions, i, valid ? nodes[node].m_x : zero);
+		if (outNormals)
+		{
+			hbrWriteNodeVector(outNormals, i, valid ? nodes[node].m_n : zero);
+		}
+	}
+	return m_remap.size();
+}
@@ -0,0 +1,45 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_SOFT_BODY_EXPORTER_H
+#define HBR_SOFT_BODY_EXPORTER_H
+
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btSoftBody;
+
+///hbrSoftBodyExporter copies soft body node positions and normals into caller buffers (3 floats per vertex) in one
+///call, so a render vertex buffer can be refreshed without reading m_nodes through the bindings node by node.
+///By default render vertex i is node i. A remap table makes vertex i take node remap[i] instead, which covers
+///meshes that duplicate nodes along UV seams or order their vertices differently.
+class hbrSoftBodyExporter
+{
+protected:
+	btAlignedObjectArray<int> m_remap;
+
+public:
+	hbrSoftBodyExporter() {}
+
+	///remap holds numVertices ints. The table is copied.
+	void setRemap(const void* remap, int numVertices);
+	void clearRemap() { m_remap.clear(); }
+	bool hasRemap() const { return m_remap.size() > 0; }
+
+	///Number of vertices exportNodes writes for this body.
+	int getNumVertices(const btSoftBody* body) const;
+
+	///Writes node positions and, if normals is not null, node normals. Vertices that remap to a node the body does
+	///not have are written as zero. Returns the number of vertices written.
+	int exportNodes(const btSoftBody* body, void* positions, void* normals) const;
+};
+
+#endif  // HBR_SOFT_BODY_EXPORTER_H
@@ -0,0 +1,377 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btHashMap.h"
+#include "hbrStaticBatch.h"
+
+#define HBR_STATIC_BATCH_BINS 16
+
+// btDbvt frees the nodes of its trees with btAlignedFree, they are allocated the same way
+static btDbvtNode* hbrStaticBatchNode()
+{
+	return new (btAlignedAlloc(sizeof(btDbvtNode), 16)) btDbvtNode();
+}
+
+static btScalar hbrStaticBatchArea(const btDbvtVolume& volume)
+{
+	btVector3 size = volume.Lengths();
+	return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+}
+
+// The stage lists of btDbvtBroadphase, as linked by its own listappend and listremove
+static void hbrStaticBatchListAppend(btDbvtProxy* item, btDbvtProxy*& list)
+{
+	item->links[0] = 0;
+	item->links[1] = list;
+	if (list)
+		list->links[0] = item;
+	list = item;
+}
+
+static void hbrStaticBatchListRemove(btDbvtProxy* item, btDbvtProxy*& list)
+{
+	if (item->links[0])
+		item->links[0]->links[1] = item->links[1];
+	else
+		list = item->links[1];
+	if (item->links[1])
+		item->links[1]->links[0] = item->links[0];
+}
+
+struct hbrStaticBatchCollider : public btDbvt::ICollide
+{
+	btOverlappingPairCache* m_pairCache;
+
+	hbrStaticBatchCollider(btOverlappingPairCache* pairCache) : m_pairCache(pairCache) {}
+
+	void Process(const btDbvtNode* a, const btDbvtNode* b)
+	{
+		m_pairCache->addOverlappingPair(static_cast<btDbvtProxy*>(a->data), static_cast<btDbvtProxy*>(b->data));
+	}
+};
+
+struct hbrStaticBatchPairRemover : public btOverlapCallback
+{
+	btHashMap<btHashPtr, int>& m_objects;
+
+	hbrStaticBatchPairRemover(btHashMap<btHashPtr, int>& objects) : m_objects(objects) {}
+
+	virtual bool processOverlap(btBroadphasePair& pair)
+	{
+		return m_objects.find(btHashPtr(pair.m_pProxy0->m_clientObject)) || m_objects.find(btHashPtr(pair.m_pProxy1->m_clientObject));
+	}
+};
+
+hbrStaticBatch::hbrStaticBatch(btCollisionWorld* world)
+	: m_world(world),
+	  m_numChunks(0)
+{
+}
+
+void hbrStaticBatch::add(btCollisionObject* object, int collisionFilterGroup, int collisionFilterMask)
+{
+	btAssert(object->isStaticObject());
+	m_pending.push_back(object);
+	m_pendingGroups.push_back(collisionFilterGroup);
+	m_pendingMasks.push_back(collisionFilterMask);
+}
+
+btDbvtNode* hbrStaticBatch::buildTree(btDbvtNode** leaves, int count)
+{
+	if (count == 1)
+		return leaves[0];
+
+	btDbvtNode* node = hbrStaticBatchNode();
+	node->volume = leaves[0]->volume;
+	btVector3 centerMin = leaves[0]->volume.Center(), centerMax = centerMin;
+	for (int i = 1; i < count; i++)
+	{
+		Merge(node->volume, leaves[i]->volume, node->volume);
+		centerMin.setMin(leaves[i]->volume.Center());
+		centerMax.setMax(leaves[i]->volume.Center());
+	}
+
+	int split = count / 2;
+	int axis = (centerMax - centerMin).maxAxis();
+	btScalar extent = centerMax[axis] - centerMin[axis];
+	if (extent > 0)
+	{
+		// Bins the centers along the longest axis and splits where count times area of both sides is lowest
+		btScalar scale = HBR_STATIC_BATCH_BINS / extent;
+		int binCounts[HBR_STATIC_BATCH_BINS] = {0};
+		btDbvtVolume binVolumes[HBR_STATIC_BATCH_BINS];
+		for (int i = 0; i < count; i++)
+		{
+			int bin = btMin(int((leaves[i]->volume.Center()[axis] - centerMin[axis]) * scale), HBR_STATIC_BATCH_BINS - 1);
+			if (binCounts[bin]++)
+				Merge(binVolumes[bin], leaves[i]->volume, binVolumes[bin]);
+			else
+				binVolumes[bin] = leaves[i]->volume;
+		}
+
+		btScalar rightCosts[HBR_STATIC_BATCH_BINS];
+		btDbvtVolume volume;
+		int right = 0;
+		for (int bin = HBR_STATIC_BATCH_BINS - 1; bin > 0; bin--)
+		{
+			if (binCounts[bin])
+			{
+				if (right)
+					Merge(volume, binVolumes[bin], volume);
+				else
+					volume = binVolumes[bin];
+				right += binCounts[bin];
+			}
+			rightCosts[bin] = right * (right ? hbrStaticBatchArea(volume) : 0);
+		}
+
+		int bestBin = 0;
+		btScalar bestCost = BT_LARGE_FLOAT;
+		int left = 0;
+		for (int bin = 0; bin < HBR_STATIC_BATCH_BINS - 1; bin++)
+		{
+			if (binCounts[bin])
+			{
+				if (left)
+					Merge(volume, binVolumes[bin], volume);
+				else
+					volume = binVolumes[bin];
+				left += binCounts[bin];
+			}
+			if (!left || left == count)
+				continue;
+			btScalar cost = left * hbrStaticBatchArea(volume) + rightCosts[bin + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestBin = bin;
+			}
+		}
+
+		split = 0;
+		for (int i = 0; i < count; i++)
+		{
+			int bin = btMin(int((leaves[i]->volume.Center()[axis] - centerMin[axis]) * scale), HBR_STATIC_BATCH_BINS - 1);
+			if (bin <= bestBin)
+				btSwap(leaves[i], leaves[split++]);
+		}
+	}
+
+	node->childs[0] = buildTree(leaves, split);
+	node->childs[1] = buildTree(leaves + split, count - split);
+	node->childs[0]->parent = node;
+	node->childs[1]->parent = node;
+	return node;
+}
+
+void hbrStaticBatch::insertTree(btDbvt& tree, btDbvtNode* root)
+{
+	if (!tree.m_root)
+	{
+		tree.m_root = root;
+		root->parent = 0;
+		return;
+	}
+
+	// Goes down to a node about the size of the chunk, so chunks end up as the leaves of a tree of their own instead
+	// of stretching the nodes over single objects
+	btScalar area = hbrStaticBatchArea(root->volume);
+	btDbvtNode* sibling = tree.m_root;
+	while (sibling->isinternal() && hbrStaticBatchArea(sibling->volume) > 2 * area)
+		sibling = sibling->childs[Select(root->volume, sibling->childs[0]->volume, sibling->childs[1]->volume)];
+
+	btDbvtNode* parent = sibling->parent;
+	btDbvtNode* node = hbrStaticBatchNode();
+	node->parent = parent;
+	Merge(sibling->volume, root->volume, node->volume);
+	node->childs[0] = sibling;
+	node->childs[1] = root;
+	sibling->parent = node;
+	root->parent = node;
+	if (!parent)
+	{
+		tree.m_root = node;
+		return;
+	}
+	parent->childs[parent->childs[1] == sibling ? 1 : 0] = node;
+	for (; parent; parent = parent->parent)
+		Merge(parent->childs[0]->volume, parent->childs[1]->volume, parent->volume);
+}
+
+void hbrStaticBatch::commitDbvt(btDbvtBroadphase* broadphase)
+{
+	btCollisionObjectArray& worldObjects = m_world->getCollisionObjectArray();
+	btAlignedObjectArray<btDbvtNode*> leaves;
+	leaves.resize(m_pending.size());
+	for (int i = 0; i < m_pending.size(); i++)
+	{
+		// What btCollisionWorld::addCollisionObject and btDbvtBroadphase::createProxy do, without the tree insert
+		btCollisionObject* object = m_pending[i];
+		btVector3 aabbMin, aabbMax;
+		object->getCollisionShape()->getAabb(object->getWorldTransform(), aabbMin, aabbMax);
+		btDbvtProxy* proxy = new (btAlignedAlloc(sizeof(btDbvtProxy), 16)) btDbvtProxy(aabbMin, aabbMax, object, m_pendingGroups[i], m_pendingMasks[i]);
+		proxy->m_uniqueId = ++broadphase->m_gid;
+		proxy->stage = btDbvtBroadphase::STAGECOUNT;
+		hbrStaticBatchListAppend(proxy, broadphase->m_stageRoots[btDbvtBroadphase::STAGECOUNT]);
+
+		btDbvtNode* leaf = hbrStaticBatchNode();
+		leaf->volume = btDbvtVolume::FromMM(aabbMin, aabbMax);
+		leaf->parent = 0;
+		leaf->data = proxy;
+		leaf->childs[1] = 0;
+		proxy->leaf = leaf;
+		leaves[i] = leaf;
+
+		object->setBroadphaseHandle(proxy);
+#if BT_BULLET_VERSION >= 287
+		object->setWorldArrayIndex(worldObjects.size());
+#endif
+		worldObjects.push_back(object);
+	}
+
+	btDbvtNode* root = buildTree(&leaves[0], leaves.size());
+	btDbvt& fixed = broadphase->m_sets[btDbvtBroadphase::FIXED_SET];
+	insertTree(fixed, root);
+	fixed.m_leaves += leaves.size();
+
+	// Objects resting on the new geometry do not move and would not find it on their own
+	btDbvt& dynamic = broadphase->m_sets[btDbvtBroadphase::DYNAMIC_SET];
+	hbrStaticBatchCollider collider(broadphase->getOverlappingPairCache());
+	dynamic.collideTT(dynamic.m_root, root, collider);
+}
+
+void hbrStaticBatch::removeDbvt(btDbvtBroadphase* broadphase, btAlignedObjectArray<btCollisionObject*>& objects)
+{
+	btHashMap<btHashPtr, int> removed;
+	for (int i = 0; i < objects.size(); i++)
+		removed.insert(btHashPtr(objects[i]), i);
+
+	hbrStaticBatchPairRemover remover(removed);
+	broadphase->getOverlappingPairCache()->processAllOverlappingPairs(&remover, m_world->getDispatcher());
+
+	// What btDbvtBroadphase::destroyProxy does, without searching the pair cache once per proxy
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btDbvtProxy* proxy = static_cast<btDbvtProxy*>(objects[i]->getBroadphaseHandle());
+		// Objects removed from the world since the commit have no proxy left
+		if (!proxy)
+			continue;
+		if (proxy->stage == btDbvtBroadphase::STAGECOUNT)
+			broadphase->m_sets[btDbvtBroadphase::FIXED_SET].remove(proxy->leaf);
+		else
+			broadphase->m_sets[btDbvtBroadphase::DYNAMIC_SET].remove(proxy->leaf);
+		hbrStaticBatchListRemove(proxy, broadphase->m_stageRoots[proxy->stage]);
+		btAlignedFree(proxy);
+		objects[i]->setBroadphaseHandle(0);
+	}
+	broadphase->m_needcleanup = true;
+
+	btCollisionObjectArray& worldObjects = m_world->getCollisionObjectArray();
+	int kept = 0;
+	for (int i = 0; i < worldObjects.size(); i++)
+	{
+		btCollisionObject* object = worldObjects[i];
+		if (removed.find(btHashPtr(object)))
+		{
+#if BT_BULLET_VERSION >= 287
+			object->setWorldArrayIndex(-1);
+#endif
+			continue;
+		}
+#if BT_BULLET_VERSION >= 287
+		object->setWorldArrayIndex(kept);
+#endif
+		worldObjects[kept++] = object;
+	}
+	worldObjects.resize(kept);
+}
+
+int hbrStaticBatch::commit()
+{
+	if (!m_pending.size())
+		return -1;
+
+	btDbvtBroadphase* dbvt = dynamic_cast<btDbvtBroadphase*>(m_world->getBroadphase());
+	if (dbvt)
+	{
+		commitDbvt(dbvt);
+	}
+	else
+	{
+		for (int i = 0; i < m_pending.size(); i++)
+			m_world->addCollisionObject(m_pending[i], m_pendingGroups[i], m_pendingMasks[i]);
+	}
+	// As btDiscreteDynamicsWorld::addRigidBody does for static bodies
+	for (int i = 0; i < m_pending.size(); i++)
+	{
+		if (btRigidBody::upcast(m_pending[i]))
+			m_pending[i]->setActivationState(ISLAND_SLEEPING);
+	}
+
+	int chunk;
+	if (m_freeChunks.size())
+	{
+		chunk = m_freeChunks[m_freeChunks.size() - 1];
+		m_freeChunks.pop_back();
+	}
+	else
+	{
+		chunk = m_chunks.size();
+		m_chunks.expand();
+	}
+	m_chunks[chunk] = m_pending;
+	m_numChunks++;
+
+	m_pending.resize(0);
+	m_pendingGroups.resize(0);
+	m_pendingMasks.resize(0);
+	return chunk;
+}
+
+void hbrStaticBatch::removeChunk(int chunk)
+{
+	if (chunk < 0 || chunk >= m_chunks.size() || !m_chunks[chunk].size())
+		return;
+
+	btAlignedObjectArray<btCollisionObject*>& objects = m_chunks[chunk];
+	btDbvtBroadphase* dbvt = dynamic_cast<btDbvtBroadphase*>(m_world->getBroadphase());
+	if (dbvt)
+	{
+		removeDbvt(dbvt, objects);
+	}
+	else
+	{
+		for (int i = 0; i < objects.size(); i++)
+			m_world->removeCollisionObject(objects[i]);
+	}
+
+	objects.clear();
+	m_freeChunks.push_back(chunk);
+	m_numChunks--;
+}
+
+int hbrStaticBatch::getChunkSize(int chunk) const
+{
+	if (chunk < 0 || chunk >= m_chunks.size())
+		return 0;
+	return m_chunks[chunk].size();
+}
+
+btCollisionObject* hbrStaticBatch::getChunkObject(int chunk, int index) const
+{
+	if (index < 0 || index >= getChunkSize(chunk))
+		return 0;
+	return m_chunks[chunk][index];
+}
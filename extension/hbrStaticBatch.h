@@ -0,0 +1,72 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_STATIC_BATCH_H
+#define HBR_STATIC_BATCH_H
+
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+struct btDbvt;
+struct btDbvtNode;
+struct btDbvtBroadphase;
+
+///hbrStaticBatch adds static collision objects to a world in chunks, e.g. the pieces of a streamed level area, and
+///removes a chunk in one call.
+///On a btDbvtBroadphase a chunk does not go through createProxy one object at a time: commit builds a tree of the
+///chunk top-down (binned SAH) and hangs it into the fixed set of the broadphase whole, then finds its pairs with the
+///moving objects in one tree against tree test. removeChunk drops the pairs of the whole chunk in a single pass over
+///the pair cache and the objects from the world in a single pass over its object array, where removing them one by
+///one costs a pass over both for every object.
+///Static objects are moved back into the dynamic set of the broadphase whenever their AABB is set, keep
+///btCollisionWorld::setForceUpdateAllAabbs(false) so the world does not do that every step.
+///Other broadphases get the objects one by one through the world.
+class hbrStaticBatch
+{
+protected:
+	btCollisionWorld* m_world;
+
+	btAlignedObjectArray<btCollisionObject*> m_pending;
+	btAlignedObjectArray<int> m_pendingGroups;
+	btAlignedObjectArray<int> m_pendingMasks;
+
+	///Objects per chunk id, empty for removed chunks
+	btAlignedObjectArray<btAlignedObjectArray<btCollisionObject*> > m_chunks;
+	btAlignedObjectArray<int> m_freeChunks;
+	int m_numChunks;
+
+	btDbvtNode* buildTree(btDbvtNode * *leaves, int count);
+	void insertTree(btDbvt & tree, btDbvtNode * root);
+	void commitDbvt(btDbvtBroadphase * broadphase);
+	void removeDbvt(btDbvtBroadphase * broadphase, btAlignedObjectArray<btCollisionObject*> & objects);
+
+public:
+	hbrStaticBatch(btCollisionWorld * world);
+
+	///Queues a static object for the next commit. The group and mask default to those btDiscreteDynamicsWorld gives
+	///static rigid bodies.
+	void add(btCollisionObject * object, int collisionFilterGroup = btBroadphaseProxy::StaticFilter, int collisionFilterMask = btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+	int getNumPending() const { return m_pending.size(); }
+
+	///Adds the queued objects to the world as a new chunk and returns its id, -1 when nothing was queued.
+	int commit();
+	///Removes all objects of a chunk from the world. The objects are not destroyed.
+	void removeChunk(int chunk);
+
+	int getNumChunks() const { return m_numChunks; }
+	int getChunkSize(int chunk) const;
+	btCollisionObject* getChunkObject(int chunk, int index) const;
+};
+
+#endif  // HBR_STATIC_BATCH_H
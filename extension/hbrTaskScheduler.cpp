@@ -0,0 +1,73 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btThreads.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "hbrTaskScheduler.h"
+
+// Owned for the lifetime of the module, Bullet keeps a raw pointer to the installed scheduler
+static btITaskScheduler* hbrDefaultTaskScheduler = 0;
+
+static btITaskScheduler* hbrInstallTaskScheduler()
+{
+	if (!hbrDefaultTaskScheduler)
+	{
+		// Null without BT_THREADSAFE, the sequential scheduler Bullet starts with stays in place then
+		hbrDefaultTaskScheduler = btCreateDefaultTaskScheduler();
+		if (!hbrDefaultTaskScheduler)
+		{
+			return btGetTaskScheduler();
+		}
+	}
+	if (btGetTaskScheduler() != hbrDefaultTaskScheduler)
+	{
+		btSetTaskScheduler(hbrDefaultTaskScheduler);
+	}
+	return hbrDefaultTaskScheduler;
+}
+
+hbrTaskScheduler::hbrTaskScheduler()
+{
+}
+
+int hbrTaskScheduler::setNumThreads(int numThreads)
+{
+	btITaskScheduler* scheduler = hbrInstallTaskScheduler();
+	scheduler->setNumThreads(btMax(1, btMin(numThreads, scheduler->getMaxNumThreads())));
+	return scheduler->getNumThreads();
+}
+
+int hbrTaskScheduler::getNumThreads() const
+{
+	return btGetTaskScheduler()->getNumThreads();
+}
+
+int hbrTaskScheduler::getMaxNumThreads()
+{
+	return hbrInstallTaskScheduler()->getMaxNumThreads();
+}
+
+const char* hbrTaskScheduler::getName() const
+{
+	return btGetTaskScheduler()->getName();
+}
+
+bool hbrTaskScheduler::isThreadSafe() const
+{
+#if BT_THREADSAFE
+	return true;
+#else
+	return false;
+#endif
+}
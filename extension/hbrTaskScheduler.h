@@ -0,0 +1,38 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_TASK_SCHEDULER_H
+#define HBR_TASK_SCHEDULER_H
+
+#include "LinearMath/btScalar.h"
+
+///hbrTaskScheduler selects the task scheduler that btDiscreteDynamicsWorldMt, btCollisionDispatcherMt and
+///btConstraintSolverPoolMt run their parallel loops on. It is only part of the threads build (python make.py threads),
+///which compiles Bullet with BT_THREADSAFE and emscripten pthreads. Bullet's default scheduler starts one worker per
+///extra hardware thread when it is first installed, setNumThreads then picks how many of them a step uses.
+class hbrTaskScheduler
+{
+public:
+	hbrTaskScheduler();
+
+	///Installs Bullet's default (pthread pool) scheduler on first use and lets it use numThreads threads, clamped to
+	///[1, getMaxNumThreads()]. Returns the number of threads in use.
+	int setNumThreads(int numThreads);
+	int getNumThreads() const;
+	///Installs the scheduler like setNumThreads, its worker count plus the calling thread.
+	int getMaxNumThreads();
+	const char* getName() const;
+	///False if Bullet was built without BT_THREADSAFE, everything then runs on the calling thread.
+	bool isThreadSafe() const;
+};
+
+#endif  // HBR_TASK_SCHEDULER_H
@@ -0,0 +1,185 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "hbrTriggerVolumes.h"
+
+///contactPairTest only reports points at or below m_closestDistanceThreshold (0), so any point means touching
+struct hbrTriggerContactCallback : public btCollisionWorld::ContactResultCallback
+{
+	bool m_touching;
+
+	hbrTriggerContactCallback()
+		: m_touching(false)
+	{
+	}
+
+	virtual btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1)
+	{
+		m_touching = true;
+		return 0;
+	}
+};
+
+struct hbrOccupantLess
+{
+	template <class T>
+	bool operator()(const T& a, const T& b) const
+	{
+		return a.m_object < b.m_object;
+	}
+};
+
+hbrTriggerVolumes::hbrTriggerVolumes(btCollisionWorld* world)
+	: m_world(world),
+	  m_numTriggers(0)
+{
+}
+
+hbrTriggerVolumes::~hbrTriggerVolumes()
+{
+	for (int i = 0; i < m_triggers.size(); i++)
+	{
+		delete m_triggers[i];
+	}
+}
+
+int hbrTriggerVolumes::addTrigger(btGhostObject* ghost, bool exactShapeTest)
+{
+	if (!ghost)
+		return -1;
+
+	Trigger* trigger = new Trigger;
+	trigger->m_ghost = ghost;
+	trigger->m_exact = exactShapeTest;
+
+	int id;
+	if (m_freeSlots.size())
+	{
+		id = m_freeSlots[m_freeSlots.size() - 1];
+		m_freeSlots.pop_back();
+		m_triggers[id] = trigger;
+	}
+	else
+	{
+		id = m_triggers.size();
+		m_triggers.push_back(trigger);
+	}
+	m_numTriggers++;
+	return id;
+}
+
+bool hbrTriggerVolumes::removeTrigger(int id)
+{
+	if (id < 0 || id >= m_triggers.size() || !m_triggers[id])
+		return false;
+
+	delete m_triggers[id];
+	m_triggers[id] = 0;
+	m_freeSlots.push_back(id);
+	m_numTriggers--;
+	return true;
+}
+
+btGhostObject* hbrTriggerVolumes::getTrigger(int id) const
+{
+	if (id < 0 || id >= m_triggers.size() || !m_triggers[id])
+		return 0;
+	return m_triggers[id]->m_ghost;
+}
+
+int hbrTriggerVolumes::getNumOccupants(int id) const
+{
+	if (id < 0 || id >= m_triggers.size() || !m_triggers[id])
+		return 0;
+	return m_triggers[id]->m_occupants.size();
+}
+
+bool hbrTriggerVolumes::touches(btGhostObject* ghost, btCollisionObject* object)
+{
+	hbrTriggerContactCallback callback;
+	m_world->contactPairTest(ghost, object, callback);
+	return callback.m_touching;
+}
+
+void hbrTriggerVolumes::updateTrigger(int id, Trigger* trigger)
+{
+	btAlignedObjectArray<btCollisionObject*>& overlaps = trigger->m_ghost->getOverlappingPairs();
+
+	if (!trigger->m_exact && overlaps.size() == trigger->m_lastOverlaps.size())
+	{
+		bool changed = false;
+		for (int i = 0; i < overlaps.size() && !changed; i++)
+		{
+			changed = overlaps[i] != trigger->m_lastOverlaps[i];
+		}
+		if (!changed)
+			return;
+	}
+	trigger->m_lastOverlaps.copyFromArray(overlaps);
+
+	m_current.resize(0);
+	for (int i = 0; i < overlaps.size(); i++)
+	{
+		if (trigger->m_exact && !touches(trigger->m_ghost, overlaps[i]))
+			continue;
+
+		Occupant occupant;
+		occupant.m_object = overlaps[i];
+		occupant.m_userIndex = overlaps[i]->getUserIndex();
+		m_current.push_back(occupant);
+	}
+	m_current.quickSort(hbrOccupantLess());
+
+	// Both lists are sorted by object, so a single merge pass finds the enters and exits
+	const btAlignedObjectArray<Occupant>& previous = trigger->m_occupants;
+	int i = 0, j = 0;
+	while (i < m_current.size() || j < previous.size())
+	{
+		if (j == previous.size() || (i < m_current.size() && m_current[i].m_object < previous[j].m_object))
+		{
+			m_enterEvents.push_back(id);
+			m_enterEvents.push_back(m_current[i].m_userIndex);
+			i++;
+		}
+		else if (i == m_current.size() || previous[j].m_object < m_current[i].m_object)
+		{
+			m_exitEvents.push_back(id);
+			m_exitEvents.push_back(previous[j].m_userIndex);
+			j++;
+		}
+		else
+		{
+			// Still inside, keep the user index reported on enter
+			m_current[i].m_userIndex = previous[j].m_userIndex;
+			i++;
+			j++;
+		}
+	}
+	trigger->m_occupants.copyFromArray(m_current);
+}
+
+int hbrTriggerVolumes::update()
+{
+	m_enterEvents.resize(0);
+	m_exitEvents.resize(0);
+
+	for (int i = 0; i < m_triggers.size(); i++)
+	{
+		if (m_triggers[i])
+		{
+			updateTrigger(i, m_triggers[i]);
+		}
+	}
+	return getNumEnterEvents() + getNumExitEvents();
+}
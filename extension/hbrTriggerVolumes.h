@@ -0,0 +1,79 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_TRIGGER_VOLUMES_H
+#define HBR_TRIGGER_VOLUMES_H
+
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+class btGhostObject;
+
+///hbrTriggerVolumes turns ghost objects into trigger zones. After each step, update() diffs the objects overlapping
+///every trigger against the previous step and records enter and exit events as (trigger id, object user index)
+///int pairs, which JS reads straight from the heap through getEnterEvents/getExitEvents.
+///Overlaps come from the ghost's broadphase pair list, so the world needs a btGhostPairCallback. A trigger whose
+///pair list did not change since the last update costs one array compare. Exact triggers additionally run a contact
+///test per overlapping object every update, which filters out objects that only overlap the trigger's AABB.
+class hbrTriggerVolumes
+{
+protected:
+	struct Occupant
+	{
+		const btCollisionObject* m_object;
+		int m_userIndex;
+	};
+
+	struct Trigger
+	{
+		btGhostObject* m_ghost;
+		bool m_exact;
+		btAlignedObjectArray<btCollisionObject*> m_lastOverlaps;
+		///Sorted by object, the user index is kept so exits can be reported for objects that are gone already
+		btAlignedObjectArray<Occupant> m_occupants;
+	};
+
+	btCollisionWorld* m_world;
+	btAlignedObjectArray<Trigger*> m_triggers;
+	btAlignedObjectArray<int> m_freeSlots;
+	btAlignedObjectArray<Occupant> m_current;
+	btAlignedObjectArray<int> m_enterEvents;
+	btAlignedObjectArray<int> m_exitEvents;
+	int m_numTriggers;
+
+	bool touches(btGhostObject * ghost, btCollisionObject * object);
+	void updateTrigger(int id, Trigger * trigger);
+
+public:
+	hbrTriggerVolumes(btCollisionWorld* world);
+	virtual ~hbrTriggerVolumes();
+
+	///Returns the trigger id reported in events. The ghost stays owned by the caller and must be in the world.
+	int addTrigger(btGhostObject* ghost, bool exactShapeTest = false);
+	///Drops the trigger without reporting exits for its occupants.
+	bool removeTrigger(int id);
+	btGhostObject* getTrigger(int id) const;
+	int getNumTriggers() const { return m_numTriggers; }
+	///Number of objects inside the trigger as of the last update.
+	int getNumOccupants(int id) const;
+
+	///Call after each stepSimulation. Clears the previous events and returns the number of new ones.
+	int update();
+
+	int getNumEnterEvents() const { return m_enterEvents.size() / 2; }
+	const void* getEnterEvents() const { return m_enterEvents.size() ? &m_enterEvents[0] : 0; }
+	int getNumExitEvents() const { return m_exitEvents.size() / 2; }
+	const void* getExitEvents() const { return m_exitEvents.size() ? &m_exitEvents[0] : 0; }
+};
+
+#endif  // HBR_TRIGGER_VOLUMES_H
@@ -0,0 +1,239 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "LinearMath/btAabbUtil2.h"
+#include "LinearMath/btMotionState.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "BulletDynamics/Vehicle/btRaycastVehicle.h"
+#include "hbrVehicleFleet.h"
+
+///Collects the objects whose broadphase bounds overlap the suspension rays of one vehicle
+struct hbrVehicleCandidateCallback : public btBroadphaseAabbCallback
+{
+	btAlignedObjectArray<btCollisionObject*>& m_candidates;
+	const btCollisionObject* m_chassis;
+	int m_group;
+	int m_mask;
+
+	hbrVehicleCandidateCallback(btAlignedObjectArray<btCollisionObject*>& candidates, const btCollisionObject* chassis, int group, int mask)
+		: m_candidates(candidates),
+		  m_chassis(chassis),
+		  m_group(group),
+		  m_mask(mask)
+	{
+	}
+
+	virtual bool process(const btBroadphaseProxy* proxy)
+	{
+		btCollisionObject* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+		if (object == m_chassis || !object->hasContactResponse())
+			return true;
+		if (!(proxy->m_collisionFilterGroup & m_mask) || !(m_group & proxy->m_collisionFilterMask))
+			return true;
+
+		m_candidates.push_back(object);
+		return true;
+	}
+};
+
+static void hbrWriteFleetTransform(float* out, const btTransform& transform)
+{
+	const btVector3& origin = transform.getOrigin();
+	btQuaternion rotation = transform.getRotation();
+	out[0] = origin.getX();
+	out[1] = origin.getY();
+	out[2] = origin.getZ();
+	out[3] = rotation.getX();
+	out[4] = rotation.getY();
+	out[5] = rotation.getZ();
+	out[6] = rotation.getW();
+}
+
+void* hbrVehicleFleetRaycaster::castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result)
+{
+	btTransform rayFrom, rayTo;
+	rayFrom.setIdentity();
+	rayFrom.setOrigin(from);
+	rayTo.setIdentity();
+	rayTo.setOrigin(to);
+
+	btCollisionWorld::ClosestRayResultCallback callback(from, to);
+	for (int i = 0; i < m_candidates.size(); i++)
+	{
+		btCollisionObject* object = m_candidates[i];
+		const btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+		btVector3 normal;
+		btScalar param = callback.m_closestHitFraction;
+		if (!btRayAabb(from, to, proxy->m_aabbMin, proxy->m_aabbMax, param, normal))
+			continue;
+
+		btCollisionWorld::rayTestSingle(rayFrom, rayTo, object, object->getCollisionShape(), object->getWorldTransform(), callback);
+	}
+
+	if (!callback.hasHit())
+		return 0;
+
+	result.m_hitPointInWorld = callback.m_hitPointWorld;
+	result.m_hitNormalInWorld = callback.m_hitNormalWorld;
+	result.m_hitNormalInWorld.normalize();
+	result.m_distFraction = callback.m_closestHitFraction;
+	// btRaycastVehicle only checks the returned pointer against 0 and uses its fixed body for the ground
+	return const_cast<btCollisionObject*>(callback.m_collisionObject);
+}
+
+hbrVehicleFleet::hbrVehicleFleet(btCollisionWorld* world)
+	: m_world(world),
+	  m_rayGroup(btBroadphaseProxy::DefaultFilter),
+	  m_rayMask(btBroadphaseProxy::AllFilter)
+{
+}
+
+int hbrVehicleFleet::addVehicle(btRaycastVehicle* vehicle, int driveFlags)
+{
+	if (!vehicle)
+		return -1;
+
+	int index = m_vehicles.findLinearSearch(vehicle);
+	if (index < m_vehicles.size())
+	{
+		m_driveFlags[index] = driveFlags;
+		return index;
+	}
+
+	m_vehicles.push_back(vehicle);
+	m_driveFlags.push_back(driveFlags);
+	return m_vehicles.size() - 1;
+}
+
+bool hbrVehicleFleet::removeVehicle(btRaycastVehicle* vehicle)
+{
+	int index = m_vehicles.findLinearSearch(vehicle);
+	if (index == m_vehicles.size())
+		return false;
+
+	int last = m_vehicles.size() - 1;
+	m_vehicles[index] = m_vehicles[last];
+	m_driveFlags[index] = m_driveFlags[last];
+	m_vehicles.pop_back();
+	m_driveFlags.pop_back();
+	return true;
+}
+
+btRaycastVehicle* hbrVehicleFleet::getVehicle(int index) const
+{
+	if (index < 0 || index >= m_vehicles.size())
+		return 0;
+	return m_vehicles[index];
+}
+
+void hbrVehicleFleet::setControls(const void* controls, int count)
+{
+	const float* data = static_cast<const float*>(controls);
+	count = btMin(count, m_vehicles.size());
+
+	for (int i = 0; i < count; i++, data += 3)
+	{
+		btRaycastVehicle* vehicle = m_vehicles[i];
+		int driveFlags = m_driveFlags[i];
+
+		for (int w = 0; w < vehicle->getNumWheels(); w++)
+		{
+			bool front = vehicle->getWheelInfo(w).m_bIsFrontWheel;
+			bool driven = (driveFlags & (front ? HBR_DRIVE_FRONT : HBR_DRIVE_REAR)) != 0;
+
+			vehicle->applyEngineForce(driven ? data[0] : btScalar(0), w);
+			vehicle->setBrake(data[1], w);
+			if (front)
+			{
+				vehicle->setSteeringValue(data[2], w);
+			}
+		}
+	}
+}
+
+int hbrVehicleFleet::getStateSize() const
+{
+	int size = 0;
+	for (int i = 0; i < m_vehicles.size(); i++)
+	{
+		size += 8 + 8 * m_vehicles[i]->getNumWheels();
+	}
+	return size;
+}
+
+int hbrVehicleFleet::writeState(void* out, bool interpolatedTransform)
+{
+	float* data = static_cast<float*>(out);
+	float* start = data;
+
+	for (int i = 0; i < m_vehicles.size(); i++)
+	{
+		btRaycastVehicle* vehicle = m_vehicles[i];
+		btRigidBody* chassis = vehicle->getRigidBody();
+
+		btTransform chassisTransform = chassis->getCenterOfMassTransform();
+		if (interpolatedTransform && chassis->getMotionState())
+		{
+			chassis->getMotionState()->getWorldTransform(chassisTransform);
+		}
+		hbrWriteFleetTransform(data, chassisTransform);
+		data[7] = vehicle->getCurrentSpeedKmHour();
+		data += 8;
+
+		for (int w = 0; w < vehicle->getNumWheels(); w++, data += 8)
+		{
+			vehicle->updateWheelTransform(w, interpolatedTransform);
+			const btWheelInfo& wheel = vehicle->getWheelInfo(w);
+			hbrWriteFleetTransform(data, wheel.m_worldTransform);
+			data[7] = wheel.m_raycastInfo.m_isInContact ? 1.f : 0.f;
+		}
+	}
+	return int(data - start);
+}
+
+void hbrVehicleFleet::gatherCandidates(btRaycastVehicle* vehicle)
+{
+	m_raycaster.m_candidates.resize(0);
+	if (!vehicle->getNumWheels())
+		return;
+
+	const btTransform& chassisTransform = vehicle->getChassisWorldTransform();
+	btVector3 aabbMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+	btVector3 aabbMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+
+	// Same ray as btRaycastVehicle::rayCast, from the hard point along the suspension by rest length plus radius
+	for (int w = 0; w < vehicle->getNumWheels(); w++)
+	{
+		const btWheelInfo& wheel = vehicle->getWheelInfo(w);
+		btVector3 from = chassisTransform * wheel.m_chassisConnectionPointCS;
+		btVector3 to = from + chassisTransform.getBasis() * wheel.m_wheelDirectionCS * (wheel.getSuspensionRestLength() + wheel.m_wheelsRadius);
+		aabbMin.setMin(from);
+		aabbMin.setMin(to);
+		aabbMax.setMax(from);
+		aabbMax.setMax(to);
+	}
+	btVector3 margin(btScalar(0.01), btScalar(0.01), btScalar(0.01));
+
+	hbrVehicleCandidateCallback callback(m_raycaster.m_candidates, vehicle->getRigidBody(), m_rayGroup, m_rayMask);
+	m_world->getBroadphase()->aabbTest(aabbMin - margin, aabbMax + margin, callback);
+}
+
+void hbrVehicleFleet::updateAction(btCollisionWorld* collisionWorld, btScalar deltaTime)
+{
+	for (int i = 0; i < m_vehicles.size(); i++)
+	{
+		gatherCandidates(m_vehicles[i]);
+		m_vehicles[i]->updateVehicle(deltaTime);
+	}
+	m_raycaster.m_candidates.resize(0);
+}
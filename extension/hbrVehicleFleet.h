@@ -0,0 +1,91 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_VEHICLE_FLEET_H
+#define HBR_VEHICLE_FLEET_H
+
+#include "LinearMath/btAlignedObjectArray.h"
+#include "BulletDynamics/Dynamics/btActionInterface.h"
+#include "BulletDynamics/Vehicle/btVehicleRaycaster.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+class btRaycastVehicle;
+
+///Suspension raycaster shared by all vehicles of a fleet. Rays are only tested against the candidates the fleet
+///gathered for the vehicle being updated, instead of running a full world ray query per wheel.
+class hbrVehicleFleetRaycaster : public btVehicleRaycaster
+{
+public:
+	btAlignedObjectArray<btCollisionObject*> m_candidates;
+
+	virtual void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result);
+};
+
+///hbrVehicleFleet updates many btRaycastVehicles as a single action. Controls for all vehicles come from one buffer
+///and the resulting chassis and wheel state is written to another, so per frame JS does two calls for the whole fleet.
+///Vehicles must be constructed with getRaycaster() and added to the fleet instead of to the world. Each update does
+///one broadphase query over the bounds of a vehicle's suspension rays, then tests every ray against those candidates
+///only. The vehicle's own chassis and objects without contact response are never hit.
+class hbrVehicleFleet : public btActionInterface
+{
+public:
+	enum DriveFlags
+	{
+		HBR_DRIVE_FRONT = 1,
+		HBR_DRIVE_REAR = 2
+	};
+
+protected:
+	btCollisionWorld* m_world;
+	hbrVehicleFleetRaycaster m_raycaster;
+	btAlignedObjectArray<btRaycastVehicle*> m_vehicles;
+	btAlignedObjectArray<int> m_driveFlags;
+	int m_rayGroup;
+	int m_rayMask;
+
+	void gatherCandidates(btRaycastVehicle * vehicle);
+
+public:
+	hbrVehicleFleet(btCollisionWorld* world);
+
+	btVehicleRaycaster* getRaycaster() { return &m_raycaster; }
+
+	///Engine force goes to the wheels selected by driveFlags, steering to the front wheels and brake to all wheels.
+	///Returns the vehicle's index in the control and state buffers.
+	int addVehicle(btRaycastVehicle* vehicle, int driveFlags = HBR_DRIVE_REAR);
+	///The last vehicle takes the index of the removed one.
+	bool removeVehicle(btRaycastVehicle* vehicle);
+	btRaycastVehicle* getVehicle(int index) const;
+	int getNumVehicles() const { return m_vehicles.size(); }
+
+	///Collision filter of the suspension rays, matched against the broadphase group and mask of the candidates.
+	void setRayFilter(int group, int mask)
+	{
+		m_rayGroup = group;
+		m_rayMask = mask;
+	}
+
+	///controls holds engine force, brake and steering (3 floats) for the first count vehicles.
+	void setControls(const void* controls, int count);
+
+	///Number of floats writeState writes: 8 per vehicle and 8 per wheel.
+	int getStateSize() const;
+	///Per vehicle, the chassis transform (px, py, pz, qx, qy, qz, qw) and speed in km/h, then per wheel its transform
+	///and 1 or 0 for ground contact. Returns the number of floats written.
+	int writeState(void* out, bool interpolatedTransform);
+
+	virtual void updateAction(btCollisionWorld * collisionWorld, btScalar deltaTime);
+	virtual void debugDraw(btIDebugDraw * debugDrawer) {}
+};
+
+#endif  // HBR_VEHICLE_FLEET_H
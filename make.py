@@ -11,8 +11,6 @@ from subprocess import Popen, PIPE, STDOUT
 # Definitions
 
 INCLUDES = ['btBulletDynamicsCommon.h',
-            os.path.join('BulletCollision', 'CollisionShapes',
-                         'btHeightfieldTerrainShape.h'),
             os.path.join('BulletCollision', 'CollisionShapes',
                          'btConvexPolyhedron.h'),
             os.path.join('BulletCollision',
@@ -20,20 +18,103 @@ INCLUDES = ['btBulletDynamicsCommon.h',
             os.path.join('BulletCollision', 'CollisionDispatch',
                          'btGhostObject.h'),
 
-            os.path.join('BulletDynamics', 'Character',
-                         'btKinematicCharacterController.h'),
-
-            os.path.join('..', '..', 'extension', 'hbrKinematicCharacterController.cpp'),
-
-            os.path.join('BulletSoftBody', 'btSoftBody.h'),
-            os.path.join('BulletSoftBody', 'btSoftRigidDynamicsWorld.h'), os.path.join(
-                'BulletSoftBody', 'btDefaultSoftBodySolver.h'),
-            os.path.join('BulletSoftBody',
-                         'btSoftBodyRigidBodyCollisionConfiguration.h'),
-            os.path.join('BulletSoftBody', 'btSoftBodyHelpers.h'),
+            os.path.join('..', '..', 'extension', 'hbrShapeCache.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrKinematicBodyBatch.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrArrayView.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrTriggerVolumes.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrCollisionLayers.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrProfiler.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrArena.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrCollisionDispatcher.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrGridBroadphase.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrStaticBatch.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrInstancedShape.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrInstancedCollisionAlgorithm.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrActiveSetDynamicsWorld.cpp'),
+            os.path.join('..', '..', 'extension', 'hbrAdaptiveConstraintSolver.cpp'),
 
             os.path.join('..', '..', 'idl_templates.h')]
 
+# Feature modules on top of the core in ammo.idl. Each one adds its interfaces from idl/, the headers and extension
+# sources compiled into the bindings, and the Bullet libraries it links. python make.py modules=character,vehicle
+# builds the core with just those (and what they require), modules= the core alone. Interfaces that are not bound
+# are not referenced by the glue, so the linker drops their code.
+
+MODULES = {
+    'character': {
+        'requires': [],
+        'includes': [os.path.join('BulletDynamics', 'Character', 'btKinematicCharacterController.h'),
+                     os.path.join('..', '..', 'extension', 'hbrKinematicCharacterController.cpp'),
+                     os.path.join('..', '..', 'extension', 'hbrFloatingOrigin.cpp')],
+        'libs': [],
+    },
+    'handles': {
+        'requires': ['character'],
+        'includes': [os.path.join('..', '..', 'extension', 'hbrHandleTable.cpp'),
+                     os.path.join('..', '..', 'extension', 'hbrAsyncStepper.cpp'),
+                     os.path.join('..', '..', 'extension', 'hbrSnapshotCodec.cpp')],
+        'libs': [],
+    },
+    'heightfield': {
+        'requires': [],
+        'includes': [os.path.join('BulletCollision', 'CollisionShapes', 'btHeightfieldTerrainShape.h'),
+                     os.path.join('..', '..', 'extension', 'hbrHeightfieldTerrain.cpp')],
+        'libs': [],
+    },
+    'vehicle': {
+        'requires': [],
+        'includes': [os.path.join('..', '..', 'extension', 'hbrVehicleFleet.cpp')],
+        'libs': [],
+    },
+    'softbody': {
+        'requires': [],
+        'includes': [os.path.join('BulletSoftBody', 'btSoftBody.h'),
+                     os.path.join('BulletSoftBody', 'btSoftRigidDynamicsWorld.h'),
+                     os.path.join('BulletSoftBody', 'btDefaultSoftBodySolver.h'),
+                     os.path.join('BulletSoftBody', 'btSoftBodyRigidBodyCollisionConfiguration.h'),
+                     os.path.join('BulletSoftBody', 'btSoftBodyHelpers.h'),
+                     os.path.join('..', '..', 'extension', 'hbrSoftBodyExporter.cpp')],
+        'libs': ['BulletSoftBody'],
+    },
+    # Added by python make.py threads, see below
+    'threads': {
+        'requires': [],
+        'includes': [os.path.join('..', '..', 'extension', 'hbrTaskScheduler.cpp')],
+        'libs': [],
+    },
+}
+
+MODULE_ORDER = ['character', 'handles', 'heightfield', 'vehicle', 'softbody', 'threads']
+
+DEFAULT_MODULES = ['character', 'handles', 'heightfield', 'vehicle', 'softbody']
+
+
+def resolve_modules(names):
+    selected = set()
+
+    def add(name):
+        if name not in MODULES:
+            print "ERROR: unknown module '%s', expected one of %s" % (name, ', '.join(MODULE_ORDER))
+            sys.exit(1)
+        if name not in selected:
+            selected.add(name)
+            for required in MODULES[name]['requires']:
+                add(required)
+
+    for name in names:
+        add(name)
+    return [name for name in MODULE_ORDER if name in selected]
+
+# The native build (python make.py native) compiles Bullet and these sources with the host compiler into
+# builds/libammo.so, for running the same simulation on a server. native/ammo.h is its C API.
+
+NATIVE_SOURCES = [os.path.join('native', 'ammo.cpp'),
+                  os.path.join('extension', 'hbrKinematicCharacterController.cpp'),
+                  os.path.join('extension', 'hbrCollisionLayers.cpp')]
+
+# Emscripten contracts no float operations into FMAs, so neither may the native build
+NATIVE_FLAGS = ['-O3', '-fPIC', '-ffp-contract=off', '-DBT_NO_PROFILE=1']
+
 # Startup
 
 stage_counter = 0
@@ -47,7 +128,53 @@ def which(program):
     return None
 
 
+def build_native():
+    this_dir = os.getcwd()
+    build_dir = os.path.join('bullet3', 'build_native')
+    try:
+        if not os.path.exists(build_dir):
+            os.makedirs(build_dir)
+        os.chdir(build_dir)
+
+        if not os.path.exists('CMakeCache.txt'):
+            print 'Configure via CMake'
+            Popen(['cmake', '..',
+                   '-DBUILD_DEMOS=OFF',
+                   '-DBUILD_EXTRAS=OFF',
+                   '-DBUILD_CPU_DEMOS=OFF',
+                   '-DCMAKE_BUILD_TYPE=Release',
+                   '-DBUILD_SHARED_LIBS=OFF',
+                   '-DCMAKE_POSITION_INDEPENDENT_CODE=ON',
+                   '-DBUILD_BULLET3=OFF',
+                   '-DBUILD_BULLET2_DEMOS=OFF',
+                   '-DBUILD_OPENGL3_DEMOS=OFF',
+                   '-DBUILD_ENET=OFF',
+                   '-DBUILD_CLSOCKET=OFF',
+                   '-DBUILD_UNIT_TESTS=OFF',
+                   '-DUSE_GLUT=OFF',
+                   '-DUSE_GRAPHICAL_BENCHMARK=OFF',
+                   '-DBULLET2_MULTITHREADING=OFF',
+                   '-DCMAKE_CXX_FLAGS=' + ' '.join(NATIVE_FLAGS[1:])]).communicate()
+
+        print 'Make'
+        Popen(['make', '-j', str(multiprocessing.cpu_count())]).communicate()
+
+        print 'Link'
+        libs = [os.path.join('src', lib, 'lib%s.a' % lib) for lib in ['BulletDynamics', 'BulletCollision', 'LinearMath']]
+        target = os.path.join(this_dir, 'builds', 'libammo.so')
+        sources = [os.path.join(this_dir, source) for source in NATIVE_SOURCES]
+        Popen(['c++', '-shared', '-fvisibility=hidden', '-I../src', '-I' + os.path.join(this_dir, 'extension')] +
+              NATIVE_FLAGS + sources + libs + ['-o', target, '-lpthread']).communicate()
+        assert os.path.exists(target), 'Failed to create ' + target
+    finally:
+        os.chdir(this_dir)
+
+
 def build():
+    if 'native' in sys.argv:
+        build_native()
+        return
+
     EMSCRIPTEN_ROOT = os.environ.get('EMSCRIPTEN')
     if not EMSCRIPTEN_ROOT:
         emcc = which('emcc')
@@ -73,10 +200,27 @@ def build():
 
     wasm = 'wasm' in sys.argv
     closure = 'closure' in sys.argv
+    profile = 'profile' in sys.argv
+    simd = 'simd' in sys.argv
+    threads = 'threads' in sys.argv
+    if simd or threads:
+        wasm = True
+
+    modules = DEFAULT_MODULES
+    custom_modules = [arg for arg in sys.argv if arg.startswith('modules=')]
+    if custom_modules:
+        modules = [name for name in custom_modules[-1][len('modules='):].split(',') if name]
+    if threads:
+        modules = modules + ['threads']
+    modules = resolve_modules(modules)
 
     args = '-O3 --llvm-lto 1 -s NO_EXIT_RUNTIME=1 -s NO_FILESYSTEM=1 -s EXPORTED_RUNTIME_METHODS=["Pointer_stringify"]'
     if not wasm:
         args += ' -s WASM=0 -s AGGRESSIVE_VARIABLE_ELIMINATION=1 -s ELIMINATE_DUPLICATE_FUNCTIONS=1 -s SINGLE_FILE=1'
+    elif simd:
+        # SIMD128 needs the upstream LLVM wasm backend, which has no BINARYEN_TRAP_MODE. Non-trapping float to int
+        # conversions give the same behaviour as "clamp" there.
+        args += ' -s WASM=1 -msimd128 -mnontrapping-fptoint'
     else:
         args += ''' -s WASM=1 -s BINARYEN_IGNORE_IMPLICIT_TRAPS=1 -s BINARYEN_TRAP_MODE="clamp"'''
     if closure:
@@ -93,11 +237,54 @@ def build():
 
     emcc_args += '-s EXPORT_NAME="Ammo" -s MODULARIZE=1'.split(' ')
 
+    if threads:
+        # Bullet's default task scheduler starts one worker per extra hardware thread and blocks on them, so the
+        # workers have to exist before main() runs: preallocate one per logical core.
+        emcc_args += ['-s', 'USE_PTHREADS=1', '-s',
+                      'PTHREAD_POOL_SIZE=typeof navigator!=="undefined"?navigator.hardwareConcurrency:require("os").cpus().length']
+
     target = 'ammo.js' if not wasm else 'ammo.wasm.js'
+    # Module selections other than the default are named after their modules, e.g. ammo.core-character.wasm.js
+    if custom_modules:
+        target = target.replace('ammo.', 'ammo.%s.' % '-'.join(['core'] + [m for m in modules if m != 'threads']), 1)
+    build_dir = 'build'
+    bullet_flags = []
+
+    # The simd build (ammo.simd.js + ammo.simd.wasm) compiles Bullet's SSE paths, which emscripten's SSE headers map
+    # onto wasm SIMD128: btVector3/btMatrix3x3 math, the solver row kernels and the maxDot/minDot support loops.
+    # BT_ALLOW_SSE4 stays off, its code path includes the MSVC only intrin.h.
+    if simd:
+        target = target.replace('.wasm.js', '.simd.js')
+        build_dir += '_simd'
+        bullet_flags += ['-msimd128', '-msse2', '-include', 'emmintrin.h',
+                         '-DBT_USE_SSE', '-DBT_USE_SSE_IN_API', '-DBT_USE_SIMD_VECTOR3']
+
+    # The threads build (ammo.threads.js + ammo.threads.wasm + ammo.threads.worker.js) compiles Bullet thread safe and
+    # adds the multithreaded world, dispatcher and solver pool. It needs SharedArrayBuffer at runtime.
+    if threads:
+        target = target.replace('.wasm.js', '.js').replace('.js', '.threads.js')
+        build_dir += '_threads'
+        bullet_flags += ['-pthread', '-DBT_THREADSAFE=1']
+
+    idl_files = ['ammo.idl'] + [os.path.join('idl', name + '.idl') for name in modules]
+    includes = INCLUDES[:-1]
+    module_libs = []
+    for name in modules:
+        includes += MODULES[name]['includes']
+        module_libs += MODULES[name]['libs']
+    includes += INCLUDES[-1:]
+
+    # Bullet's BT_PROFILE scopes are only compiled into the profile build, which gets its own build directory
+    if profile:
+        target = target.replace('ammo.', 'ammo.profile.', 1)
+        build_dir += '_profile'
+    else:
+        bullet_flags += ['-DBT_NO_PROFILE=1']
 
     print
     print '--------------------------------------------------'
     print 'Building ammo.js, build type:', emcc_args
+    print 'Modules:', ', '.join(['core'] + modules)
     print '--------------------------------------------------'
     print
 
@@ -134,27 +321,34 @@ def build():
     try:
         this_dir = os.getcwd()
         os.chdir('bullet3')
-        if not os.path.exists('build'):
-            os.makedirs('build')
-        os.chdir('build')
+        if not os.path.exists(build_dir):
+            os.makedirs(build_dir)
+        os.chdir(build_dir)
 
         stage('Generate bindings')
 
+        # The binder takes a single file, extra interface files are appended to ammo.idl
+        idl = os.path.join(this_dir, 'ammo.idl')
+        if len(idl_files) > 1:
+            idl = 'ammo.build.idl'
+            open(idl, 'w').write('\n'.join(open(os.path.join(this_dir, f)).read() for f in idl_files))
+
         Popen([emscripten.PYTHON, os.path.join(EMSCRIPTEN_ROOT, 'tools',
-                                               'webidl_binder.py'), os.path.join(this_dir, 'ammo.idl'), 'glue']).communicate()
+                                               'webidl_binder.py'), idl, 'glue']).communicate()
         assert os.path.exists('glue.js')
         assert os.path.exists('glue.cpp')
 
         stage('Build bindings')
 
-        args = ['-I../src', '-c']
-        for include in INCLUDES:
+        args = ['-I../src', '-c'] + bullet_flags
+        for include in includes:
             args += ['-include', include]
         emscripten.Building.emcc('glue.cpp', args, 'glue.bc')
         assert(os.path.exists('glue.bc'))
 
         # Configure with CMake on Windows, and with configure on Unix.
-        cmake_build = emscripten.WINDOWS
+        # The threads build always uses CMake, configure does not build Bullet's task scheduler.
+        cmake_build = emscripten.WINDOWS or threads
 
         if cmake_build:
             if not os.path.exists('CMakeCache.txt'):
@@ -173,12 +367,15 @@ def build():
                                                '-DUSE_GLUT=OFF',
 
                                                '-DUSE_GRAPHICAL_BENCHMARK=OFF',
-                                               '-USE_MSVC_SSE2=OFF',])
+                                               '-USE_MSVC_SSE2=OFF',
+                                               '-DBULLET2_MULTITHREADING=' + ('ON' if threads else 'OFF'),
+                                               '-DCMAKE_CXX_FLAGS=' + ' '.join(bullet_flags)])
         else:
             if not os.path.exists('config.h'):
                 stage('Configure (if this fails, run autogen.sh in bullet/ first)')
                 emscripten.Building.configure(
-                    ['../configure', '--disable-demos', '--disable-dependency-tracking'])
+                    ['../configure', '--disable-demos', '--disable-dependency-tracking',
+                     'CPPFLAGS=' + ' '.join(bullet_flags)])
 
         stage('Make')
 
@@ -191,19 +388,12 @@ def build():
 
         stage('Link')
 
+        # Module libraries depend on the core ones, so they go first
+        libs = module_libs + ['BulletDynamics', 'BulletCollision', 'LinearMath']
         if cmake_build:
-            bullet_libs = [os.path.join('src', 'BulletSoftBody', 'libBulletSoftBody.a'),
-                           os.path.join('src', 'BulletDynamics',
-                                        'libBulletDynamics.a'),
-                           os.path.join('src', 'BulletCollision',
-                                        'libBulletCollision.a'),
-                           os.path.join('src', 'LinearMath', 'libLinearMath.a')]
+            bullet_libs = [os.path.join('src', lib, 'lib%s.a' % lib) for lib in libs]
         else:
-            bullet_libs = [os.path.join('src', '.libs', 'libBulletSoftBody.a'),
-                           os.path.join('src', '.libs', 'libBulletDynamics.a'),
-                           os.path.join('src', '.libs',
-                                        'libBulletCollision.a'),
-                           os.path.join('src', '.libs', 'libLinearMath.a')]
+            bullet_libs = [os.path.join('src', '.libs', 'lib%s.a' % lib) for lib in libs]
 
         emscripten.Building.link(['glue.bc'] + bullet_libs, 'libbullet.bc')
         assert os.path.exists('libbullet.bc')
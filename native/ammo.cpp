@@ -0,0 +1,575 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+// Built by python make.py native together with the extension sources it uses, see NATIVE_SOURCES there.
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "../extension/hbrKinematicCharacterController.h"
+#include "ammo.h"
+
+struct ammo_world
+{
+	btDefaultCollisionConfiguration* m_collisionConfiguration;
+	btCollisionDispatcher* m_dispatcher;
+	btDbvtBroadphase* m_broadphase;
+	btSequentialImpulseConstraintSolver* m_solver;
+	btDiscreteDynamicsWorld* m_world;
+	btGhostPairCallback* m_ghostPairCallback;
+};
+
+struct ammo_character
+{
+	btPairCachingGhostObject* m_ghost;
+	hbrKinematicCharacterController* m_controller;
+};
+
+static btTransform hbrNativeReadTransform(const float* in)
+{
+	return btTransform(btQuaternion(in[3], in[4], in[5], in[6]), btVector3(in[0], in[1], in[2]));
+}
+
+static void hbrNativeWriteTransform(const btTransform& transform, float* out)
+{
+	const btVector3& origin = transform.getOrigin();
+	btQuaternion rotation = transform.getRotation();
+	out[0] = origin.getX();
+	out[1] = origin.getY();
+	out[2] = origin.getZ();
+	out[3] = rotation.getX();
+	out[4] = rotation.getY();
+	out[5] = rotation.getZ();
+	out[6] = rotation.getW();
+}
+
+static void hbrNativeWriteVector(const btVector3& v, float* out)
+{
+	out[0] = v.getX();
+	out[1] = v.getY();
+	out[2] = v.getZ();
+}
+
+static btRigidBody* hbrNativeBody(ammo_body* body)
+{
+	return reinterpret_cast<btRigidBody*>(body);
+}
+
+static const btRigidBody* hbrNativeBody(const ammo_body* body)
+{
+	return reinterpret_cast<const btRigidBody*>(body);
+}
+
+static btCollisionShape* hbrNativeShape(ammo_shape* shape)
+{
+	return reinterpret_cast<btCollisionShape*>(shape);
+}
+
+struct hbrNativeContactCounter : public btCollisionWorld::ContactResultCallback
+{
+	int m_count;
+
+	hbrNativeContactCounter() : m_count(0)
+	{
+	}
+
+	virtual btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1)
+	{
+		m_count++;
+		return 0;
+	}
+};
+
+/* Worlds */
+
+ammo_world* ammo_world_create(float gravityX, float gravityY, float gravityZ)
+{
+	ammo_world* world = new ammo_world;
+	world->m_collisionConfiguration = new btDefaultCollisionConfiguration();
+	world->m_dispatcher = new btCollisionDispatcher(world->m_collisionConfiguration);
+	world->m_broadphase = new btDbvtBroadphase();
+	world->m_solver = new btSequentialImpulseConstraintSolver();
+	world->m_world = new btDiscreteDynamicsWorld(world->m_dispatcher, world->m_broadphase, world->m_solver, world->m_collisionConfiguration);
+	world->m_ghostPairCallback = new btGhostPairCallback();
+	world->m_broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(world->m_ghostPairCallback);
+	world->m_world->setGravity(btVector3(gravityX, gravityY, gravityZ));
+	return world;
+}
+
+void ammo_world_destroy(ammo_world* world)
+{
+	// Objects still in the world belong to the caller, only detach them
+	btCollisionObjectArray& objects = world->m_world->getCollisionObjectArray();
+	while (objects.size())
+	{
+		world->m_world->removeCollisionObject(objects[objects.size() - 1]);
+	}
+	while (world->m_world->getNumConstraints())
+	{
+		world->m_world->removeConstraint(world->m_world->getConstraint(0));
+	}
+	delete world->m_world;
+	delete world->m_solver;
+	delete world->m_broadphase;
+	delete world->m_ghostPairCallback;
+	delete world->m_dispatcher;
+	delete world->m_collisionConfiguration;
+	delete world;
+}
+
+void ammo_world_set_gravity(ammo_world* world, float x, float y, float z)
+{
+	world->m_world->setGravity(btVector3(x, y, z));
+}
+
+int ammo_world_step(ammo_world* world, float timeStep, int maxSubSteps, float fixedTimeStep)
+{
+	return world->m_world->stepSimulation(timeStep, maxSubSteps, fixedTimeStep);
+}
+
+int ammo_world_get_num_collision_objects(const ammo_world* world)
+{
+	return world->m_world->getNumCollisionObjects();
+}
+
+void ammo_world_set_solver_iterations(ammo_world* world, int iterations)
+{
+	world->m_world->getSolverInfo().m_numIterations = iterations;
+}
+
+void ammo_world_add_body(ammo_world* world, ammo_body* body, int group, int mask)
+{
+	world->m_world->addRigidBody(hbrNativeBody(body), group, mask);
+}
+
+void ammo_world_remove_body(ammo_world* world, ammo_body* body)
+{
+	world->m_world->removeRigidBody(hbrNativeBody(body));
+}
+
+void ammo_world_add_character(ammo_world* world, ammo_character* character, int group, int mask)
+{
+	world->m_world->addCollisionObject(character->m_ghost, group, mask);
+	world->m_world->addAction(character->m_controller);
+}
+
+void ammo_world_remove_character(ammo_world* world, ammo_character* character)
+{
+	world->m_world->removeAction(character->m_controller);
+	world->m_world->removeCollisionObject(character->m_ghost);
+}
+
+/* Queries */
+
+ammo_object* ammo_world_ray_test_closest(ammo_world* world, const float* from, const float* to, int group, int mask, float* hit)
+{
+	btVector3 rayFrom(from[0], from[1], from[2]);
+	btVector3 rayTo(to[0], to[1], to[2]);
+	btCollisionWorld::ClosestRayResultCallback callback(rayFrom, rayTo);
+	callback.m_collisionFilterGroup = group;
+	callback.m_collisionFilterMask = mask;
+	world->m_world->rayTest(rayFrom, rayTo, callback);
+	if (!callback.hasHit())
+	{
+		return 0;
+	}
+	hbrNativeWriteVector(callback.m_hitPointWorld, hit);
+	hbrNativeWriteVector(callback.m_hitNormalWorld, hit + 3);
+	hit[6] = callback.m_closestHitFraction;
+	return reinterpret_cast<ammo_object*>(const_cast<btCollisionObject*>(callback.m_collisionObject));
+}
+
+ammo_object* ammo_world_convex_sweep_closest(ammo_world* world, const ammo_shape* shape, const float* from, const float* to, int group, int mask, float* hit)
+{
+	const btCollisionShape* castShape = reinterpret_cast<const btCollisionShape*>(shape);
+	if (!castShape->isConvex())
+	{
+		return 0;
+	}
+	btTransform sweepFrom = hbrNativeReadTransform(from);
+	btTransform sweepTo = hbrNativeReadTransform(to);
+	btCollisionWorld::ClosestConvexResultCallback callback(sweepFrom.getOrigin(), sweepTo.getOrigin());
+	callback.m_collisionFilterGroup = group;
+	callback.m_collisionFilterMask = mask;
+	world->m_world->convexSweepTest(static_cast<const btConvexShape*>(castShape), sweepFrom, sweepTo, callback);
+	if (!callback.hasHit())
+	{
+		return 0;
+	}
+	hbrNativeWriteVector(callback.m_hitPointWorld, hit);
+	hbrNativeWriteVector(callback.m_hitNormalWorld, hit + 3);
+	hit[6] = callback.m_closestHitFraction;
+	return reinterpret_cast<ammo_object*>(const_cast<btCollisionObject*>(callback.m_hitCollisionObject));
+}
+
+int ammo_world_contact_test(ammo_world* world, ammo_object* object, int group, int mask)
+{
+	hbrNativeContactCounter callback;
+	callback.m_collisionFilterGroup = group;
+	callback.m_collisionFilterMask = mask;
+	world->m_world->contactTest(reinterpret_cast<btCollisionObject*>(object), callback);
+	return callback.m_count;
+}
+
+int ammo_object_get_user_index(const ammo_object* object)
+{
+	return reinterpret_cast<const btCollisionObject*>(object)->getUserIndex();
+}
+
+void ammo_object_set_user_index(ammo_object* object, int index)
+{
+	reinterpret_cast<btCollisionObject*>(object)->setUserIndex(index);
+}
+
+ammo_body* ammo_object_as_body(ammo_object* object)
+{
+	return reinterpret_cast<ammo_body*>(btRigidBody::upcast(reinterpret_cast<btCollisionObject*>(object)));
+}
+
+ammo_object* ammo_body_as_object(ammo_body* body)
+{
+	return reinterpret_cast<ammo_object*>(static_cast<btCollisionObject*>(hbrNativeBody(body)));
+}
+
+ammo_object* ammo_character_as_object(ammo_character* character)
+{
+	return reinterpret_cast<ammo_object*>(static_cast<btCollisionObject*>(character->m_ghost));
+}
+
+/* Shapes */
+
+ammo_shape* ammo_shape_create_box(float halfX, float halfY, float halfZ)
+{
+	return reinterpret_cast<ammo_shape*>(new btBoxShape(btVector3(halfX, halfY, halfZ)));
+}
+
+ammo_shape* ammo_shape_create_sphere(float radius)
+{
+	return reinterpret_cast<ammo_shape*>(new btSphereShape(radius));
+}
+
+ammo_shape* ammo_shape_create_capsule(float radius, float height)
+{
+	return reinterpret_cast<ammo_shape*>(new btCapsuleShape(radius, height));
+}
+
+ammo_shape* ammo_shape_create_cylinder(float halfX, float halfY, float halfZ)
+{
+	return reinterpret_cast<ammo_shape*>(new btCylinderShape(btVector3(halfX, halfY, halfZ)));
+}
+
+ammo_shape* ammo_shape_create_cone(float radius, float height)
+{
+	return reinterpret_cast<ammo_shape*>(new btConeShape(radius, height));
+}
+
+ammo_shape* ammo_shape_create_convex_hull(const float* points, int numPoints)
+{
+	btConvexHullShape* hull = new btConvexHullShape();
+	for (int i = 0; i < numPoints; i++)
+	{
+		hull->addPoint(btVector3(points[i * 3], points[i * 3 + 1], points[i * 3 + 2]), false);
+	}
+	hull->recalcLocalAabb();
+	return reinterpret_cast<ammo_shape*>(hull);
+}
+
+ammo_shape* ammo_shape_create_triangle_mesh(const float* vertices, int numVertices, const int* indices, int numTriangles)
+{
+	btTriangleMesh* mesh = new btTriangleMesh(true, false);
+	for (int i = 0; i < numVertices; i++)
+	{
+		mesh->findOrAddVertex(btVector3(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]), false);
+	}
+	for (int i = 0; i < numTriangles; i++)
+	{
+		mesh->addTriangleIndices(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+	}
+	return reinterpret_cast<ammo_shape*>(new btBvhTriangleMeshShape(mesh, true, true));
+}
+
+ammo_shape* ammo_shape_create_compound(void)
+{
+	return reinterpret_cast<ammo_shape*>(new btCompoundShape(true));
+}
+
+void ammo_compound_add_child(ammo_shape* compound, const float* transform, ammo_shape* child)
+{
+	btCollisionShape* shape = hbrNativeShape(compound);
+	if (shape->isCompound())
+	{
+		static_cast<btCompoundShape*>(shape)->addChildShape(hbrNativeReadTransform(transform), hbrNativeShape(child));
+	}
+}
+
+void ammo_shape_set_margin(ammo_shape* shape, float margin)
+{
+	hbrNativeShape(shape)->setMargin(margin);
+}
+
+void ammo_shape_set_local_scaling(ammo_shape* shape, float x, float y, float z)
+{
+	hbrNativeShape(shape)->setLocalScaling(btVector3(x, y, z));
+}
+
+void ammo_shape_destroy(ammo_shape* shape)
+{
+	btCollisionShape* collisionShape = hbrNativeShape(shape);
+	if (collisionShape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE)
+	{
+		// The mesh was created along with the shape
+		delete static_cast<btBvhTriangleMeshShape*>(collisionShape)->getMeshInterface();
+	}
+	delete collisionShape;
+}
+
+/* Rigid bodies */
+
+ammo_body* ammo_body_create(ammo_shape* shape, float mass, const float* transform)
+{
+	btCollisionShape* collisionShape = hbrNativeShape(shape);
+	btVector3 localInertia(0, 0, 0);
+	if (mass != 0.f)
+	{
+		collisionShape->calculateLocalInertia(mass, localInertia);
+	}
+	btDefaultMotionState* motionState = new btDefaultMotionState(hbrNativeReadTransform(transform));
+	btRigidBody::btRigidBodyConstructionInfo info(mass, motionState, collisionShape, localInertia);
+	return reinterpret_cast<ammo_body*>(new btRigidBody(info));
+}
+
+void ammo_body_destroy(ammo_body* body)
+{
+	btRigidBody* rigidBody = hbrNativeBody(body);
+	delete rigidBody->getMotionState();
+	delete rigidBody;
+}
+
+void ammo_body_get_transform(const ammo_body* body, float* out)
+{
+	hbrNativeWriteTransform(hbrNativeBody(body)->getWorldTransform(), out);
+}
+
+void ammo_body_get_interpolated_transform(const ammo_body* body, float* out)
+{
+	btTransform transform;
+	hbrNativeBody(body)->getMotionState()->getWorldTransform(transform);
+	hbrNativeWriteTransform(transform, out);
+}
+
+void ammo_body_set_transform(ammo_body* body, const float* transform)
+{
+	btRigidBody* rigidBody = hbrNativeBody(body);
+	btTransform worldTransform = hbrNativeReadTransform(transform);
+	rigidBody->setWorldTransform(worldTransform);
+	rigidBody->setInterpolationWorldTransform(worldTransform);
+	rigidBody->getMotionState()->setWorldTransform(worldTransform);
+	rigidBody->activate();
+}
+
+void ammo_body_get_linear_velocity(const ammo_body* body, float* out)
+{
+	hbrNativeWriteVector(hbrNativeBody(body)->getLinearVelocity(), out);
+}
+
+void ammo_body_set_linear_velocity(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->setLinearVelocity(btVector3(x, y, z));
+}
+
+void ammo_body_get_angular_velocity(const ammo_body* body, float* out)
+{
+	hbrNativeWriteVector(hbrNativeBody(body)->getAngularVelocity(), out);
+}
+
+void ammo_body_set_angular_velocity(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->setAngularVelocity(btVector3(x, y, z));
+}
+
+void ammo_body_apply_central_impulse(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->applyCentralImpulse(btVector3(x, y, z));
+}
+
+void ammo_body_apply_central_force(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->applyCentralForce(btVector3(x, y, z));
+}
+
+void ammo_body_apply_torque(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->applyTorque(btVector3(x, y, z));
+}
+
+void ammo_body_set_linear_factor(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->setLinearFactor(btVector3(x, y, z));
+}
+
+void ammo_body_set_angular_factor(ammo_body* body, float x, float y, float z)
+{
+	hbrNativeBody(body)->setAngularFactor(btVector3(x, y, z));
+}
+
+void ammo_body_set_friction(ammo_body* body, float friction)
+{
+	hbrNativeBody(body)->setFriction(friction);
+}
+
+void ammo_body_set_restitution(ammo_body* body, float restitution)
+{
+	hbrNativeBody(body)->setRestitution(restitution);
+}
+
+void ammo_body_set_damping(ammo_body* body, float linear, float angular)
+{
+	hbrNativeBody(body)->setDamping(linear, angular);
+}
+
+void ammo_body_set_ccd(ammo_body* body, float motionThreshold, float sweptSphereRadius)
+{
+	hbrNativeBody(body)->setCcdMotionThreshold(motionThreshold);
+	hbrNativeBody(body)->setCcdSweptSphereRadius(sweptSphereRadius);
+}
+
+int ammo_body_get_collision_flags(const ammo_body* body)
+{
+	return hbrNativeBody(body)->getCollisionFlags();
+}
+
+void ammo_body_set_collision_flags(ammo_body* body, int flags)
+{
+	hbrNativeBody(body)->setCollisionFlags(flags);
+}
+
+int ammo_body_get_activation_state(const ammo_body* body)
+{
+	return hbrNativeBody(body)->getActivationState();
+}
+
+void ammo_body_set_activation_state(ammo_body* body, int state)
+{
+	hbrNativeBody(body)->forceActivationState(state);
+}
+
+void ammo_body_activate(ammo_body* body)
+{
+	hbrNativeBody(body)->activate();
+}
+
+/* Character controllers */
+
+ammo_character* ammo_character_create(ammo_shape* shape, float stepHeight, const float* position, const float* up)
+{
+	btCollisionShape* collisionShape = hbrNativeShape(shape);
+	if (!collisionShape->isConvex())
+	{
+		return 0;
+	}
+	ammo_character* character = new ammo_character;
+	character->m_ghost = new btPairCachingGhostObject();
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(btVector3(position[0], position[1], position[2]));
+	character->m_ghost->setWorldTransform(transform);
+	character->m_ghost->setCollisionShape(collisionShape);
+	character->m_ghost->setCollisionFlags(btCollisionObject::CF_CHARACTER_OBJECT);
+	character->m_controller = new hbrKinematicCharacterController(character->m_ghost, static_cast<btConvexShape*>(collisionShape), stepHeight, btVector3(up[0], up[1], up[2]));
+	return character;
+}
+
+void ammo_character_destroy(ammo_character* character)
+{
+	delete character->m_controller;
+	delete character->m_ghost;
+	delete character;
+}
+
+void ammo_character_get_transform(const ammo_character* character, float* out)
+{
+	hbrNativeWriteTransform(character->m_ghost->getWorldTransform(), out);
+}
+
+void ammo_character_warp(ammo_character* character, float x, float y, float z)
+{
+	character->m_controller->warp(btVector3(x, y, z));
+}
+
+void ammo_character_set_walk_direction(ammo_character* character, float x, float y, float z)
+{
+	character->m_controller->setWalkDirection(btVector3(x, y, z));
+}
+
+void ammo_character_get_linear_velocity(const ammo_character* character, float* out)
+{
+	hbrNativeWriteVector(character->m_controller->getLinearVelocity(), out);
+}
+
+void ammo_character_set_linear_velocity(ammo_character* character, float x, float y, float z)
+{
+	character->m_controller->setLinearVelocity(btVector3(x, y, z));
+}
+
+void ammo_character_jump(ammo_character* character)
+{
+	character->m_controller->jump();
+}
+
+int ammo_character_can_jump(const ammo_character* character)
+{
+	return character->m_controller->canJump() ? 1 : 0;
+}
+
+int ammo_character_on_ground(const ammo_character* character)
+{
+	return character->m_controller->onGround() ? 1 : 0;
+}
+
+void ammo_character_set_jump_speed(ammo_character* character, float speed)
+{
+	character->m_controller->setJumpSpeed(speed);
+}
+
+void ammo_character_set_fall_speed(ammo_character* character, float speed)
+{
+	character->m_controller->setFallSpeed(speed);
+}
+
+void ammo_character_set_max_jump_height(ammo_character* character, float height)
+{
+	character->m_controller->setMaxJumpHeight(height);
+}
+
+void ammo_character_set_max_slope(ammo_character* character, float radians)
+{
+	character->m_controller->setMaxSlope(radians);
+}
+
+void ammo_character_set_gravity(ammo_character* character, float x, float y, float z)
+{
+	character->m_controller->setGravity(btVector3(x, y, z));
+}
+
+void ammo_character_set_max_walk_speed(ammo_character* character, float speed)
+{
+	character->m_controller->setMaxWalkSpeed(speed);
+}
+
+void ammo_character_set_walk_acceleration(ammo_character* character, float acceleration)
+{
+	character->m_controller->setWalkAcceleration(acceleration);
+}
+
+void ammo_character_set_friction(ammo_character* character, float friction)
+{
+	character->m_controller->setFriction(friction);
+}
@@ -0,0 +1,150 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HBR_AMMO_C_API_H
+#define HBR_AMMO_C_API_H
+
+///Flat C API of the native build (python make.py native, builds/libammo.so). It covers the parts of ammo.idl a server
+///needs: worlds, shapes, rigid bodies, queries and hbrKinematicCharacterController, compiled from the same Bullet
+///sources and extension code as the wasm build.
+///Vectors are passed as x, y, z floats, transforms as 7 floats: px, py, pz, qx, qy, qz, qw. Filter groups and masks
+///are the same as in the JS API, pass -1 as mask to collide with everything.
+///Objects are owned by the caller: remove them from their world before destroying them, and destroy shapes after the
+///bodies and characters that use them.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(__GNUC__)
+#define AMMO_API __attribute__((visibility("default")))
+#else
+#define AMMO_API
+#endif
+
+	typedef struct ammo_world ammo_world;
+	typedef struct ammo_shape ammo_shape;
+	typedef struct ammo_body ammo_body;
+	typedef struct ammo_character ammo_character;
+	///Any collision object: a rigid body or the ghost object of a character
+	typedef struct ammo_object ammo_object;
+
+	/* Worlds */
+
+	///A btDiscreteDynamicsWorld with the default collision configuration, a btDbvtBroadphase and the sequential
+	///impulse solver, set up for ghost objects, as in the JS examples.
+	AMMO_API ammo_world* ammo_world_create(float gravityX, float gravityY, float gravityZ);
+	AMMO_API void ammo_world_destroy(ammo_world* world);
+	AMMO_API void ammo_world_set_gravity(ammo_world* world, float x, float y, float z);
+	///Same as btDynamicsWorld::stepSimulation, returns the number of substeps taken.
+	AMMO_API int ammo_world_step(ammo_world* world, float timeStep, int maxSubSteps, float fixedTimeStep);
+	AMMO_API int ammo_world_get_num_collision_objects(const ammo_world* world);
+	AMMO_API void ammo_world_set_solver_iterations(ammo_world* world, int iterations);
+
+	AMMO_API void ammo_world_add_body(ammo_world* world, ammo_body* body, int group, int mask);
+	AMMO_API void ammo_world_remove_body(ammo_world* world, ammo_body* body);
+	AMMO_API void ammo_world_add_character(ammo_world* world, ammo_character* character, int group, int mask);
+	AMMO_API void ammo_world_remove_character(ammo_world* world, ammo_character* character);
+
+	/* Queries */
+
+	///Closest hit between from and to. Writes hit point, hit normal and hit fraction (7 floats) to hit and returns the
+	///hit object, or null if nothing was hit.
+	AMMO_API ammo_object* ammo_world_ray_test_closest(ammo_world* world, const float* from, const float* to, int group, int mask, float* hit);
+	///Closest hit of a convex shape swept from one transform to another. Same output as ammo_world_ray_test_closest.
+	AMMO_API ammo_object* ammo_world_convex_sweep_closest(ammo_world* world, const ammo_shape* shape, const float* from, const float* to, int group, int mask, float* hit);
+	///Number of contact points between object and the rest of the world.
+	AMMO_API int ammo_world_contact_test(ammo_world* world, ammo_object* object, int group, int mask);
+
+	AMMO_API int ammo_object_get_user_index(const ammo_object* object);
+	AMMO_API void ammo_object_set_user_index(ammo_object* object, int index);
+	///The rigid body of an object, null if it is not one
+	AMMO_API ammo_body* ammo_object_as_body(ammo_object* object);
+	AMMO_API ammo_object* ammo_body_as_object(ammo_body* body);
+	AMMO_API ammo_object* ammo_character_as_object(ammo_character* character);
+
+	/* Shapes */
+
+	AMMO_API ammo_shape* ammo_shape_create_box(float halfX, float halfY, float halfZ);
+	AMMO_API ammo_shape* ammo_shape_create_sphere(float radius);
+	///Y axis capsule, height is the distance between the sphere centers
+	AMMO_API ammo_shape* ammo_shape_create_capsule(float radius, float height);
+	AMMO_API ammo_shape* ammo_shape_create_cylinder(float halfX, float halfY, float halfZ);
+	AMMO_API ammo_shape* ammo_shape_create_cone(float radius, float height);
+	AMMO_API ammo_shape* ammo_shape_create_convex_hull(const float* points, int numPoints);
+	///Static triangle mesh with a BVH. The vertices (3 floats each) and indices (3 ints per triangle) are copied.
+	AMMO_API ammo_shape* ammo_shape_create_triangle_mesh(const float* vertices, int numVertices, const int* indices, int numTriangles);
+	///Children are not owned by the compound
+	AMMO_API ammo_shape* ammo_shape_create_compound(void);
+	AMMO_API void ammo_compound_add_child(ammo_shape* compound, const float* transform, ammo_shape* child);
+	AMMO_API void ammo_shape_set_margin(ammo_shape* shape, float margin);
+	AMMO_API void ammo_shape_set_local_scaling(ammo_shape* shape, float x, float y, float z);
+	AMMO_API void ammo_shape_destroy(ammo_shape* shape);
+
+	/* Rigid bodies */
+
+	///Mass 0 makes a static body. The body gets a btDefaultMotionState, which ammo_body_get_interpolated_transform reads.
+	AMMO_API ammo_body* ammo_body_create(ammo_shape* shape, float mass, const float* transform);
+	AMMO_API void ammo_body_destroy(ammo_body* body);
+
+	AMMO_API void ammo_body_get_transform(const ammo_body* body, float* out);
+	AMMO_API void ammo_body_get_interpolated_transform(const ammo_body* body, float* out);
+	///Sets the world and motion state transform and wakes the body up
+	AMMO_API void ammo_body_set_transform(ammo_body* body, const float* transform);
+	AMMO_API void ammo_body_get_linear_velocity(const ammo_body* body, float* out);
+	AMMO_API void ammo_body_set_linear_velocity(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_get_angular_velocity(const ammo_body* body, float* out);
+	AMMO_API void ammo_body_set_angular_velocity(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_apply_central_impulse(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_apply_central_force(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_apply_torque(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_set_linear_factor(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_set_angular_factor(ammo_body* body, float x, float y, float z);
+	AMMO_API void ammo_body_set_friction(ammo_body* body, float friction);
+	AMMO_API void ammo_body_set_restitution(ammo_body* body, float restitution);
+	AMMO_API void ammo_body_set_damping(ammo_body* body, float linear, float angular);
+	AMMO_API void ammo_body_set_ccd(ammo_body* body, float motionThreshold, float sweptSphereRadius);
+	AMMO_API int ammo_body_get_collision_flags(const ammo_body* body);
+	AMMO_API void ammo_body_set_collision_flags(ammo_body* body, int flags);
+	AMMO_API int ammo_body_get_activation_state(const ammo_body* body);
+	AMMO_API void ammo_body_set_activation_state(ammo_body* body, int state);
+	AMMO_API void ammo_body_activate(ammo_body* body);
+
+	/* Character controllers */
+
+	///An hbrKinematicCharacterController with its own btPairCachingGhostObject. shape must be convex.
+	AMMO_API ammo_character* ammo_character_create(ammo_shape* shape, float stepHeight, const float* position, const float* up);
+	AMMO_API void ammo_character_destroy(ammo_character* character);
+
+	AMMO_API void ammo_character_get_transform(const ammo_character* character, float* out);
+	AMMO_API void ammo_character_warp(ammo_character* character, float x, float y, float z);
+	AMMO_API void ammo_character_set_walk_direction(ammo_character* character, float x, float y, float z);
+	AMMO_API void ammo_character_get_linear_velocity(const ammo_character* character, float* out);
+	AMMO_API void ammo_character_set_linear_velocity(ammo_character* character, float x, float y, float z);
+	AMMO_API void ammo_character_jump(ammo_character* character);
+	AMMO_API int ammo_character_can_jump(const ammo_character* character);
+	AMMO_API int ammo_character_on_ground(const ammo_character* character);
+	AMMO_API void ammo_character_set_jump_speed(ammo_character* character, float speed);
+	AMMO_API void ammo_character_set_fall_speed(ammo_character* character, float speed);
+	AMMO_API void ammo_character_set_max_jump_height(ammo_character* character, float height);
+	AMMO_API void ammo_character_set_max_slope(ammo_character* character, float radians);
+	AMMO_API void ammo_character_set_gravity(ammo_character* character, float x, float y, float z);
+	AMMO_API void ammo_character_set_max_walk_speed(ammo_character* character, float speed);
+	AMMO_API void ammo_character_set_walk_acceleration(ammo_character* character, float acceleration);
+	AMMO_API void ammo_character_set_friction(ammo_character* character, float friction);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HBR_AMMO_C_API_H
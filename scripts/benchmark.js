@@ -0,0 +1,492 @@
+"use strict";
+
+// Headless benchmark suite for the ammo.js builds.
+//
+//   node scripts/benchmark.js [--build builds/ammo.wasm.js] [--scenes boxStacks,vehicles] [--steps 600]
+//                             [--baseline baseline.json] [--save baseline.json] [--tolerance 0.15] [--threads 4]
+//                             [--broadphase grid] [--cellSize 4] [--world activeSet] [--solver adaptive]
+//
+// Every scene is stepped at a fixed 1/60 time step. The report is printed as JSON: steps per second, p50 and p99
+// step latency in milliseconds and how far each scene grew the emscripten heap (sbrk top). With --baseline the report
+// is compared against a previously saved one and the process exits with 1 if any scene got slower than the tolerance.
+// --threads (threads build only) steps btDiscreteDynamicsWorldMt with that many threads instead.
+// --broadphase grid runs the scenes on an hbrGridBroadphase with cells of --cellSize instead of btDbvtBroadphase,
+// compare it against a dbvt baseline on the character scenes.
+// --world activeSet steps an hbrActiveSetDynamicsWorld, which only visits the awake bodies, instead of
+// btDiscreteDynamicsWorld.
+// --solver adaptive solves every island with an hbrAdaptiveConstraintSolver in adaptive mode (default limits).
+// The report also has the startup cost of the build: download size (raw and gzipped), wasm compile time and the time
+// until the Ammo() promise resolves, for comparing the module selections of make.py. Scenes that need a module the
+// build does not have are skipped.
+
+var path = require('path');
+var fs = require('fs');
+
+var options = {
+    build: path.join(__dirname, '..', 'builds', 'ammo.js'),
+    scenes: null,
+    steps: 600,
+    warmup: 60,
+    baseline: null,
+    save: null,
+    tolerance: 0.15,
+    threads: 0,
+    broadphase: 'dbvt',
+    cellSize: 4,
+    world: 'discrete',
+    solver: 'sequential'
+};
+
+(function parseArguments(args) {
+    for (var i = 0; i < args.length; i++) {
+        var name = args[i].replace(/^--/, '');
+        if (!(name in options)) {
+            console.error('unknown option ' + args[i]);
+            process.exit(2);
+        }
+        var value = args[++i];
+        if (name === 'scenes') {
+            options.scenes = value.split(',');
+        } else if (name === 'broadphase') {
+            if (value !== 'dbvt' && value !== 'grid') {
+                console.error('--broadphase is dbvt or grid');
+                process.exit(2);
+            }
+            options.broadphase = value;
+        } else if (name === 'world') {
+            if (value !== 'discrete' && value !== 'activeSet') {
+                console.error('--world is discrete or activeSet');
+                process.exit(2);
+            }
+            options.world = value;
+        } else if (name === 'solver') {
+            if (value !== 'sequential' && value !== 'adaptive') {
+                console.error('--solver is sequential or adaptive');
+                process.exit(2);
+            }
+            options.solver = value;
+        } else if (typeof options[name] === 'number') {
+            options[name] = Number(value);
+        } else {
+            options[name] = path.resolve(value);
+        }
+    }
+})(process.argv.slice(2));
+
+var TIME_STEP = 1 / 60;
+
+// Scenes create their objects through a context, so everything can be removed from the world and destroyed
+// before the next scene runs in the same (fixed size) heap.
+function SceneContext(Ammo) {
+    this.Ammo = Ammo;
+    this.objects = [];
+    this.bodies = [];
+    this.constraints = [];
+    this.actions = [];
+    this.collisionObjects = [];
+    this.perStep = [];
+
+    this.collisionConfiguration = this.keep(new Ammo.btDefaultCollisionConfiguration());
+    if (options.broadphase === 'grid') {
+        this.broadphase = this.keep(new Ammo.hbrGridBroadphase(options.cellSize));
+    } else {
+        this.broadphase = this.keep(new Ammo.btDbvtBroadphase());
+    }
+    if (options.threads > 0) {
+        this.dispatcher = this.keep(new Ammo.btCollisionDispatcherMt(this.collisionConfiguration));
+        this.solver = this.keep(new Ammo.btConstraintSolverPoolMt(options.threads));
+        this.world = this.keep(new Ammo.btDiscreteDynamicsWorldMt(this.dispatcher, this.broadphase, this.solver, null, this.collisionConfiguration));
+    } else {
+        this.dispatcher = this.keep(new Ammo.btCollisionDispatcher(this.collisionConfiguration));
+        if (options.solver === 'adaptive') {
+            this.solver = this.keep(new Ammo.hbrAdaptiveConstraintSolver());
+            this.solver.setAdaptive(true);
+        } else {
+            this.solver = this.keep(new Ammo.btSequentialImpulseConstraintSolver());
+        }
+        var World = options.world === 'activeSet' ? Ammo.hbrActiveSetDynamicsWorld : Ammo.btDiscreteDynamicsWorld;
+        this.world = this.keep(new World(this.dispatcher, this.broadphase, this.solver, this.collisionConfiguration));
+    }
+    this.world.setGravity(this.vector(0, -10, 0));
+    // Islands are only solved one by one when they are not batched
+    if (options.solver === 'adaptive') this.world.getSolverInfo().set_m_minimumSolverBatchSize(1);
+}
+
+SceneContext.prototype.keep = function(object) {
+    this.objects.push(object);
+    return object;
+};
+
+SceneContext.prototype.vector = function(x, y, z) {
+    return this.keep(new this.Ammo.btVector3(x, y, z));
+};
+
+SceneContext.prototype.transform = function(x, y, z) {
+    var transform = this.keep(new this.Ammo.btTransform());
+    transform.setIdentity();
+    transform.setOrigin(this.vector(x, y, z));
+    return transform;
+};
+
+SceneContext.prototype.body = function(mass, shape, x, y, z) {
+    var Ammo = this.Ammo;
+    var inertia = this.vector(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var motionState = this.keep(new Ammo.btDefaultMotionState(this.transform(x, y, z)));
+    var info = this.keep(new Ammo.btRigidBodyConstructionInfo(mass, motionState, shape, inertia));
+    var body = this.keep(new Ammo.btRigidBody(info));
+    this.world.addRigidBody(body);
+    this.bodies.push(body);
+    return body;
+};
+
+SceneContext.prototype.ground = function(halfExtent) {
+    return this.body(0, this.keep(new this.Ammo.btBoxShape(this.vector(halfExtent, 0.5, halfExtent))), 0, -0.5, 0);
+};
+
+SceneContext.prototype.destroy = function() {
+    var world = this.world;
+    this.actions.forEach(function(action) { world.removeAction(action); });
+    this.constraints.forEach(function(constraint) { world.removeConstraint(constraint); });
+    this.bodies.forEach(function(body) { world.removeRigidBody(body); });
+    this.collisionObjects.forEach(function(object) { world.removeCollisionObject(object); });
+    for (var i = this.objects.length - 1; i >= 0; i--) {
+        // Interfaces without a public destructor (e.g. btVehicleTuning) are leaked
+        if (this.objects[i].__destroy__) this.Ammo.destroy(this.objects[i]);
+    }
+    if (this.heapBuffers) {
+        this.heapBuffers.forEach(this.Ammo._free);
+    }
+};
+
+SceneContext.prototype.malloc = function(bytes) {
+    var pointer = this.Ammo._malloc(bytes);
+    (this.heapBuffers = this.heapBuffers || []).push(pointer);
+    return pointer;
+};
+
+var SCENES = {
+    boxStacks: function(ctx) {
+        var Ammo = ctx.Ammo;
+        var box = ctx.keep(new Ammo.btBoxShape(ctx.vector(0.5, 0.5, 0.5)));
+        ctx.ground(50);
+        for (var stack = 0; stack < 10; stack++) {
+            for (var level = 0; level < 20; level++) {
+                ctx.body(1, box, (stack % 5) * 4 - 8, 0.5 + level, Math.floor(stack / 5) * 4 - 2);
+            }
+        }
+    },
+
+    triangleMesh: function(ctx) {
+        var Ammo = ctx.Ammo;
+        var mesh = ctx.keep(new Ammo.btTriangleMesh(true, false));
+        var size = 64, spacing = 1;
+        function height(x, z) {
+            return Math.sin(x * 0.3) * Math.cos(z * 0.2) * 2;
+        }
+        function vertex(x, z) {
+            return ctx.vector((x - size / 2) * spacing, height(x, z), (z - size / 2) * spacing);
+        }
+        for (var x = 0; x < size; x++) {
+            for (var z = 0; z < size; z++) {
+                mesh.addTriangle(vertex(x, z), vertex(x + 1, z), vertex(x, z + 1), false);
+                mesh.addTriangle(vertex(x + 1, z), vertex(x + 1, z + 1), vertex(x, z + 1), false);
+            }
+        }
+        var level = ctx.keep(new Ammo.btBvhTriangleMeshShape(mesh, true, true));
+        ctx.body(0, level, 0, 0, 0);
+
+        var sphere = ctx.keep(new Ammo.btSphereShape(0.5));
+        var box = ctx.keep(new Ammo.btBoxShape(ctx.vector(0.5, 0.5, 0.5)));
+        for (var i = 0; i < 300; i++) {
+            ctx.body(1, i % 2 ? sphere : box, (i % 20) * 2.5 - 25, 5 + Math.floor(i / 20) * 1.5, (i % 7) * 3 - 10);
+        }
+    },
+
+    heightfield: function(ctx) {
+        var Ammo = ctx.Ammo;
+        var samples = 256;
+        var heights = ctx.malloc(samples * samples * 4);
+        var minHeight = 0, maxHeight = 0;
+        for (var z = 0; z < samples; z++) {
+            for (var x = 0; x < samples; x++) {
+                var h = Math.sin(x * 0.1) * Math.cos(z * 0.13) * 3;
+                Ammo.HEAPF32[(heights >> 2) + z * samples + x] = h;
+                minHeight = Math.min(minHeight, h);
+                maxHeight = Math.max(maxHeight, h);
+            }
+        }
+        var terrain = ctx.keep(new Ammo.btHeightfieldTerrainShape(samples, samples, heights, 1, minHeight, maxHeight, 1, 'PHY_FLOAT', false));
+        terrain.setLocalScaling(ctx.vector(0.5, 1, 0.5));
+        ctx.body(0, terrain, 0, (minHeight + maxHeight) / 2, 0);
+
+        var sphere = ctx.keep(new Ammo.btSphereShape(0.5));
+        for (var i = 0; i < 300; i++) {
+            ctx.body(1, sphere, (i % 20) * 3 - 30, 6 + Math.floor(i / 20), (i % 13) * 4 - 26);
+        }
+    },
+
+    compoundShapes: function(ctx) {
+        var Ammo = ctx.Ammo;
+        ctx.ground(50);
+        var compound = ctx.keep(new Ammo.btCompoundShape(true));
+        var bar = ctx.keep(new Ammo.btBoxShape(ctx.vector(1, 0.2, 0.2)));
+        var ball = ctx.keep(new Ammo.btSphereShape(0.4));
+        compound.addChildShape(ctx.transform(0, 0, 0), bar);
+        compound.addChildShape(ctx.transform(1, 0, 0), ball);
+        compound.addChildShape(ctx.transform(-1, 0, 0), ball);
+        for (var i = 0; i < 200; i++) {
+            ctx.body(1, compound, (i % 10) * 3 - 15, 1 + Math.floor(i / 10) * 1.2, (i % 3) * 2);
+        }
+    },
+
+    constraintChains: function(ctx) {
+        var Ammo = ctx.Ammo;
+        ctx.ground(50);
+        var link = ctx.keep(new Ammo.btBoxShape(ctx.vector(0.1, 0.25, 0.1)));
+        for (var chain = 0; chain < 20; chain++) {
+            var x = (chain % 5) * 3 - 6, z = Math.floor(chain / 5) * 3 - 6;
+            var previous = null;
+            for (var i = 0; i < 20; i++) {
+                var body = ctx.body(i === 0 ? 0 : 1, link, x, 20 - i * 0.5, z);
+                if (previous) {
+                    var constraint = ctx.keep(new Ammo.btPoint2PointConstraint(previous, body, ctx.vector(0, -0.25, 0), ctx.vector(0, 0.25, 0)));
+                    ctx.world.addConstraint(constraint, true);
+                    ctx.constraints.push(constraint);
+                }
+                previous = body;
+            }
+            // Start swinging
+            previous.setLinearVelocity(ctx.vector(5, 0, 0));
+        }
+    },
+
+    vehicles: function(ctx) {
+        var Ammo = ctx.Ammo;
+        ctx.ground(200);
+        var tuning = ctx.keep(new Ammo.btVehicleTuning());
+        var raycaster = ctx.keep(new Ammo.btDefaultVehicleRaycaster(ctx.world));
+        var chassisShape = ctx.keep(new Ammo.btBoxShape(ctx.vector(0.9, 0.3, 2)));
+        var down = ctx.vector(0, -1, 0), axle = ctx.vector(-1, 0, 0);
+        var vehicles = [];
+        for (var i = 0; i < 50; i++) {
+            var chassis = ctx.body(800, chassisShape, (i % 10) * 6 - 30, 2, Math.floor(i / 10) * 8 - 20);
+            chassis.setActivationState(4);
+            var vehicle = ctx.keep(new Ammo.btRaycastVehicle(tuning, chassis, raycaster));
+            vehicle.setCoordinateSystem(0, 1, 2);
+            [[1, 1.7, true], [-1, 1.7, true], [-1, -1, false], [1, -1, false]].forEach(function(w) {
+                var wheel = vehicle.addWheel(ctx.vector(w[0], 0.3, w[1]), down, axle, 0.6, 0.4, tuning, w[2]);
+                wheel.set_m_suspensionStiffness(20);
+                wheel.set_m_wheelsDampingRelaxation(2.3);
+                wheel.set_m_wheelsDampingCompression(4.4);
+                wheel.set_m_frictionSlip(1000);
+                wheel.set_m_rollInfluence(0.2);
+            });
+            ctx.world.addAction(vehicle);
+            ctx.actions.push(vehicle);
+            vehicles.push(vehicle);
+        }
+        var frame = 0;
+        ctx.perStep.push(function() {
+            frame++;
+            vehicles.forEach(function(vehicle, i) {
+                vehicle.applyEngineForce(1000, 2);
+                vehicle.applyEngineForce(1000, 3);
+                var steering = Math.sin(frame * 0.02 + i) * 0.3;
+                vehicle.setSteeringValue(steering, 0);
+                vehicle.setSteeringValue(steering, 1);
+            });
+        });
+    },
+
+    characters: function(ctx, count) {
+        var Ammo = ctx.Ammo;
+        ctx.ground(200);
+        var box = ctx.keep(new Ammo.btBoxShape(ctx.vector(1, 1, 1)));
+        for (var i = 0; i < 100; i++) {
+            ctx.body(0, box, (i % 10) * 12 - 60, 1, Math.floor(i / 10) * 12 - 60);
+        }
+
+        ctx.world.getPairCache().setInternalGhostPairCallback(ctx.keep(new Ammo.btGhostPairCallback()));
+        var capsule = ctx.keep(new Ammo.btCapsuleShape(0.4, 1));
+        var up = ctx.vector(0, 1, 0);
+        var controllers = [];
+        var side = Math.ceil(Math.sqrt(count));
+        for (var i = 0; i < count; i++) {
+            var ghost = ctx.keep(new Ammo.btPairCachingGhostObject());
+            ghost.setWorldTransform(ctx.transform((i % side) * 2 - side, 1, Math.floor(i / side) * 2 - side));
+            ghost.setCollisionShape(capsule);
+            ghost.setCollisionFlags(16); // CF_CHARACTER_OBJECT
+            ctx.world.addCollisionObject(ghost, 32, -1);
+            ctx.collisionObjects.push(ghost);
+
+            var controller = ctx.keep(new Ammo.hbrKinematicCharacterController(ghost, capsule, 0.35, up));
+            ctx.world.addAction(controller);
+            ctx.actions.push(controller);
+            controllers.push(controller);
+        }
+        var walk = ctx.vector(0, 0, 0);
+        var frame = 0;
+        ctx.perStep.push(function() {
+            frame++;
+            controllers.forEach(function(controller, i) {
+                var angle = frame * 0.01 + i;
+                walk.setValue(Math.cos(angle) * 0.05, 0, Math.sin(angle) * 0.05);
+                controller.setWalkDirection(walk);
+            });
+        });
+    }
+};
+
+// Name, scene and the interface it needs beyond the core
+var SCENE_LIST = [
+    ['boxStacks', SCENES.boxStacks],
+    ['triangleMesh', SCENES.triangleMesh],
+    ['heightfield', SCENES.heightfield, 'btHeightfieldTerrainShape'],
+    ['compoundShapes', SCENES.compoundShapes],
+    ['constraintChains', SCENES.constraintChains],
+    ['vehicles', SCENES.vehicles, 'btRaycastVehicle']
+];
+[1, 10, 100, 1000].forEach(function(count) {
+    SCENE_LIST.push(['characters' + count, function(ctx) { SCENES.characters(ctx, count); }, 'hbrKinematicCharacterController']);
+});
+
+function elapsedMs(start) {
+    var elapsed = process.hrtime(start);
+    return +(elapsed[0] * 1e3 + elapsed[1] / 1e6).toFixed(2);
+}
+
+function measureDownload(build) {
+    var zlib = require('zlib');
+    var js = fs.readFileSync(build);
+    var startup = {
+        jsBytes: js.length,
+        jsGzipBytes: zlib.gzipSync(js).length
+    };
+    var wasmFile = build.replace(/\.js$/, '.wasm');
+    if (fs.existsSync(wasmFile)) {
+        var wasm = fs.readFileSync(wasmFile);
+        startup.wasmBytes = wasm.length;
+        startup.wasmGzipBytes = zlib.gzipSync(wasm).length;
+        var start = process.hrtime();
+        new WebAssembly.Module(wasm);
+        startup.wasmCompileMs = elapsedMs(start);
+    }
+    return startup;
+}
+
+function heapTop(Ammo) {
+    // The sbrk top is the high-water mark of the emscripten heap, malloc never gives memory back to it. A scene first
+    // reuses what the scenes before it freed, run it alone (--scenes) for its full footprint.
+    if (typeof Ammo._sbrk === 'function') return Ammo._sbrk(0);
+    return null;
+}
+
+function percentile(sorted, p) {
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+function runScene(Ammo, build) {
+    var heapBefore = heapTop(Ammo);
+    var ctx = new SceneContext(Ammo);
+    build(ctx);
+
+    function step() {
+        for (var i = 0; i < ctx.perStep.length; i++) ctx.perStep[i]();
+        ctx.world.stepSimulation(TIME_STEP, 0);
+    }
+
+    for (var i = 0; i < options.warmup; i++) step();
+
+    var times = new Float64Array(options.steps);
+    var start = process.hrtime();
+    for (var i = 0; i < options.steps; i++) {
+        var before = process.hrtime();
+        step();
+        var elapsed = process.hrtime(before);
+        times[i] = elapsed[0] * 1e3 + elapsed[1] / 1e6;
+    }
+    var total = process.hrtime(start);
+    var heapAfter = heapTop(Ammo);
+
+    ctx.destroy();
+
+    var sorted = Array.prototype.slice.call(times).sort(function(a, b) { return a - b; });
+    var seconds = total[0] + total[1] / 1e9;
+    return {
+        stepsPerSecond: +(options.steps / seconds).toFixed(2),
+        p50Ms: +percentile(sorted, 0.5).toFixed(4),
+        p99Ms: +percentile(sorted, 0.99).toFixed(4),
+        heapGrowthBytes: heapAfter === null ? null : heapAfter - heapBefore
+    };
+}
+
+function compare(report, baseline) {
+    var regressions = [];
+    Object.keys(report.scenes).forEach(function(name) {
+        var now = report.scenes[name], before = baseline.scenes[name];
+        if (!before) return;
+        var comparison = {
+            stepsPerSecond: +(now.stepsPerSecond / before.stepsPerSecond).toFixed(3),
+            p99Ms: +(now.p99Ms / before.p99Ms).toFixed(3)
+        };
+        now.baseline = comparison;
+        if (comparison.stepsPerSecond < 1 - options.tolerance || comparison.p99Ms > 1 + options.tolerance) {
+            regressions.push(name);
+        }
+    });
+    return regressions;
+}
+
+var startup = measureDownload(options.build);
+var loadStart = process.hrtime();
+var Ammo = require(options.build);
+
+Ammo().then(function(Ammo) {
+    startup.readyMs = elapsedMs(loadStart);
+    var report = {
+        build: path.relative(process.cwd(), options.build),
+        node: process.version,
+        steps: options.steps,
+        timeStep: TIME_STEP,
+        startup: startup,
+        broadphase: options.broadphase,
+        world: options.world,
+        solver: options.solver,
+        scenes: {}
+    };
+
+    if (options.threads > 0) {
+        if (!Ammo.hbrTaskScheduler) {
+            console.error('--threads needs the threads build (python make.py threads)');
+            process.exit(2);
+        }
+        if (options.world !== 'discrete' || options.solver !== 'sequential') {
+            console.error('--threads steps btDiscreteDynamicsWorldMt, it cannot be combined with --world or --solver');
+            process.exit(2);
+        }
+        report.threads = new Ammo.hbrTaskScheduler().setNumThreads(options.threads);
+    }
+    if (options.broadphase === 'grid') report.cellSize = options.cellSize;
+
+    SCENE_LIST.forEach(function(entry) {
+        if (options.scenes && options.scenes.indexOf(entry[0]) < 0) return;
+        if (entry[2] && !Ammo[entry[2]]) {
+            (report.skipped = report.skipped || []).push(entry[0]);
+            return;
+        }
+        report.scenes[entry[0]] = runScene(Ammo, entry[1]);
+    });
+
+    var regressions = [];
+    if (options.baseline) {
+        regressions = compare(report, JSON.parse(fs.readFileSync(options.baseline, 'utf8')));
+        report.regressions = regressions;
+    }
+    if (options.save) {
+        fs.writeFileSync(options.save, JSON.stringify(report, null, 2) + '\n');
+    }
+
+    process.stdout.write(JSON.stringify(report, null, 2) + '\n');
+    process.exit(regressions.length ? 1 : 0);
+});
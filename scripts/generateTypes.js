@@ -292,7 +292,10 @@ function printModuleMember(module) {
         return;
     }
     
-    idl = fs.readFileSync(process.argv[2]).toString()
+    // ammo.idl and the module files in idl/ are read as one
+    idl = process.argv.slice(2).map(function (filename) {
+        return fs.readFileSync(filename).toString();
+    }).join("\n")
         .replace(/[A-z0-9]+ implements [A-z0-9]+;/ig, '')
         .replace(/\[Ref\] optional /ig, 'optional [Ref]')
         .replace(/\[Const, Ref\] optional /ig, 'optional [Const, Ref]')
@@ -8,6 +8,16 @@ if len(sys.argv) > 1:
 print 'Using build:', build
 build = os.path.basename(build)
 
+# The native build has its own test, a C program linked against it
+if build == 'libammo.so':
+  binary = os.path.join('builds', 'test_native')
+  Popen(['cc', '-std=c99', '-o', binary, os.path.join('tests', 'native.c'), '-Lbuilds', '-lammo', '-lm']).communicate()
+  output = Popen([binary], stdout=PIPE, env=dict(os.environ, LD_LIBRARY_PATH='builds')).communicate()[0]
+  os.remove(binary)
+  assert 'ok.' in output, output
+  print 'ok.'
+  sys.exit(0)
+
 exec(open(os.path.expanduser('~/.emscripten'), 'r').read())
 
 if SPIDERMONKEY_ENGINE:
@@ -49,7 +59,22 @@ def stage(text):
 if len(sys.argv) != 3 or sys.argv[2] != 'benchmark':
   stage('regression tests')
 
-  for test in ['basics', 'wrapping', '2', '3', 'constraint', 'compoundShape']:
+  tests = ['basics', 'wrapping', '2', '3', 'constraint', 'compoundShape', 'shapeCache', 'terrain', 'kinematicBatch', 'handles', 'arrayView', 'softBody', 'vehicleFleet', 'triggers', 'collisionLayers', 'profiler', 'arena', 'collisionPools', 'gridBroadphase', 'staticBatch', 'instancedShape', 'activeSetWorld', 'adaptiveSolver', 'asyncStepper', 'snapshot', 'floatingOrigin', 'threads']
+
+  # Tests of the optional modules in make.py. Builds of a module selection are named ammo.core-<modules>.*js, the
+  # threads module is in builds named *.threads.*
+  module_tests = { 'character': ['floatingOrigin'], 'handles': ['handles', 'asyncStepper', 'snapshot'], 'heightfield': ['terrain'], 'vehicle': ['vehicleFleet'], 'softbody': ['softBody'], 'threads': ['threads'] }
+  modules = ['character', 'handles', 'heightfield', 'vehicle', 'softbody']
+  for part in build.split('.'):
+    if part == 'core' or part.startswith('core-'):
+      modules = part.split('-')[1:]
+  if '.threads.' in build:
+    modules.append('threads')
+  for module in module_tests:
+    if module not in modules:
+      tests = [test for test in tests if test not in module_tests[module]]
+
+  for test in tests:
     name = test + '.js'
     print '     ', name
     fullname = os.path.join('tests', name)
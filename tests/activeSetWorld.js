@@ -0,0 +1,105 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.hbrActiveSetDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  assertEq(world.getForceUpdateAllAabbs(), false);
+
+  function transformAt(x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    return transform;
+  }
+
+  function createBody(mass, shape, x, y, z) {
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var body = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transformAt(x, y, z)), shape, inertia));
+    world.addRigidBody(body);
+    return body;
+  }
+
+  function rayHit(x, z) {
+    var callback = new Ammo.ClosestRayResultCallback(new Ammo.btVector3(x, 10, z), new Ammo.btVector3(x, -10, z));
+    world.rayTest(callback.get_m_rayFromWorld(), callback.get_m_rayToWorld(), callback);
+    var y = callback.hasHit() ? callback.get_m_hitPointWorld().y() : null;
+    Ammo.destroy(callback);
+    return y;
+  }
+
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(50, 0.5, 50)), 0, -0.5, 0);
+  var sphere = new Ammo.btSphereShape(0.5);
+  var spheres = [];
+  for (var i = 0; i < 10; i++) {
+    spheres.push(createBody(1, sphere, i * 3, 1, 0));
+  }
+  assertEq(world.getNumActiveBodies(), 10, 'the ground is not in the awake set');
+
+  // The spheres settle and fall asleep
+  for (var i = 0; i < 300; i++) world.stepSimulation(1 / 60, 0);
+  spheres.forEach(function(body) { assert(!body.isActive(), 'sphere is asleep'); });
+  assertEq(world.getNumActiveBodies(), 0);
+
+  // A ball dropped onto the first sphere wakes it and only it
+  var ball = createBody(1, sphere, 0, 3, 0);
+  assertEq(world.getNumActiveBodies(), 1);
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  assert(spheres[0].isActive(), 'the sphere that was hit woke');
+  assert(!spheres[1].isActive());
+  assertEq(world.getNumActiveBodies(), 2);
+
+  // Static objects are not visited until they are marked moved
+  var door = createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(1, 1, 1)), -10, 1, 0);
+  world.stepSimulation(1 / 60, 0);
+  assert(Math.abs(rayHit(-10, 0) - 2) < 0.01);
+  door.setWorldTransform(transformAt(-20, 1, 0));
+  world.stepSimulation(1 / 60, 0);
+  assertEq(rayHit(-20, 0), null, 'the broadphase still has the old AABB');
+  world.markMoved(door);
+  assertEq(world.getNumMovedObjects(), 1);
+  world.stepSimulation(1 / 60, 0);
+  assertEq(world.getNumMovedObjects(), 0);
+  assert(Math.abs(rayHit(-20, 0) - 2) < 0.01, 'the door moved');
+  assert(Math.abs(rayHit(-10, 0)) < 0.01, 'the ground is visible where the door was');
+
+  // Kinematic bodies added static join the awake set through hbrKinematicBodyBatch
+  var platform = createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(2, 0.25, 2)), 40, 1, 0);
+  var active = world.getNumActiveBodies();
+  var batch = new Ammo.hbrKinematicBodyBatch(world);
+  var index = batch.addBody(platform);
+  assertEq(world.getNumActiveBodies(), active + 1);
+  var indices = Ammo._malloc(4);
+  var transforms = Ammo._malloc(4 * 7);
+  Ammo.HEAP32[indices >> 2] = index;
+  [40, 5, 0, 0, 0, 0, 1].forEach(function(value, i) { Ammo.HEAPF32[(transforms >> 2) + i] = value; });
+  batch.setTransforms(indices, transforms, 1, 1 / 60);
+  world.stepSimulation(1 / 60, 0);
+  assert(Math.abs(rayHit(40, 0) - 5.25) < 0.01, 'the platform moved up');
+  Ammo._free(indices);
+  Ammo._free(transforms);
+
+  // A kinematic body added with the static flag of mass 0 is awake from the start, also in free space
+  var lift = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(0, new Ammo.btDefaultMotionState(transformAt(60, 1, 0)), new Ammo.btBoxShape(new Ammo.btVector3(1, 1, 1)), new Ammo.btVector3(0, 0, 0)));
+  lift.setCollisionFlags(lift.getCollisionFlags() | 2); // CF_KINEMATIC_OBJECT
+  lift.setActivationState(4); // DISABLE_DEACTIVATION
+  world.addRigidBody(lift);
+  assertEq(world.getNumActiveBodies(), active + 2);
+  lift.getMotionState().setWorldTransform(transformAt(60, 5, 0));
+  world.stepSimulation(1 / 60, 0);
+  assert(Math.abs(rayHit(60, 0) - 6) < 0.01, 'the lift moved up');
+  world.removeRigidBody(lift);
+  assertEq(world.getNumActiveBodies(), active + 1);
+
+  // Removed bodies leave the awake set, bodies woken from outside are found again
+  world.removeRigidBody(ball);
+  assertEq(world.getNumActiveBodies(), active);
+  spheres[5].activate();
+  world.refreshActiveSet();
+  assertEq(world.getNumActiveBodies(), active + 1);
+
+  print('ok.');
+});
@@ -0,0 +1,99 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.hbrAdaptiveConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  // Solve every island by itself
+  world.getSolverInfo().set_m_minimumSolverBatchSize(1);
+  assertEq(world.getSolverInfo().get_m_minimumSolverBatchSize(), 1);
+
+  function createBody(mass, shape, x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var body = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia));
+    body.setActivationState(4); // DISABLE_DEACTIVATION, sleeping islands are not solved
+    world.addRigidBody(body);
+    return body;
+  }
+
+  // A stack of five boxes and a single box, two islands
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(50, 0.5, 50)), 0, -0.5, 0);
+  var box = new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5));
+  var stack = [];
+  for (var i = 0; i < 5; i++) {
+    stack.push(createBody(1, box, 0, 0.5 + i, 0));
+  }
+  createBody(1, box, 10, 0.5, 0);
+
+  // Without adaptive mode it iterates like btSequentialImpulseConstraintSolver
+  assert(!solver.getAdaptive());
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  assertEq(solver.getNumIslands(), 2);
+  assert(solver.getMaxIslandIterations() <= world.getSolverInfo().get_m_numIterations());
+  assert(solver.getNumIterations() <= 2 * world.getSolverInfo().get_m_numIterations());
+
+  // Fixed limits per island
+  solver.setAdaptive(true);
+  solver.setIterationLimits(3, 3);
+  assertEq(solver.getMinIterations(), 3);
+  assertEq(solver.getMaxIterations(), 3);
+  world.stepSimulation(1 / 60, 0);
+  assertEq(solver.getNumIterations(), 6);
+  assertEq(solver.getMaxIslandIterations(), 3);
+
+  // Every island converges after its first iteration with a generous threshold
+  solver.setIterationLimits(1, 50);
+  solver.setResidualThreshold(1e10);
+  world.stepSimulation(1 / 60, 0);
+  assertEq(solver.getNumIterations(), 2);
+  assertEq(solver.getNumUnconverged(), 0);
+
+  // A tight threshold runs into the limit, the telemetry tells which
+  solver.setIterationLimits(1, 8);
+  solver.setResidualThreshold(1e-12);
+  world.stepSimulation(1 / 60, 0);
+  assert(solver.getMaxIslandIterations() <= 8);
+  assert(solver.getMaxResidual() >= 0);
+  assertEq(solver.getNumUnconverged() > 0, solver.getMaxResidual() > 1e-12);
+
+  // The maximum goes past m_numIterations of the solver info, the extra iterations still solve the contacts
+  world.getSolverInfo().set_m_numIterations(4);
+  solver.setIterationLimits(1, 40);
+  solver.setResidualThreshold(0);
+  world.stepSimulation(1 / 60, 0);
+  assert(solver.getMaxIslandIterations() > 5, 'iterations past m_numIterations');
+  assert(solver.getMaxResidual() > 0, 'the extra iterations have work to do');
+  world.getSolverInfo().set_m_numIterations(10);
+
+  // A constraint raises the limit of its island, a negative threshold never converges
+  var pendulum = createBody(1, new Ammo.btSphereShape(0.5), -10, 5, 0);
+  var joint = new Ammo.btPoint2PointConstraint(pendulum, new Ammo.btVector3(0, 2, 0));
+  joint.setOverrideNumSolverIterations(12);
+  assertEq(joint.getOverrideNumSolverIterations(), 12);
+  world.addConstraint(joint);
+  solver.setIterationLimits(3, 3);
+  solver.setResidualThreshold(-1);
+  world.stepSimulation(1 / 60, 0);
+  assertEq(solver.getNumIslands(), 3);
+  assertEq(solver.getMaxIslandIterations(), 12);
+  assertEq(solver.getNumIterations(), 3 + 3 + 12);
+  assertEq(solver.getNumUnconverged(), 3);
+
+  // The stack stays up with iterations spent where they are needed
+  solver.setIterationLimits(2, 30);
+  solver.setResidualThreshold(1e-6);
+  for (var i = 0; i < 120; i++) world.stepSimulation(1 / 60, 0);
+  var transform = new Ammo.btTransform();
+  stack[4].getMotionState().getWorldTransform(transform);
+  assert(Math.abs(transform.getOrigin().y() - 4.5) < 0.1, 'the stack stands');
+  assert(Math.abs(transform.getOrigin().x()) < 0.1);
+  assert(solver.getNumIterations() <= 3 * 30);
+
+  print('ok.');
+});
@@ -0,0 +1,106 @@
+Ammo().then(function(Ammo) {
+
+  var gravity = new Ammo.btVector3(0, -10, 0);
+
+  function createLevel(arena, numBoxes) {
+    arena.setCategory(arena.addCategory('world'));
+    var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+    var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+    var broadphase = new Ammo.btDbvtBroadphase();
+    var solver = new Ammo.btSequentialImpulseConstraintSolver();
+    var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    world.setGravity(gravity);
+
+    arena.setCategory(arena.addCategory('shapes'));
+    var floorShape = new Ammo.btBoxShape(new Ammo.btVector3(50, 0.5, 50));
+    var boxShape = new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5));
+
+    arena.setCategory(arena.addCategory('bodies'));
+    for (var i = 0; i <= numBoxes; i++) {
+      var mass = i === 0 ? 0 : 1;
+      var transform = new Ammo.btTransform();
+      transform.setIdentity();
+      transform.setOrigin(new Ammo.btVector3(0, i === 0 ? -0.5 : i, 0));
+      var inertia = new Ammo.btVector3(0, 0, 0);
+      var shape = i === 0 ? floorShape : boxShape;
+      if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+      var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+      world.addRigidBody(new Ammo.btRigidBody(rbInfo));
+    }
+
+    arena.setCategory(arena.addCategory('step'));
+    return world;
+  }
+
+  var heapVector = new Ammo.btVector3(1, 2, 3);
+
+  var arena = new Ammo.hbrArena();
+  assertEq(arena.getNumCategories(), 1);
+  assertEq(arena.getCategoryName(0), 'default');
+  assert(!arena.isActive());
+
+  // The threads build keeps everything on the heap
+  if (Ammo.btDiscreteDynamicsWorldMt) {
+    arena.activate();
+    assert(!arena.isActive());
+    Ammo.destroy(arena);
+    print('ok.');
+    return;
+  }
+
+  arena.activate();
+  assert(arena.isActive());
+  var world = createLevel(arena, 20);
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+
+  assertEq(arena.getNumCategories(), 5);
+  assertEq(arena.addCategory('shapes'), 2, "categories are looked up by name");
+  var total = 0;
+  ['world', 'shapes', 'bodies'].forEach(function(name) {
+    var category = arena.addCategory(name);
+    assert(arena.getLiveBytes(category) > 0, name + " has live memory");
+    assert(arena.getNumLiveAllocations(category) > 0, name + " has live allocations");
+    assert(arena.getPeakBytes(category) >= arena.getLiveBytes(category), name + " peak");
+  });
+  for (var c = 0; c < arena.getNumCategories(); c++) total += arena.getLiveBytes(c);
+  assertEq(arena.getLiveBytes(-1), total, "the totals add up the categories");
+  assert(arena.getNumAllocations(-1) >= arena.getNumLiveAllocations(-1));
+  assert(arena.getReservedBytes() >= arena.getLiveBytes(-1));
+
+  // Vectors have Bullet's aligned allocator and go to the arena as well
+  var live = arena.getNumLiveAllocations(-1);
+  var arenaVector = new Ammo.btVector3(4, 5, 6);
+  assertEq(arena.getNumLiveAllocations(-1), live + 1, "the vector is in the arena");
+  Ammo.destroy(arenaVector);
+  assertEq(arena.getNumLiveAllocations(-1), live, "and is freed to it");
+  arenaVector = new Ammo.btVector3(4, 5, 6); // left to the reset
+
+  // Heap memory can be freed while the arena is current
+  Ammo.destroy(heapVector);
+  assertEq(arena.getNumLiveAllocations(-1), live + 1);
+
+  // Tearing the level down releases everything without destroying the objects
+  var peak = arena.getPeakBytes(-1);
+  arena.reset();
+  assertEq(arena.getLiveBytes(-1), 0);
+  assertEq(arena.getNumLiveAllocations(-1), 0);
+  assertEq(arena.getReservedBytes(), 0);
+  assertEq(arena.getNumCategories(), 5, "categories survive a reset");
+
+  // The next level reuses the arena
+  world = createLevel(arena, 20);
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  assert(Math.abs(arena.getPeakBytes(-1) - peak) < peak / 2, "the same level needs about the same memory");
+  arena.deactivate();
+  assert(!arena.isActive());
+
+  // Allocations outside of the arena are not counted
+  live = arena.getNumLiveAllocations(-1);
+  var vector = new Ammo.btVector3(0, 0, 0);
+  assertEq(arena.getNumLiveAllocations(-1), live);
+  Ammo.destroy(vector);
+
+  Ammo.destroy(arena);
+
+  print('ok.');
+});
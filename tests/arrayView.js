@@ -0,0 +1,76 @@
+Ammo().then(function(Ammo) {
+
+  var view = new Ammo.hbrArrayView();
+  var stride = view.vector3Stride();
+  assertEq(stride, 4);
+
+  // A unit cube hull
+  var shape = new Ammo.btConvexHullShape();
+  for (var i = 0; i < 8; i++) {
+    shape.addPoint(new Ammo.btVector3(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1), i === 7);
+  }
+  assertEq(shape.getNumVertices(), 8);
+  shape.setMargin(0);
+
+  var points = new Float32Array(Ammo.HEAPF32.buffer, view.convexHullPoints(shape), 8 * stride);
+  for (var i = 0; i < 8; i++) {
+    assertEq(points[i * stride + 0], i & 1 ? 1 : -1);
+    assertEq(points[i * stride + 1], i & 2 ? 1 : -1);
+    assertEq(points[i * stride + 2], i & 4 ? 1 : -1);
+  }
+
+  assert(shape.initializePolyhedralFeatures(0), "initializePolyhedralFeatures");
+  var polyhedron = shape.getConvexPolyhedron();
+  var vertices = polyhedron.get_m_vertices();
+  var data = new Float32Array(Ammo.HEAPF32.buffer, view.vector3ArrayData(vertices), vertices.size() * stride);
+  for (var i = 0; i < vertices.size(); i++) {
+    var v = vertices.at(i);
+    assertEq(data[i * stride + 0], v.x());
+    assertEq(data[i * stride + 1], v.y());
+    assertEq(data[i * stride + 2], v.z());
+  }
+
+  var faces = polyhedron.get_m_faces();
+  var needed = view.copyFaceIndices(faces, 0, 0);
+  var indices = Ammo._malloc(4 * needed);
+  assertEq(view.copyFaceIndices(faces, indices, needed), needed);
+  var offset = indices >> 2;
+  for (var i = 0; i < faces.size(); i++) {
+    var faceIndices = faces.at(i).get_m_indices();
+    assertEq(Ammo.HEAP32[offset], faceIndices.size());
+    var flat = new Int32Array(Ammo.HEAP32.buffer, view.intArrayData(faceIndices), faceIndices.size());
+    for (var j = 0; j < faceIndices.size(); j++) {
+      assertEq(Ammo.HEAP32[offset + 1 + j], faceIndices.at(j));
+      assertEq(flat[j], faceIndices.at(j));
+    }
+    offset += 1 + faceIndices.size();
+  }
+  assertEq(offset, (indices >> 2) + needed);
+  Ammo._free(indices);
+
+  var planes = Ammo._malloc(4 * 4 * faces.size());
+  assertEq(view.copyFacePlanes(faces, planes, faces.size()), faces.size());
+  for (var i = 0; i < faces.size(); i++) {
+    var p = (planes >> 2) + i * 4;
+    var length = Math.sqrt(Ammo.HEAPF32[p] * Ammo.HEAPF32[p] + Ammo.HEAPF32[p + 1] * Ammo.HEAPF32[p + 1] + Ammo.HEAPF32[p + 2] * Ammo.HEAPF32[p + 2]);
+    assert(Math.abs(length - 1) < 0.001, "face normals are unit length");
+  }
+  Ammo._free(planes);
+
+  var hull = new Ammo.btShapeHull(shape);
+  assert(hull.buildHull(0), "buildHull");
+  assertEq(hull.numIndices(), hull.numTriangles() * 3);
+  var hullIndices = new Int32Array(Ammo.HEAP32.buffer, view.shapeHullIndices(hull), hull.numIndices());
+  var hullVertices = new Float32Array(Ammo.HEAPF32.buffer, view.shapeHullVertices(hull), hull.numVertices() * stride);
+  for (var i = 0; i < hullIndices.length; i++) {
+    assert(hullIndices[i] >= 0 && hullIndices[i] < hull.numVertices(), "hull index in range");
+  }
+  for (var i = 0; i < hull.numVertices(); i++) {
+    assert(Math.abs(Math.abs(hullVertices[i * stride]) - 1) < 0.001, "hull vertex on the cube");
+  }
+
+  Ammo.destroy(hull);
+  Ammo.destroy(view);
+
+  print('ok.');
+});
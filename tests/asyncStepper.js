@@ -0,0 +1,80 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  function createBody(y) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(0, y, 0));
+    var shape = new Ammo.btSphereShape(1);
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    shape.calculateLocalInertia(1, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  var SET_POSITION = 1, SET_LINEAR_VELOCITY = 3;
+
+  var table = new Ammo.hbrHandleTable();
+  var a = table.addRigidBody(createBody(10));
+  var b = table.addRigidBody(createBody(20));
+
+  var stepper = new Ammo.hbrAsyncStepper(world, table, 4);
+  var handles = Ammo._malloc(4 * 2);
+  Ammo.HEAP32[(handles >> 2) + 0] = a;
+  Ammo.HEAP32[(handles >> 2) + 1] = b;
+  assert(stepper.setPublishedHandles(handles, 2));
+  assertEq(stepper.getNumPublished(), 2);
+  assert(!stepper.acquireFrame(), "nothing published yet");
+  assertEq(stepper.getFrameNumber(), 0);
+
+  function frameY(index) {
+    return Ammo.HEAPF32[(stepper.getFrame() >> 2) + index * 7 + 1];
+  }
+
+  // Commands apply at the start of the next step, the queue holds 4
+  for (var i = 0; i < 4; i++) assert(stepper.pushCommand(SET_POSITION, a, 0, 50 + i, 0, 0), "queued");
+  assert(!stepper.pushCommand(SET_POSITION, a, 0, 0, 0, 0), "queue is full");
+  assertEq(stepper.getNumPendingCommands(), 4);
+  stepper.step(1 / 60, 0, 1 / 60);
+  assertEq(stepper.getNumPendingCommands(), 0);
+  assertEq(stepper.getStepsCompleted(), 1);
+
+  assert(stepper.acquireFrame(), "first frame");
+  assertEq(stepper.getFrameNumber(), 1);
+  assert(frameY(0) > 52 && frameY(0) <= 53, "last position command wins: " + frameY(0));
+  assert(frameY(1) < 20, "body b falls");
+  assert(!stepper.acquireFrame(), "no newer frame");
+
+  // Only the latest frame is handed out, older ones are skipped
+  stepper.step(1 / 60, 0, 1 / 60);
+  stepper.step(1 / 60, 0, 1 / 60);
+  assert(stepper.acquireFrame());
+  assertEq(stepper.getFrameNumber(), 3);
+
+  if (stepper.isThreadingSupported()) {
+    assert(stepper.start(1 / 60, 0, 1 / 60), "start");
+    assert(!stepper.setPublishedHandles(handles, 2), "handles are fixed while running");
+    stepper.pushCommand(SET_LINEAR_VELOCITY, b, 0, 100, 0, 0);
+    for (var i = 0; i < 30; i++) stepper.requestStep();
+    stepper.stop();
+    assertEq(stepper.getStepsCompleted(), 33);
+    assert(stepper.acquireFrame());
+    assertEq(stepper.getFrameNumber(), 33);
+    assert(frameY(1) > 20, "body b was launched upwards: " + frameY(1));
+  } else {
+    assert(!stepper.start(1 / 60, 0, 1 / 60), "no stepping thread without pthreads");
+  }
+
+  Ammo.destroy(stepper);
+  Ammo._free(handles);
+
+  print('ok.');
+});
@@ -0,0 +1,121 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  var layers = new Ammo.hbrCollisionLayers();
+  world.getPairCache().setOverlapFilterCallback(layers);
+
+  var FLOOR = 0, PROPS = 3, DEBRIS = 4, GHOSTS = 31;
+  layers.setLayerCollision(DEBRIS, FLOOR, false);
+  assert(!layers.getLayerCollision(FLOOR, DEBRIS), "the matrix is symmetric");
+  assert(layers.getLayerCollision(PROPS, DEBRIS), "other pairs still collide");
+  layers.setLayerMask(GHOSTS, 0);
+  assertEq(layers.getLayerMask(GHOSTS), 0);
+  assert(!layers.getLayerCollision(PROPS, GHOSTS), "setLayerMask mirrors into the other rows");
+  assertEq(layers.getLayerGroup(GHOSTS) | 0, 1 << 31);
+
+  function createBody(mass, shape, x, y, layer) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, 0));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body, layers.getLayerGroup(layer), layers.getLayerMask(layer));
+    return body;
+  }
+
+  var floor = createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(10, 0.5, 10)), 0, -0.5, FLOOR);
+  var prop = createBody(1, new Ammo.btSphereShape(0.5), -2, 2, PROPS);
+  var debris = createBody(1, new Ammo.btSphereShape(0.5), 2, 2, DEBRIS);
+  prop.setActivationState(4);
+  assertEq(layers.getObjectLayer(debris), DEBRIS);
+
+  for (var i = 0; i < 90; i++) world.stepSimulation(1 / 60, 0);
+  assert(prop.getWorldTransform().getOrigin().y() > 0.3, "the prop rests on the floor");
+  assert(debris.getWorldTransform().getOrigin().y() < -1, "debris falls through the floor");
+
+  function rayHits(x, layer) {
+    var callback = new Ammo.ClosestRayResultCallback(new Ammo.btVector3(x, 10, 0), new Ammo.btVector3(x, -10, 0));
+    layers.setRayQueryLayer(callback, layer);
+    world.rayTest(new Ammo.btVector3(x, 10, 0), new Ammo.btVector3(x, -10, 0), callback);
+    var hit = callback.hasHit();
+    Ammo.destroy(callback);
+    return hit;
+  }
+  assert(rayHits(5, PROPS), "props see the floor");
+  assert(!rayHits(5, DEBRIS), "debris queries skip the floor");
+  assert(rayHits(-2, DEBRIS), "debris queries see props");
+
+  // Turning a pair off at runtime drops its existing overlaps
+  layers.setLayerCollision(PROPS, FLOOR, false);
+  assert(layers.refresh(world) > 0, "refresh removes the prop/floor pair");
+  for (var i = 0; i < 30; i++) world.stepSimulation(1 / 60, 0);
+  assert(prop.getWorldTransform().getOrigin().y() < 0, "the prop falls after the refresh");
+
+  // Moving an object between layers
+  assert(layers.setObjectLayer(debris, PROPS), "setObjectLayer");
+  assertEq(layers.getObjectLayer(debris), PROPS);
+  assertEq(layers.getObjectLayer(new Ammo.btCollisionObject()), -1, "objects outside a world have no layer");
+
+  // The character controller's sweeps follow its layer matrix. The world has no overlap filter and every object
+  // collides with every group, so only the controller's matrix keeps it out of the glass.
+  if (Ammo.hbrKinematicCharacterController) {
+    var CHARACTERS = 5, GLASS = 6;
+    layers.setLayerCollision(CHARACTERS, GLASS, false);
+
+    var characterWorld = new Ammo.btDiscreteDynamicsWorld(new Ammo.btCollisionDispatcher(collisionConfiguration), new Ammo.btDbvtBroadphase(), new Ammo.btSequentialImpulseConstraintSolver(), collisionConfiguration);
+    characterWorld.getPairCache().setInternalGhostPairCallback(new Ammo.btGhostPairCallback());
+    function addStatic(halfExtents, x, y, layer) {
+      var transform = new Ammo.btTransform();
+      transform.setIdentity();
+      transform.setOrigin(new Ammo.btVector3(x, y, 0));
+      var rbInfo = new Ammo.btRigidBodyConstructionInfo(0, new Ammo.btDefaultMotionState(transform), new Ammo.btBoxShape(halfExtents), new Ammo.btVector3(0, 0, 0));
+      characterWorld.addRigidBody(new Ammo.btRigidBody(rbInfo), layers.getLayerGroup(layer), -1);
+    }
+    addStatic(new Ammo.btVector3(15, 0.5, 5), 25, -0.5, FLOOR);
+    addStatic(new Ammo.btVector3(0.1, 2, 5), 23, 2, GLASS);
+    addStatic(new Ammo.btVector3(0.1, 2, 5), 28, 2, PROPS);
+    addStatic(new Ammo.btVector3(3, 0.5, 3), 50, -0.5, GLASS);
+
+    var ghost = new Ammo.btPairCachingGhostObject();
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(20, 1.5, 0));
+    ghost.setWorldTransform(transform);
+    var capsule = new Ammo.btCapsuleShape(0.4, 1);
+    ghost.setCollisionShape(capsule);
+    ghost.setCollisionFlags(16); // CF_CHARACTER_OBJECT
+    var character = new Ammo.hbrKinematicCharacterController(ghost, capsule, 0.35, new Ammo.btVector3(0, 1, 0));
+    character.setCollisionLayers(layers);
+    assertEq(Ammo.getPointer(character.getCollisionLayers()), Ammo.getPointer(layers));
+    character.setFriction(0);
+    characterWorld.addCollisionObject(ghost, layers.getLayerGroup(CHARACTERS), -1);
+    characterWorld.addAction(character);
+
+    for (var i = 0; i < 30; i++) characterWorld.stepSimulation(1 / 60, 0);
+    assert(character.onGround(), "the character stands on the floor");
+
+    // Walks through the glass wall, the prop wall stops it
+    character.setWalkDirection(new Ammo.btVector3(1, 0, 0));
+    for (var i = 0; i < 180; i++) characterWorld.stepSimulation(1 / 60, 0);
+    var x = ghost.getWorldTransform().getOrigin().x();
+    assert(x > 23.5, "the character walked through the glass, x = " + x);
+    assert(x < 28, "the prop wall stopped the character, x = " + x);
+
+    // Falls through a glass platform
+    character.setWalkDirection(new Ammo.btVector3(0, 0, 0));
+    character.warp(new Ammo.btVector3(50, 1.5, 0));
+    for (var i = 0; i < 60; i++) characterWorld.stepSimulation(1 / 60, 0);
+    assert(!character.onGround(), "the glass does not carry the character");
+    assert(ghost.getWorldTransform().getOrigin().y() < 0, "the character fell through the glass");
+  }
+
+  print('ok.');
+});
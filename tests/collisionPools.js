@@ -0,0 +1,59 @@
+Ammo().then(function(Ammo) {
+
+  function createWorld(info) {
+    var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration(info);
+    var dispatcher = new Ammo.hbrCollisionDispatcher(collisionConfiguration);
+    var broadphase = new Ammo.btDbvtBroadphase();
+    var solver = new Ammo.btSequentialImpulseConstraintSolver();
+    var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+    // A floor and a stack of 10 boxes resting on it
+    var floorShape = new Ammo.btBoxShape(new Ammo.btVector3(10, 0.5, 10));
+    var boxShape = new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5));
+    for (var i = 0; i <= 10; i++) {
+      var mass = i === 0 ? 0 : 1;
+      var transform = new Ammo.btTransform();
+      transform.setIdentity();
+      transform.setOrigin(new Ammo.btVector3(0, i - 0.5, 0));
+      var inertia = new Ammo.btVector3(0, 0, 0);
+      var shape = i === 0 ? floorShape : boxShape;
+      if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+      var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+      world.addRigidBody(new Ammo.btRigidBody(rbInfo));
+    }
+    for (var i = 0; i < 10; i++) world.stepSimulation(1 / 60, 0);
+    return dispatcher;
+  }
+
+  var info = new Ammo.btDefaultCollisionConstructionInfo();
+  assertEq(info.get_m_defaultMaxPersistentManifoldPoolSize(), 4096);
+  assertEq(info.get_m_defaultMaxCollisionAlgorithmPoolSize(), 4096);
+
+  // The default pools are large enough for the stack
+  var dispatcher = createWorld(info);
+  assertEq(dispatcher.getManifoldPoolSize(), 4096);
+  assertEq(dispatcher.getAlgorithmPoolSize(), 4096);
+  assertEq(dispatcher.getManifoldPoolUsed(), dispatcher.getNumManifolds());
+  assert(dispatcher.getManifoldPoolHighWater() >= 10, "each box touches the one below");
+  assert(dispatcher.getAlgorithmPoolHighWater() >= 10);
+  assertEq(dispatcher.getManifoldPoolOverflows(), 0);
+  assertEq(dispatcher.getAlgorithmPoolOverflows(), 0);
+
+  // Smaller ones overflow to the heap
+  info.set_m_defaultMaxPersistentManifoldPoolSize(4);
+  info.set_m_defaultMaxCollisionAlgorithmPoolSize(8);
+  dispatcher = createWorld(info);
+  assertEq(dispatcher.getManifoldPoolSize(), 4);
+  assertEq(dispatcher.getAlgorithmPoolSize(), 8);
+  assertEq(dispatcher.getManifoldPoolHighWater(), 4);
+  assertEq(dispatcher.getAlgorithmPoolHighWater(), 8);
+  assert(dispatcher.getManifoldPoolOverflows() >= dispatcher.getNumManifolds() - 4, "manifolds overflowed");
+  assert(dispatcher.getAlgorithmPoolOverflows() > 0, "algorithms overflowed");
+
+  dispatcher.resetCounters();
+  assertEq(dispatcher.getManifoldPoolOverflows(), 0);
+  assertEq(dispatcher.getManifoldPoolHighWater(), 4);
+
+  print('ok.');
+});
@@ -0,0 +1,103 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  world.getPairCache().setInternalGhostPairCallback(new Ammo.btGhostPairCallback());
+
+  // Far from the origin, where single precision starts to hurt
+  var FAR = 20000;
+
+  function createBody(mass, shape, x, y) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, 0));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var motionState = new Ammo.btDefaultMotionState(transform);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, motionState, shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(50, 0.5, 50)), FAR, -0.5);
+  var box = createBody(1, new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5)), FAR + 5, 0.5);
+
+  // Constraints with a single body are anchored in the world
+  var pendulum = createBody(1, new Ammo.btSphereShape(0.25), FAR + 20, 10);
+  var joint = new Ammo.btPoint2PointConstraint(pendulum, new Ammo.btVector3(0, 2, 0));
+  world.addConstraint(joint);
+  var held = createBody(1, new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5)), FAR + 30, 10);
+  var frame = new Ammo.btTransform();
+  frame.setIdentity();
+  var dof = new Ammo.btGeneric6DofConstraint(held, frame, true);
+  world.addConstraint(dof);
+
+  var ghost = new Ammo.btPairCachingGhostObject();
+  var transform = new Ammo.btTransform();
+  transform.setIdentity();
+  transform.setOrigin(new Ammo.btVector3(FAR - 5, 1, 0));
+  ghost.setWorldTransform(transform);
+  var capsule = new Ammo.btCapsuleShape(0.4, 1);
+  ghost.setCollisionShape(capsule);
+  ghost.setCollisionFlags(16); // CF_CHARACTER_OBJECT
+  var character = new Ammo.hbrKinematicCharacterController(ghost, capsule, 0.35, new Ammo.btVector3(0, 1, 0));
+  world.addCollisionObject(ghost);
+  world.addAction(character);
+
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  assert(character.onGround(), "the character stands on the ground");
+
+  var profiler = new Ammo.hbrProfiler();
+  profiler.capture(world);
+  var pairs = profiler.getNumOverlappingPairs();
+  var boxX = box.getWorldTransform().getOrigin().x();
+  var characterX = ghost.getWorldTransform().getOrigin().x();
+
+  var origin = new Ammo.hbrFloatingOrigin(world);
+  origin.addCharacter(character);
+  origin.addCharacter(character);
+  assertEq(origin.getNumCharacters(), 1);
+  origin.rebase(FAR, 0, 0);
+  assertEq(origin.getOrigin().x(), FAR);
+
+  assertEq(box.getWorldTransform().getOrigin().x(), boxX - FAR);
+  assertEq(ghost.getWorldTransform().getOrigin().x(), characterX - FAR);
+  var motionTransform = new Ammo.btTransform();
+  box.getMotionState().getWorldTransform(motionTransform);
+  assert(Math.abs(motionTransform.getOrigin().x() - (boxX - FAR)) < 0.01, "the motion state moved along");
+
+  // The world anchors of the constraints moved along
+  assertEq(joint.getPivotInB().x(), 20);
+  assertEq(joint.getPivotInB().y(), 12);
+  assertEq(dof.getFrameOffsetA().getOrigin().x(), 30);
+
+  // The broadphase tree moved as well, so queries find the objects at their new place
+  var from = new Ammo.btVector3(boxX - FAR, 10, 0);
+  var to = new Ammo.btVector3(boxX - FAR, -10, 0);
+  var callback = new Ammo.ClosestRayResultCallback(from, to);
+  world.rayTest(from, to, callback);
+  assert(callback.hasHit(), "the box is hit");
+  assert(Math.abs(callback.get_m_hitPointWorld().y() - 1) < 0.01, "the box is hit on top");
+
+  // And nothing notices the move
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  profiler.capture(world);
+  assertEq(profiler.getNumOverlappingPairs(), pairs);
+  assert(Math.abs(box.getWorldTransform().getOrigin().y() - 0.5) < 0.01, "the box still rests on the ground");
+  assert(Math.abs(box.getWorldTransform().getOrigin().x() - (boxX - FAR)) < 0.01, "the box did not slide");
+  assert(Math.abs(pendulum.getWorldTransform().getOrigin().x() - 20) < 0.01, "the pendulum hangs where it did");
+  assert(Math.abs(pendulum.getWorldTransform().getOrigin().y() - 10) < 0.05);
+  assert(Math.abs(held.getWorldTransform().getOrigin().x() - 30) < 0.01, "the held box stays in place");
+  assert(character.onGround(), "the character still stands on the ground");
+  assert(Math.abs(ghost.getWorldTransform().getOrigin().x() - (characterX - FAR)) < 0.01, "the character did not move");
+
+  origin.removeCharacter(character);
+  assertEq(origin.getNumCharacters(), 0);
+
+  print('ok.');
+});
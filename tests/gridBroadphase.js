@@ -0,0 +1,102 @@
+Ammo().then(function(Ammo) {
+
+  // The same crowd in a world on a btDbvtBroadphase and in one on an hbrGridBroadphase
+  function createWorld(broadphase) {
+    var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+    var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+    var solver = new Ammo.btSequentialImpulseConstraintSolver();
+    var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    world.setGravity(new Ammo.btVector3(0, -10, 0));
+    world.getPairCache().setInternalGhostPairCallback(new Ammo.btGhostPairCallback());
+
+    function createBody(mass, shape, x, y, z) {
+      var transform = new Ammo.btTransform();
+      transform.setIdentity();
+      transform.setOrigin(new Ammo.btVector3(x, y, z));
+      var inertia = new Ammo.btVector3(0, 0, 0);
+      if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+      var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+      var body = new Ammo.btRigidBody(rbInfo);
+      world.addRigidBody(body);
+      return body;
+    }
+
+    // The ground covers too many cells to be put in them
+    createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(200, 0.5, 200)), 0, -0.5, 0);
+    var sphere = new Ammo.btSphereShape(0.5);
+    var bodies = [];
+    for (var i = 0; i < 100; i++) {
+      bodies.push(createBody(1, sphere, (i % 10) * 3 - 15, 1 + (i % 3), Math.floor(i / 10) * 3 - 15));
+    }
+
+    var ghost = new Ammo.btPairCachingGhostObject();
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(-10, 1, -10));
+    ghost.setWorldTransform(transform);
+    ghost.setCollisionShape(new Ammo.btBoxShape(new Ammo.btVector3(4, 1, 4)));
+    ghost.setCollisionFlags(4); // CF_NO_CONTACT_RESPONSE
+    world.addCollisionObject(ghost);
+
+    for (var i = 0; i < 120; i++) world.stepSimulation(1 / 60, 0);
+    return { world: world, dispatcher: dispatcher, bodies: bodies, ghost: ghost };
+  }
+
+  var dbvt = createWorld(new Ammo.btDbvtBroadphase());
+  var grid = new Ammo.hbrGridBroadphase(4);
+  var crowd = createWorld(grid);
+
+  assertEq(grid.getCellSize(), 4);
+  assertEq(grid.getNumProxies(), 102);
+  assertEq(grid.getNumLargeProxies(), 1);
+  assert(grid.getNumCells() > 0);
+  assertEq(grid.getNumMovedProxies(), 0, 'pairs were updated');
+
+  // Every sphere landed on the ground, the same contacts were found
+  var transform = new Ammo.btTransform();
+  crowd.bodies.forEach(function(body) {
+    body.getMotionState().getWorldTransform(transform);
+    assert(Math.abs(transform.getOrigin().y() - 0.5) < 0.05, 'sphere rests on the ground');
+  });
+  assertEq(crowd.dispatcher.getNumManifolds(), dbvt.dispatcher.getNumManifolds());
+  assertEq(crowd.ghost.getNumOverlappingObjects(), dbvt.ghost.getNumOverlappingObjects());
+  assert(crowd.ghost.getNumOverlappingObjects() > 1, 'the ghost covers spheres and the ground');
+
+  // Rays, short ones walk the cells and long ones test every proxy
+  function castRay(world, fromX, fromZ, toX, toZ) {
+    var callback = new Ammo.ClosestRayResultCallback(new Ammo.btVector3(fromX, 0.5, fromZ), new Ammo.btVector3(toX, 0.5, toZ));
+    world.rayTest(callback.get_m_rayFromWorld(), callback.get_m_rayToWorld(), callback);
+    var hit = callback.hasHit() ? [callback.get_m_hitPointWorld().x(), callback.get_m_hitPointWorld().z()] : null;
+    Ammo.destroy(callback);
+    return hit;
+  }
+  [[-16, -15, -11, -15], [-16, -15, 100, -15], [-1000, -15, 1000, -15], [100, 100, -100, -100], [-13.5, -20, -13.5, 20], [20, 20, 30, 30]].forEach(function(ray) {
+    var expected = castRay(dbvt.world, ray[0], ray[1], ray[2], ray[3]);
+    var hit = castRay(crowd.world, ray[0], ray[1], ray[2], ray[3]);
+    var message = 'ray ' + ray + ' hits ' + hit + ', expected ' + expected;
+    assertEq(hit === null, expected === null, message);
+    if (hit) {
+      assert(Math.abs(hit[0] - expected[0]) < 0.01, message);
+      assert(Math.abs(hit[1] - expected[1]) < 0.01, message);
+    }
+  });
+
+  // A ball rolled into the crowd crosses cells and hits the first sphere of the row
+  var ball = crowd.bodies[0];
+  var target = crowd.bodies[1];
+  target.getMotionState().getWorldTransform(transform);
+  var targetX = transform.getOrigin().x();
+  ball.activate();
+  ball.setLinearVelocity(new Ammo.btVector3(20, 0, 0));
+  for (var i = 0; i < 30; i++) crowd.world.stepSimulation(1 / 60, 0);
+  target.getMotionState().getWorldTransform(transform);
+  assert(transform.getOrigin().x() > targetX + 0.5, 'the ball pushed the sphere it rolled into');
+
+  // Removing objects takes their pairs along
+  crowd.world.removeCollisionObject(crowd.ghost);
+  crowd.bodies.forEach(function(body) { crowd.world.removeRigidBody(body); });
+  assertEq(grid.getNumProxies(), 1);
+  assertEq(crowd.dispatcher.getNumManifolds(), 0);
+
+  print('ok.');
+});
@@ -0,0 +1,66 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  function createBody(y) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(0, y, 0));
+    var shape = new Ammo.btSphereShape(1);
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    shape.calculateLocalInertia(1, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  var table = new Ammo.hbrHandleTable();
+  var bodyA = createBody(10);
+  var bodyB = createBody(20);
+  var a = table.addRigidBody(bodyA);
+  var b = table.addRigidBody(bodyB);
+  assert(a !== 0 && b !== 0 && a !== b, "handles are unique and never 0");
+  assertEq(table.addRigidBody(bodyA), a, "adding twice returns the same handle");
+  assertEq(table.findHandle(bodyB), b);
+  assertEq(table.getCount(), 2);
+
+  var handles = Ammo._malloc(4 * 2);
+  var out = Ammo._malloc(4 * 7 * 2);
+  Ammo.HEAP32[(handles >> 2) + 0] = a;
+  Ammo.HEAP32[(handles >> 2) + 1] = b;
+
+  for (var i = 0; i < 30; i++) world.stepSimulation(1 / 60, 0);
+  assertEq(table.readTransforms(handles, 2, out), 2);
+  assert(Ammo.HEAPF32[(out >> 2) + 1] < 10, "body a is falling");
+  assert(Ammo.HEAPF32[(out >> 2) + 7 + 1] < 20, "body b is falling");
+
+  assert(table.setLinearVelocity(a, 0, 5, 0), "setLinearVelocity");
+  assert(table.getLinearVelocity(a, out), "getLinearVelocity");
+  assertEq(Ammo.HEAPF32[(out >> 2) + 1], 5);
+
+  // Both bodies sit on the y axis, body b above body a
+  table.setPosition(a, 0, 5, 0);
+  assertEq(table.rayTestClosest(world, 0, 50, 0, 0, 0, 0, out), b, "body b is the first hit from above");
+  assertEq(table.rayTestClosest(world, 0, -50, 0, 0, 0, 0, out), 0, "nothing below the origin");
+
+  // Stale handles are rejected once their slot is reused
+  assert(table.remove(a), "remove");
+  assert(!table.isValid(a), "removed handle is invalid");
+  var bodyC = createBody(30);
+  var c = table.addRigidBody(bodyC);
+  assertNeq(c, a, "a reused slot gets a new generation");
+  assert(!table.getTransform(a, out), "stale handle does not reach the new object");
+  assertEq(table.readTransforms(handles, 2, out), 1);
+
+  Ammo._free(handles);
+  Ammo._free(out);
+  Ammo.destroy(table);
+
+  print('ok.');
+});
@@ -0,0 +1,127 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.hbrCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  world.getPairCache().setInternalGhostPairCallback(new Ammo.btGhostPairCallback());
+
+  function transformAt(x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    return transform;
+  }
+
+  // One crate by itself and a 10x10 field of them with gaps in between
+  var crate = new Ammo.btBoxShape(new Ammo.btVector3(1, 0.5, 1));
+  var props = new Ammo.hbrInstancedShape(crate);
+  assertEq(props.addInstance(transformAt(0, -0.5, 0)), 0);
+
+  var count = 100;
+  var transforms = Ammo._malloc(4 * 7 * count);
+  function crateX(i) { return 10 + (i % 10) * 4; }
+  function crateZ(i) { return Math.floor(i / 10) * 4; }
+  for (var i = 0; i < count; i++) {
+    var t = (transforms >> 2) + i * 7;
+    Ammo.HEAPF32[t + 0] = crateX(i);
+    Ammo.HEAPF32[t + 1] = -0.5;
+    Ammo.HEAPF32[t + 2] = crateZ(i);
+    Ammo.HEAPF32[t + 3] = 0;
+    Ammo.HEAPF32[t + 4] = 0;
+    Ammo.HEAPF32[t + 5] = 0;
+    Ammo.HEAPF32[t + 6] = 1;
+  }
+  assertEq(props.addInstances(transforms, count), 1);
+  Ammo._free(transforms);
+  assertEq(props.getNumInstances(), 101);
+  assertEq(props.getNumChildShapes(), 101);
+  assertEq(props.getInstanceShape().getMargin(), crate.getMargin());
+
+  var inertia = new Ammo.btVector3(0, 0, 0);
+  var level = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(0, new Ammo.btDefaultMotionState(transformAt(0, 0, 0)), props, inertia));
+  world.addRigidBody(level);
+  assertEq(world.getNumCollisionObjects(), 1, 'all crates are one object');
+
+  // Rays and sweeps report the instance they hit
+  function rayIndex(x, z) {
+    var callback = new Ammo.hbrClosestRayResultCallback(new Ammo.btVector3(x, 10, z), new Ammo.btVector3(x, -10, z));
+    world.rayTest(callback.get_m_rayFromWorld(), callback.get_m_rayToWorld(), callback);
+    var index = callback.hasHit() ? callback.get_m_hitIndex() : -1;
+    assertEq(callback.get_m_hitShapePart(), -1);
+    Ammo.destroy(callback);
+    return index;
+  }
+  assertEq(rayIndex(0, 0), 0);
+  assertEq(rayIndex(crateX(23), crateZ(23)), 24);
+  assertEq(rayIndex(crateX(23) + 2, crateZ(23)), -1, 'between two crates');
+
+  var sphere = new Ammo.btSphereShape(0.5);
+  var sweep = new Ammo.hbrClosestConvexResultCallback(new Ammo.btVector3(crateX(75), 5, crateZ(75)), new Ammo.btVector3(crateX(75), -5, crateZ(75)));
+  world.convexSweepTest(sphere, transformAt(crateX(75), 5, crateZ(75)), transformAt(crateX(75), -5, crateZ(75)), sweep, 0);
+  assert(sweep.hasHit());
+  assertEq(sweep.get_m_hitIndex(), 76);
+  assert(Math.abs(sweep.get_m_hitPointWorld().y()) < 0.01, 'the sweep stops on top of the crate');
+  Ammo.destroy(sweep);
+
+  // A ball dropped onto a crate only collides with that one
+  sphere.calculateLocalInertia(1, inertia);
+  var ball = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transformAt(crateX(23), 2, crateZ(23))), sphere, inertia));
+  world.addRigidBody(ball);
+  for (var i = 0; i < 90; i++) world.stepSimulation(1 / 60, 0);
+  var transform = new Ammo.btTransform();
+  ball.getMotionState().getWorldTransform(transform);
+  assert(Math.abs(transform.getOrigin().y() - 0.5) < 0.05, 'the ball rests on the crate');
+  assertEq(dispatcher.getNumManifolds(), 1, 'no contacts with the other crates');
+  assertEq(dispatcher.getAlgorithmPoolUsed(), 2, 'one algorithm for the pair, one for the crate under the ball');
+
+  // A character reports the crate it stands on
+  if (Ammo.hbrKinematicCharacterController) {
+    var ghost = new Ammo.btPairCachingGhostObject();
+    ghost.setWorldTransform(transformAt(crateX(50), 1.5, crateZ(50)));
+    var capsule = new Ammo.btCapsuleShape(0.4, 1);
+    ghost.setCollisionShape(capsule);
+    ghost.setCollisionFlags(16); // CF_CHARACTER_OBJECT
+    var character = new Ammo.hbrKinematicCharacterController(ghost, capsule, 0.35, new Ammo.btVector3(0, 1, 0));
+    world.addCollisionObject(ghost);
+    world.addAction(character);
+    for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+    assert(character.onGround(), 'the character stands on a crate');
+    assertEq(Ammo.getPointer(character.getGroundObject()), Ammo.getPointer(level));
+    assertEq(character.getGroundIndex(), 51);
+    world.removeAction(character);
+    world.removeCollisionObject(ghost);
+  }
+
+  // The last crate takes the index of a removed one
+  assert(props.removeInstance(0));
+  assert(!props.removeInstance(100));
+  assertEq(props.getNumInstances(), 100);
+  assertEq(rayIndex(0, 0), -1);
+  assertEq(rayIndex(crateX(99), crateZ(99)), 0);
+  assertEq(rayIndex(crateX(23), crateZ(23)), 24);
+
+  // The ball keeps resting on its crate after the indices changed
+  for (var i = 0; i < 10; i++) world.stepSimulation(1 / 60, 0);
+  ball.getMotionState().getWorldTransform(transform);
+  assert(Math.abs(transform.getOrigin().y() - 0.5) < 0.05);
+  assertEq(dispatcher.getNumManifolds(), 1);
+
+  // Other compounds keep the algorithm of the collision configuration under hbrCollisionDispatcher
+  var ground = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(0, new Ammo.btDefaultMotionState(transformAt(-50, -0.5, 0)), new Ammo.btBoxShape(new Ammo.btVector3(5, 0.5, 5)), new Ammo.btVector3(0, 0, 0)));
+  world.addRigidBody(ground);
+  var dumbbell = new Ammo.btCompoundShape();
+  dumbbell.addChildShape(transformAt(-1, 0, 0), new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5)));
+  dumbbell.addChildShape(transformAt(1, 0, 0), new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5)));
+  dumbbell.calculateLocalInertia(1, inertia);
+  var body = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transformAt(-50, 2, 0)), dumbbell, inertia));
+  world.addRigidBody(body);
+  for (var i = 0; i < 90; i++) world.stepSimulation(1 / 60, 0);
+  body.getMotionState().getWorldTransform(transform);
+  assert(Math.abs(transform.getOrigin().y() - 0.5) < 0.05, 'the compound rests on the ground');
+  assertEq(dispatcher.getNumManifolds(), 3, 'the ball on its crate and both boxes of the compound on the ground');
+
+  print('ok.');
+});
@@ -0,0 +1,57 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+
+  var transform = new Ammo.btTransform();
+  transform.setIdentity();
+  var shape = new Ammo.btBoxShape(new Ammo.btVector3(2, 0.25, 2));
+  var motionState = new Ammo.btDefaultMotionState(transform);
+  var rbInfo = new Ammo.btRigidBodyConstructionInfo(0, motionState, shape, new Ammo.btVector3(0, 0, 0));
+  var platform = new Ammo.btRigidBody(rbInfo);
+  world.addRigidBody(platform);
+
+  var batch = new Ammo.hbrKinematicBodyBatch(world);
+  var index = batch.addBody(platform);
+  assertEq(index, 0);
+  assert(platform.isKinematicObject(), "addBody flags the body kinematic");
+
+  var indices = Ammo._malloc(4);
+  var transforms = Ammo._malloc(4 * 7);
+  Ammo.HEAP32[indices >> 2] = index;
+
+  var dt = 1 / 60;
+  for (var i = 1; i <= 10; i++) {
+    var t = transforms >> 2;
+    Ammo.HEAPF32[t + 0] = i * 0.1;
+    Ammo.HEAPF32[t + 1] = 0;
+    Ammo.HEAPF32[t + 2] = 0;
+    Ammo.HEAPF32[t + 3] = 0;
+    Ammo.HEAPF32[t + 4] = 0;
+    Ammo.HEAPF32[t + 5] = 0;
+    Ammo.HEAPF32[t + 6] = 1;
+    assertEq(batch.setTransforms(indices, transforms, 1, dt), 1);
+
+    var velocity = platform.getInterpolationLinearVelocity();
+    assert(Math.abs(velocity.x() - 0.1 / dt) < 0.01, "derived velocity " + velocity.x());
+    world.stepSimulation(dt, 0);
+  }
+
+  var x = platform.getWorldTransform().getOrigin().x();
+  assert(Math.abs(x - 1) < 0.0001, "platform moved to its target, x=" + x);
+  // The step keeps the velocity derived from the motion state
+  assert(Math.abs(platform.getInterpolationLinearVelocity().x() - 0.1 / dt) < 0.01, "velocity after step");
+
+  assert(batch.removeBody(index), "removeBody");
+  assertEq(batch.getNumBodies(), 0);
+  assertEq(batch.setTransforms(indices, transforms, 1, dt), 0);
+
+  Ammo._free(indices);
+  Ammo._free(transforms);
+  Ammo.destroy(batch);
+
+  print('ok.');
+});
@@ -0,0 +1,96 @@
+/*
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+// Smoke test of builds/libammo.so, compiled and run by python test.py builds/libammo.so
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../native/ammo.h"
+
+#define CHECK(condition)                                      \
+	if (!(condition))                                         \
+	{                                                         \
+		printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		exit(1);                                              \
+	}
+
+int main(void)
+{
+	float identity[7] = {0, 0, 0, 0, 0, 0, 1};
+	float start[7] = {0, 10, 0, 0, 0, 0, 1};
+	float transform[7];
+	float velocity[3];
+	float hit[7];
+	float from[3] = {5, 10, 0};
+	float to[3] = {5, -10, 0};
+	float position[3] = {5, 2, 0};
+	float up[3] = {0, 1, 0};
+	int i;
+
+	ammo_world* world = ammo_world_create(0, -10, 0);
+
+	ammo_shape* groundShape = ammo_shape_create_box(50, 1, 50);
+	ammo_body* ground = ammo_body_create(groundShape, 0, identity);
+	ammo_world_add_body(world, ground, 1, -1);
+	ammo_object_set_user_index(ammo_body_as_object(ground), 7);
+
+	ammo_shape* sphereShape = ammo_shape_create_sphere(0.5f);
+	ammo_body* sphere = ammo_body_create(sphereShape, 1, start);
+	ammo_world_add_body(world, sphere, 1, -1);
+
+	ammo_shape* capsuleShape = ammo_shape_create_capsule(0.4f, 1);
+	ammo_character* character = ammo_character_create(capsuleShape, 0.35f, position, up);
+	CHECK(character);
+	ammo_world_add_character(world, character, 2, -1);
+	CHECK(ammo_world_get_num_collision_objects(world) == 3);
+
+	for (i = 0; i < 120; i++)
+	{
+		ammo_world_step(world, 1.f / 60, 1, 1.f / 60);
+	}
+
+	// The sphere came to rest on the ground
+	ammo_body_get_transform(sphere, transform);
+	CHECK(transform[1] > 1.4f && transform[1] < 1.6f);
+	ammo_body_get_linear_velocity(sphere, velocity);
+	CHECK(velocity[1] > -0.1f);
+
+	// And so did the character
+	CHECK(ammo_character_on_ground(character));
+	ammo_character_get_transform(character, transform);
+	CHECK(transform[1] > 1 && transform[1] < 2.5f);
+
+	// The ray from above passes the character and hits the ground (the character is in group 2, not in the mask)
+	ammo_object* object = ammo_world_ray_test_closest(world, from, to, 1, 1, hit);
+	CHECK(object);
+	CHECK(ammo_object_get_user_index(object) == 7);
+	CHECK(ammo_object_as_body(object) == ground);
+	CHECK(hit[4] > 0.99f);
+
+	CHECK(ammo_world_contact_test(world, ammo_body_as_object(sphere), 1, -1) > 0);
+
+	ammo_world_remove_character(world, character);
+	ammo_world_remove_body(world, sphere);
+	ammo_world_remove_body(world, ground);
+	CHECK(ammo_world_get_num_collision_objects(world) == 0);
+
+	ammo_character_destroy(character);
+	ammo_body_destroy(sphere);
+	ammo_body_destroy(ground);
+	ammo_shape_destroy(capsuleShape);
+	ammo_shape_destroy(sphereShape);
+	ammo_shape_destroy(groundShape);
+	ammo_world_destroy(world);
+
+	printf("ok.\n");
+	return 0;
+}
@@ -0,0 +1,60 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  function createBody(mass, shape, y) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(0, y, 0));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(10, 0.5, 10)), -0.5);
+  createBody(1, new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5)), 0.5);
+
+  var profiler = new Ammo.hbrProfiler();
+  world.stepSimulation(1 / 60, 0);
+  var numScopes = profiler.capture(world);
+
+  assertEq(profiler.getNumCollisionObjects(), 2);
+  assertEq(profiler.getNumActiveObjects(), 1, "the static floor is not counted as active");
+  assertEq(profiler.getNumOverlappingPairs(), 1);
+  assertEq(profiler.getNumManifolds(), 1);
+  assert(profiler.getNumContactPoints() > 0, "the box touches the floor");
+  assertEq(profiler.getNumConstraints(), 0);
+  assertEq(profiler.getConfiguredSolverIterations(), 10);
+
+  if (profiler.isEnabled()) {
+    assert(numScopes > 0, "profile builds report scopes");
+    var scopes = profiler.getScopes() >> 2;
+    var names = [];
+    for (var i = 0; i < numScopes; i++) {
+      var depth = Ammo.HEAPF32[scopes + i * 4];
+      var parent = Ammo.HEAPF32[scopes + i * 4 + 1];
+      assert(depth === 0 ? parent === -1 : parent >= 0 && parent < i, "parents come before their children");
+      assert(Ammo.HEAPF32[scopes + i * 4 + 2] >= 0, "time");
+      assert(Ammo.HEAPF32[scopes + i * 4 + 3] >= 1, "calls");
+      names.push(profiler.getScopeName(i));
+    }
+    assert(names.indexOf('stepSimulation') >= 0, "stepSimulation is a scope: " + names.join(', '));
+
+    // Timings restart after each capture
+    assertEq(profiler.capture(world), 0);
+  } else {
+    assertEq(numScopes, 0);
+  }
+
+  Ammo.destroy(profiler);
+
+  print('ok.');
+});
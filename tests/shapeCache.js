@@ -0,0 +1,50 @@
+Ammo().then(function(Ammo) {
+
+  var cache = new Ammo.hbrShapeCache();
+
+  var vec = new Ammo.btVector3(0.5, 1, 0.5);
+  var boxA = cache.getBoxShape(vec);
+  var boxB = cache.getBoxShape(vec);
+  assert(Ammo.compare(boxA, boxB), "identical boxes should be shared");
+  assertEq(cache.getRefCount(boxA), 2);
+
+  vec.setValue(0.5, 2, 0.5);
+  var boxC = cache.getBoxShape(vec);
+  assert(!Ammo.compare(boxA, boxC), "different boxes should not be shared");
+
+  var capsuleA = cache.getCapsuleShape(0.4, 1.8, 1);
+  var capsuleB = cache.getCapsuleShape(0.4, 1.8, 2);
+  assert(!Ammo.compare(capsuleA, capsuleB), "up axis is part of the key");
+
+  // Convex hulls are keyed on their points
+  var points = [1, 1, 1, -1, 1, 1, 1, -1, 1, 0, 1, -1];
+  var pointsPtr = Ammo._malloc(4 * points.length);
+  for (var i = 0; i < points.length; i++) {
+    Ammo.HEAPF32[(pointsPtr >> 2) + i] = points[i];
+  }
+  var hullA = cache.getConvexHullShape(pointsPtr, 4);
+  var hullB = cache.getConvexHullShape(pointsPtr, 4);
+  assert(Ammo.compare(hullA, hullB), "identical hulls should be shared");
+  Ammo.HEAPF32[pointsPtr >> 2] = 2;
+  var hullC = cache.getConvexHullShape(pointsPtr, 4);
+  assert(!Ammo.compare(hullA, hullC), "different hulls should not be shared");
+  Ammo._free(pointsPtr);
+
+  assertEq(cache.getHitCount(), 2);
+  assertEq(cache.getMissCount(), 5);
+  assertEq(cache.getLiveShapeCount(), 5);
+
+  assert(!cache.release(boxA), "box still has a user");
+  assert(cache.release(boxB), "last release frees the box");
+  assertEq(cache.getLiveShapeCount(), 4);
+
+  // A freed shape is built again on the next request
+  vec.setValue(0.5, 1, 0.5);
+  cache.getBoxShape(vec);
+  assertEq(cache.getMissCount(), 6);
+
+  Ammo.destroy(cache);
+  Ammo.destroy(vec);
+
+  print('ok.');
+});
@@ -0,0 +1,142 @@
+Ammo().then(function(Ammo) {
+
+  var RECORD_INTS = 12;
+
+  function createWorld() {
+    var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+    var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+    var broadphase = new Ammo.btDbvtBroadphase();
+    var solver = new Ammo.btSequentialImpulseConstraintSolver();
+    var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    world.setGravity(new Ammo.btVector3(0, -10, 0));
+    return world;
+  }
+
+  function createBody(world, x, y) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, 0));
+    var shape = new Ammo.btSphereShape(0.5);
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    shape.calculateLocalInertia(1, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  function createCharacter(world, x, y) {
+    var ghost = new Ammo.btPairCachingGhostObject();
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, 0));
+    ghost.setWorldTransform(transform);
+    var shape = new Ammo.btCapsuleShape(0.4, 1);
+    ghost.setCollisionShape(shape);
+    ghost.setCollisionFlags(16); // CF_CHARACTER_OBJECT
+    var character = new Ammo.hbrKinematicCharacterController(ghost, shape, 0.35, new Ammo.btVector3(0, 1, 0));
+    world.addCollisionObject(ghost);
+    world.addAction(character);
+    return character;
+  }
+
+  // Server and client run the same scene, objects are known by the ids 10, 20 and 30 on both
+  function createSide() {
+    var world = createWorld();
+    var handles = new Ammo.hbrHandleTable();
+    var codec = new Ammo.hbrSnapshotCodec(handles, 1 / 1024, 1 / 256);
+    var bodies = [createBody(world, 0, 10), createBody(world, 5, 10)];
+    var character = createCharacter(world, -5, 2);
+    codec.bindId(10, handles.addRigidBody(bodies[0]));
+    codec.bindId(20, handles.addRigidBody(bodies[1]));
+    codec.bindId(30, handles.addCharacter(character));
+    return { world: world, handles: handles, codec: codec, bodies: bodies, character: character };
+  }
+
+  var server = createSide();
+  var client = createSide();
+  assertEq(server.codec.getHandle(10), server.handles.findHandle(server.bodies[0]));
+  assertEq(server.codec.getHandle(99), 0);
+
+  var ids = Ammo._malloc(4 * 3);
+  Ammo.HEAP32[(ids >> 2) + 0] = 10;
+  Ammo.HEAP32[(ids >> 2) + 1] = 20;
+  Ammo.HEAP32[(ids >> 2) + 2] = 30;
+  var baseline = Ammo._malloc(4 * RECORD_INTS * 3);
+  var state = Ammo._malloc(4 * RECORD_INTS * 3);
+  var clientState = Ammo._malloc(4 * RECORD_INTS * 3);
+  var packet = Ammo._malloc(1024);
+
+  // A full snapshot to start with
+  assertEq(server.codec.capture(ids, 3, baseline), 3);
+  var size = server.codec.encode(baseline, 3, 0, 0, packet, 1024);
+  assert(size > 0 && size < 3 * RECORD_INTS * 4, "the full snapshot is smaller than the state");
+  assertEq(server.codec.encode(baseline, 3, 0, 0, packet, 4), -1, "does not fit");
+  assertEq(client.codec.decode(packet, size, 0, 0, clientState, 3, false), 3);
+  for (var i = 0; i < 3 * RECORD_INTS; i++) {
+    assertEq(Ammo.HEAP32[(clientState >> 2) + i], Ammo.HEAP32[(baseline >> 2) + i]);
+  }
+
+  // Nothing moved, nothing to send
+  size = server.codec.encode(baseline, 3, baseline, 3, packet, 1024);
+  assertEq(size, 1, "only the number of changed objects");
+
+  // The server moves body 20 and the character and lets body 10 fall
+  server.handles.setPosition(server.codec.getHandle(20), 7, 3, 1);
+  server.handles.warp(server.codec.getHandle(30), -4, 2, 0);
+  server.handles.setLinearVelocity(server.codec.getHandle(30), 1, 0, 0);
+  for (var i = 0; i < 10; i++) server.world.stepSimulation(1 / 60, 0);
+
+  assertEq(server.codec.capture(ids, 3, state), 3);
+  size = server.codec.encode(state, 3, baseline, 3, packet, 1024);
+  assert(size > 1, "the delta has the changes");
+  assertEq(client.codec.decode(packet, size, clientState, 3, clientState, 3, true), 3);
+
+  var serverTransform = Ammo._malloc(4 * 7);
+  var clientTransform = Ammo._malloc(4 * 7);
+  [10, 20].forEach(function(id) {
+    server.handles.getTransform(server.codec.getHandle(id), serverTransform);
+    client.handles.getTransform(client.codec.getHandle(id), clientTransform);
+    for (var i = 0; i < 3; i++) {
+      assert(Math.abs(Ammo.HEAPF32[(serverTransform >> 2) + i] - Ammo.HEAPF32[(clientTransform >> 2) + i]) <= 1 / 1024, "position of " + id);
+    }
+    for (var i = 3; i < 7; i++) {
+      assert(Math.abs(Ammo.HEAPF32[(serverTransform >> 2) + i] - Ammo.HEAPF32[(clientTransform >> 2) + i]) < 0.01, "rotation of " + id);
+    }
+  });
+  var velocity = Ammo._malloc(4 * 3);
+  [10, 30].forEach(function(id) {
+    server.handles.getLinearVelocity(server.codec.getHandle(id), velocity);
+    var serverVelocity = [0, 1, 2].map(function(i) { return Ammo.HEAPF32[(velocity >> 2) + i]; });
+    client.handles.getLinearVelocity(client.codec.getHandle(id), velocity);
+    for (var i = 0; i < 3; i++) {
+      assert(Math.abs(Ammo.HEAPF32[(velocity >> 2) + i] - serverVelocity[i]) <= 1 / 256, "velocity of " + id);
+    }
+  });
+  server.handles.getTransform(server.codec.getHandle(30), serverTransform);
+  client.handles.getTransform(client.codec.getHandle(30), clientTransform);
+  for (var i = 0; i < 3; i++) {
+    assert(Math.abs(Ammo.HEAPF32[(serverTransform >> 2) + i] - Ammo.HEAPF32[(clientTransform >> 2) + i]) <= 1 / 1024, "the character was warped");
+  }
+
+  // Applying the decoded state gives the same result
+  assertEq(client.codec.apply(clientState, 3), 3);
+
+  // Objects missing from the state are removed from the client's state
+  Ammo.HEAP32[(ids >> 2) + 1] = 30;
+  assertEq(server.codec.capture(ids, 2, baseline), 2);
+  size = server.codec.encode(baseline, 2, state, 3, packet, 1024);
+  assertEq(client.codec.decode(packet, size, clientState, 3, clientState, 3, false), 2);
+  assertEq(Ammo.HEAP32[(clientState >> 2) + 0], 10);
+  assertEq(Ammo.HEAP32[(clientState >> 2) + RECORD_INTS], 30);
+
+  // Truncated deltas are rejected
+  size = server.codec.encode(baseline, 2, 0, 0, packet, 1024);
+  assertEq(client.codec.decode(packet, size - 1, 0, 0, clientState, 3, false), -1);
+
+  [ids, baseline, state, clientState, packet, serverTransform, clientTransform, velocity].forEach(function(ptr) {
+    Ammo._free(ptr);
+  });
+
+  print('ok.');
+});
@@ -0,0 +1,69 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btSoftBodyRigidBodyCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var softBodySolver = new Ammo.btDefaultSoftBodySolver();
+  var world = new Ammo.btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration, softBodySolver);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  world.getWorldInfo().set_m_gravity(new Ammo.btVector3(0, -10, 0));
+
+  // A 10x10 cloth pinned at two corners
+  var res = 10;
+  var helpers = new Ammo.btSoftBodyHelpers();
+  var cloth = helpers.CreatePatch(world.getWorldInfo(),
+    new Ammo.btVector3(0, 5, 0), new Ammo.btVector3(2, 5, 0),
+    new Ammo.btVector3(0, 5, 2), new Ammo.btVector3(2, 5, 2), res, res, 1 + 2, true);
+  cloth.setTotalMass(1, false);
+  world.addSoftBody(cloth, 1, -1);
+
+  var nodes = cloth.get_m_nodes();
+  assertEq(nodes.size(), res * res);
+
+  for (var i = 0; i < 30; i++) world.stepSimulation(1 / 60, 0);
+
+  var exporter = new Ammo.hbrSoftBodyExporter();
+  assertEq(exporter.getNumVertices(cloth), res * res);
+  var positions = Ammo._malloc(4 * 3 * res * res);
+  var normals = Ammo._malloc(4 * 3 * res * res);
+  assertEq(exporter.exportNodes(cloth, positions, normals), res * res);
+
+  for (var i = 0; i < nodes.size(); i++) {
+    var node = nodes.at(i);
+    var x = node.get_m_x();
+    var n = node.get_m_n();
+    var p = (positions >> 2) + i * 3;
+    var q = (normals >> 2) + i * 3;
+    assertEq(Ammo.HEAPF32[p + 0], x.x());
+    assertEq(Ammo.HEAPF32[p + 1], x.y());
+    assertEq(Ammo.HEAPF32[p + 2], x.z());
+    assertEq(Ammo.HEAPF32[q + 0], n.x());
+    assertEq(Ammo.HEAPF32[q + 1], n.y());
+    assertEq(Ammo.HEAPF32[q + 2], n.z());
+  }
+  assert(Ammo.HEAPF32[(positions >> 2) + (res * res - 1) * 3 + 1] < 5, "the free corner is hanging down");
+
+  // Remapped export: vertices in reverse order plus one out of range entry
+  var remap = Ammo._malloc(4 * 3);
+  Ammo.HEAP32[(remap >> 2) + 0] = res * res - 1;
+  Ammo.HEAP32[(remap >> 2) + 1] = 0;
+  Ammo.HEAP32[(remap >> 2) + 2] = res * res;
+  exporter.setRemap(remap, 3);
+  Ammo._free(remap);
+  assert(exporter.hasRemap(), "hasRemap");
+  assertEq(exporter.getNumVertices(cloth), 3);
+  assertEq(exporter.exportNodes(cloth, positions, 0), 3);
+  assertEq(Ammo.HEAPF32[(positions >> 2) + 1], nodes.at(res * res - 1).get_m_x().y());
+  assertEq(Ammo.HEAPF32[(positions >> 2) + 3 + 1], nodes.at(0).get_m_x().y());
+  assertEq(Ammo.HEAPF32[(positions >> 2) + 6 + 1], 0);
+
+  exporter.clearRemap();
+  assertEq(exporter.getNumVertices(cloth), res * res);
+
+  Ammo._free(positions);
+  Ammo._free(normals);
+  Ammo.destroy(exporter);
+
+  print('ok.');
+});
@@ -0,0 +1,102 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+  // Static objects are only touched when they move
+  world.setForceUpdateAllAabbs(false);
+  assertEq(world.getForceUpdateAllAabbs(), false);
+
+  function transformAt(x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    return transform;
+  }
+
+  function rayHits(x, z) {
+    var callback = new Ammo.ClosestRayResultCallback(new Ammo.btVector3(x, 10, z), new Ammo.btVector3(x, -10, z));
+    world.rayTest(callback.get_m_rayFromWorld(), callback.get_m_rayToWorld(), callback);
+    var hit = callback.hasHit();
+    Ammo.destroy(callback);
+    return hit;
+  }
+
+  // A sphere floating where the level is streamed in, it does not move so it would not look for new pairs itself
+  var sphere = new Ammo.btSphereShape(0.5);
+  var inertia = new Ammo.btVector3(0, 0, 0);
+  sphere.calculateLocalInertia(1, inertia);
+  var ball = new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(1, new Ammo.btDefaultMotionState(transformAt(1, 0.25, 1)), sphere, inertia));
+  world.addRigidBody(ball);
+  ball.setGravity(new Ammo.btVector3(0, 0, 0));
+  ball.setActivationState(4); // DISABLE_DEACTIVATION
+  for (var i = 0; i < 10; i++) world.stepSimulation(1 / 60, 0);
+  assertEq(dispatcher.getNumManifolds(), 0);
+
+  function staticBody(shape, x, y, z) {
+    return new Ammo.btRigidBody(new Ammo.btRigidBodyConstructionInfo(0, new Ammo.btDefaultMotionState(transformAt(x, y, z)), shape, inertia));
+  }
+
+  // A chunk of 20x20 floor tiles
+  var batch = new Ammo.hbrStaticBatch(world);
+  var tile = new Ammo.btBoxShape(new Ammo.btVector3(1, 0.5, 1));
+  for (var x = 0; x < 20; x++) {
+    for (var z = 0; z < 20; z++) {
+      batch.add(staticBody(tile, x * 2 - 19, -0.5, z * 2 - 19));
+    }
+  }
+  assertEq(batch.getNumPending(), 400);
+  var level = batch.commit();
+  assertEq(batch.getNumPending(), 0);
+  assertEq(batch.getNumChunks(), 1);
+  assertEq(batch.getChunkSize(level), 400);
+  assertEq(world.getNumCollisionObjects(), 401);
+  assert(rayHits(5, 5), 'the chunk is in the broadphase');
+  assert(!rayHits(50, 5));
+
+  world.stepSimulation(1 / 60, 0);
+  assert(dispatcher.getNumManifolds() > 0, 'the resting sphere found the floor');
+
+  // A second chunk far away, the sphere comes to rest on the first
+  var house = new Ammo.btBoxShape(new Ammo.btVector3(3, 3, 3));
+  for (var i = 0; i < 3; i++) {
+    batch.add(staticBody(house, 50 + i * 10, 3, 5));
+  }
+  var town = batch.commit();
+  assertNeq(town, level);
+  assertEq(batch.getNumChunks(), 2);
+  assertEq(world.getNumCollisionObjects(), 404);
+  assert(rayHits(50, 5));
+  assertEq(batch.getChunkObject(town, 0).getCollisionShape().getMargin(), house.getMargin());
+
+  ball.setGravity(new Ammo.btVector3(0, -10, 0));
+  for (var i = 0; i < 60; i++) world.stepSimulation(1 / 60, 0);
+  var transform = new Ammo.btTransform();
+  ball.getMotionState().getWorldTransform(transform);
+  assert(Math.abs(transform.getOrigin().y() - 0.5) < 0.05, 'the sphere rests on the floor');
+
+  // Unloading the floor takes its contacts along, the sphere falls
+  batch.removeChunk(level);
+  assertEq(batch.getNumChunks(), 1);
+  assertEq(batch.getChunkSize(level), 0);
+  assertEq(world.getNumCollisionObjects(), 4);
+  assertEq(dispatcher.getNumManifolds(), 0);
+  assert(!rayHits(5, 5), 'the chunk left the broadphase');
+  assert(rayHits(60, 5), 'the other chunk stays');
+  for (var i = 0; i < 30; i++) world.stepSimulation(1 / 60, 0);
+  ball.getMotionState().getWorldTransform(transform);
+  assert(transform.getOrigin().y() < 0, 'the sphere fell through');
+
+  // Ids of removed chunks are reused
+  batch.removeChunk(town);
+  assertEq(world.getNumCollisionObjects(), 1);
+  batch.add(staticBody(tile, 0, -0.5, 0));
+  var again = batch.commit();
+  assert(again === level || again === town);
+  assertEq(batch.commit(), -1, 'nothing queued');
+
+  print('ok.');
+});
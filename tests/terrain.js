@@ -0,0 +1,74 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  // 17x17 samples, 1m apart: every tile covers 16x16m
+  var samples = 17;
+  var terrain = new Ammo.hbrHeightfieldTerrain(world, samples, 1);
+
+  var heights = Ammo._malloc(4 * samples * samples);
+  for (var i = 0; i < samples * samples; i++) {
+    Ammo.HEAPF32[(heights >> 2) + i] = 2;
+  }
+  assert(terrain.loadTile(0, 0, heights), "loadTile");
+  assert(terrain.loadTile(1, 0, heights), "loadTile");
+  assertEq(terrain.getNumLoadedTiles(), 2);
+  assert(terrain.isTileLoaded(1, 0), "tile 1,0 is loaded");
+  assert(!terrain.isTileLoaded(0, 1), "tile 0,1 is not loaded");
+
+  // Drop a sphere onto the first tile
+  var transform = new Ammo.btTransform();
+  transform.setIdentity();
+  transform.setOrigin(new Ammo.btVector3(8, 6, 8));
+  var shape = new Ammo.btSphereShape(0.5);
+  var inertia = new Ammo.btVector3(0, 0, 0);
+  shape.calculateLocalInertia(1, inertia);
+  var motionState = new Ammo.btDefaultMotionState(transform);
+  var rbInfo = new Ammo.btRigidBodyConstructionInfo(1, motionState, shape, inertia);
+  var body = new Ammo.btRigidBody(rbInfo);
+  world.addRigidBody(body);
+
+  for (var i = 0; i < 120; i++) world.stepSimulation(1 / 60, 0);
+  var y = body.getWorldTransform().getOrigin().y();
+  assert(Math.abs(y - 2.5) < 0.1, "sphere should rest on the terrain, y=" + y);
+
+  // Raise a patch under the sphere, the tile grows its height range in place
+  var patch = Ammo._malloc(4 * 5 * 5);
+  for (var i = 0; i < 25; i++) {
+    Ammo.HEAPF32[(patch >> 2) + i] = 4;
+  }
+  assertEq(terrain.setHeights(6, 6, 5, 5, patch), 1);
+  for (var i = 0; i < 120; i++) world.stepSimulation(1 / 60, 0);
+  y = body.getWorldTransform().getOrigin().y();
+  assert(Math.abs(y - 4.5) < 0.2, "sphere should be lifted by the edit, y=" + y);
+
+  // Streaming around a point on the tile border reports the unloaded neighbours
+  var positions = Ammo._malloc(4 * 3);
+  Ammo.HEAPF32[(positions >> 2) + 0] = 16;
+  Ammo.HEAPF32[(positions >> 2) + 1] = 0;
+  Ammo.HEAPF32[(positions >> 2) + 2] = 15;
+  var missing = Ammo._malloc(4 * 2 * 16);
+  var numMissing = terrain.updateStreaming(positions, 1, 2, missing, 16);
+  assertEq(numMissing, 2, "tiles 0,1 and 1,1 are missing");
+
+  // With a tiny budget everything but the tiles in use gets evicted
+  Ammo.HEAPF32[(positions >> 2) + 0] = 4;
+  terrain.updateStreaming(positions, 1, 1, missing, 16);
+  terrain.setMemoryBudget(1);
+  assertEq(terrain.getNumLoadedTiles(), 1);
+  assert(terrain.isTileLoaded(0, 0), "the tile in use is kept");
+
+  world.removeRigidBody(body);
+  Ammo.destroy(terrain);
+  Ammo._free(heights);
+  Ammo._free(patch);
+  Ammo._free(positions);
+  Ammo._free(missing);
+
+  print('ok.');
+});
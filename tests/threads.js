@@ -0,0 +1,52 @@
+Ammo().then(function(Ammo) {
+
+  var scheduler = new Ammo.hbrTaskScheduler();
+  assert(scheduler.isThreadSafe(), "the threads build is thread safe");
+  var maxThreads = scheduler.getMaxNumThreads();
+  assert(maxThreads >= 1, "at least the calling thread");
+  assertEq(scheduler.setNumThreads(1000), maxThreads, "thread count is clamped to the pool");
+  assertEq(scheduler.setNumThreads(0), 1, "thread count is at least 1");
+  assertEq(scheduler.setNumThreads(maxThreads), maxThreads);
+  assertEq(scheduler.getNumThreads(), maxThreads);
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcherMt(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solverPool = new Ammo.btConstraintSolverPoolMt(maxThreads);
+  var world = new Ammo.btDiscreteDynamicsWorldMt(dispatcher, broadphase, solverPool, null, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  function createBody(mass, shape, x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(50, 0.5, 50)), 0, -0.5, 0);
+  // Separate stacks end up in separate islands, which the solver pool solves in parallel
+  var box = new Ammo.btBoxShape(new Ammo.btVector3(0.5, 0.5, 0.5));
+  var tops = [];
+  for (var stack = 0; stack < 8; stack++) {
+    for (var level = 0; level < 5; level++) {
+      var body = createBody(1, box, stack * 4 - 16, 0.5 + level, 0);
+    }
+    tops.push(body);
+  }
+
+  for (var i = 0; i < 120; i++) world.stepSimulation(1 / 60, 0);
+
+  var transform = new Ammo.btTransform();
+  tops.forEach(function(top) {
+    top.getMotionState().getWorldTransform(transform);
+    var y = transform.getOrigin().y();
+    assert(y > 4 && y < 5, "stacks settle in place: " + y);
+  });
+
+  print('ok.');
+});
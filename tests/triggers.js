@@ -0,0 +1,74 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.getPairCache().setInternalGhostPairCallback(new Ammo.btGhostPairCallback());
+
+  var transform = new Ammo.btTransform();
+  transform.setIdentity();
+
+  function createTrigger() {
+    var ghost = new Ammo.btPairCachingGhostObject();
+    ghost.setCollisionShape(new Ammo.btSphereShape(2));
+    ghost.setWorldTransform(transform);
+    ghost.setCollisionFlags(4); // CF_NO_CONTACT_RESPONSE
+    world.addCollisionObject(ghost);
+    return ghost;
+  }
+
+  var triggers = new Ammo.hbrTriggerVolumes(world);
+  assertEq(triggers.addTrigger(createTrigger()), 0);
+  assertEq(triggers.addTrigger(createTrigger(), true), 1);
+  assertEq(triggers.getNumTriggers(), 2);
+
+  var object = new Ammo.btCollisionObject();
+  object.setCollisionShape(new Ammo.btSphereShape(0.2));
+  object.setUserIndex(42);
+  world.addCollisionObject(object);
+
+  function moveTo(x, y, z) {
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    object.setWorldTransform(transform);
+    world.stepSimulation(1 / 60, 0);
+    return triggers.update();
+  }
+
+  function events(pointer, count) {
+    var list = [];
+    for (var i = 0; i < count; i++) {
+      list.push(Ammo.HEAP32[(pointer >> 2) + i * 2] + ':' + Ammo.HEAP32[(pointer >> 2) + i * 2 + 1]);
+    }
+    return list.sort().join(',');
+  }
+
+  assertEq(moveTo(10, 0, 0), 0);
+
+  // Inside both AABBs but outside the sphere, only the AABB trigger fires
+  assertEq(moveTo(1.8, 1.8, 0), 1);
+  assertEq(events(triggers.getEnterEvents(), triggers.getNumEnterEvents()), '0:42');
+  assertEq(triggers.getNumOccupants(1), 0);
+
+  assertEq(moveTo(0, 0, 0), 1);
+  assertEq(events(triggers.getEnterEvents(), triggers.getNumEnterEvents()), '1:42');
+  assertEq(triggers.getNumOccupants(0), 1);
+  assertEq(triggers.getNumOccupants(1), 1);
+
+  assertEq(moveTo(0, 0, 0), 0, "no events while nothing changes");
+
+  // The user index reported on exit is the one seen on enter
+  object.setUserIndex(7);
+  assertEq(moveTo(10, 0, 0), 2);
+  assertEq(triggers.getNumEnterEvents(), 0);
+  assertEq(events(triggers.getExitEvents(), triggers.getNumExitEvents()), '0:42,1:42');
+
+  assert(triggers.removeTrigger(0), "removeTrigger");
+  assert(!triggers.removeTrigger(0), "removing twice fails");
+  assertEq(triggers.getNumTriggers(), 1);
+
+  Ammo.destroy(triggers);
+
+  print('ok.');
+});
@@ -0,0 +1,101 @@
+Ammo().then(function(Ammo) {
+
+  var collisionConfiguration = new Ammo.btDefaultCollisionConfiguration();
+  var dispatcher = new Ammo.btCollisionDispatcher(collisionConfiguration);
+  var broadphase = new Ammo.btDbvtBroadphase();
+  var solver = new Ammo.btSequentialImpulseConstraintSolver();
+  var world = new Ammo.btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+  world.setGravity(new Ammo.btVector3(0, -10, 0));
+
+  function createBody(mass, shape, x, y, z) {
+    var transform = new Ammo.btTransform();
+    transform.setIdentity();
+    transform.setOrigin(new Ammo.btVector3(x, y, z));
+    var inertia = new Ammo.btVector3(0, 0, 0);
+    if (mass > 0) shape.calculateLocalInertia(mass, inertia);
+    var rbInfo = new Ammo.btRigidBodyConstructionInfo(mass, new Ammo.btDefaultMotionState(transform), shape, inertia);
+    var body = new Ammo.btRigidBody(rbInfo);
+    world.addRigidBody(body);
+    return body;
+  }
+
+  createBody(0, new Ammo.btBoxShape(new Ammo.btVector3(100, 0.5, 100)), 0, -0.5, 0);
+
+  var fleet = new Ammo.hbrVehicleFleet(world);
+  world.addAction(fleet);
+
+  var tuning = new Ammo.btVehicleTuning();
+  var wheelDirection = new Ammo.btVector3(0, -1, 0);
+  var wheelAxle = new Ammo.btVector3(-1, 0, 0);
+
+  function createVehicle(x) {
+    var chassis = createBody(800, new Ammo.btBoxShape(new Ammo.btVector3(0.9, 0.3, 2)), x, 2, 0);
+    chassis.setActivationState(4);
+    var vehicle = new Ammo.btRaycastVehicle(tuning, chassis, fleet.getRaycaster());
+    vehicle.setCoordinateSystem(0, 1, 2);
+    [[1, 1.7, true], [-1, 1.7, true], [-1, -1, false], [1, -1, false]].forEach(function(w) {
+      var wheel = vehicle.addWheel(new Ammo.btVector3(w[0], 0.3, w[1]), wheelDirection, wheelAxle, 0.6, 0.4, tuning, w[2]);
+      wheel.set_m_suspensionStiffness(20);
+      wheel.set_m_wheelsDampingRelaxation(2.3);
+      wheel.set_m_wheelsDampingCompression(4.4);
+      wheel.set_m_frictionSlip(1000);
+      wheel.set_m_rollInfluence(0.2);
+    });
+    return vehicle;
+  }
+
+  assertEq(fleet.addVehicle(createVehicle(-5)), 0);
+  assertEq(fleet.addVehicle(createVehicle(5)), 1);
+  assertEq(fleet.getNumVehicles(), 2);
+
+  var stateSize = fleet.getStateSize();
+  assertEq(stateSize, 2 * (8 + 4 * 8));
+  var state = Ammo._malloc(4 * stateSize);
+  var controls = Ammo._malloc(4 * 3 * 2);
+  for (var i = 0; i < 6; i++) Ammo.HEAPF32[(controls >> 2) + i] = 0;
+
+  function step(frames) {
+    for (var i = 0; i < frames; i++) {
+      fleet.setControls(controls, 2);
+      world.stepSimulation(1 / 60, 0);
+    }
+    assertEq(fleet.writeState(state, false), fleet.getStateSize());
+  }
+
+  // Let both vehicles settle on their suspension
+  step(120);
+  for (var v = 0; v < 2; v++) {
+    var s = (state >> 2) + v * 40;
+    var y = Ammo.HEAPF32[s + 1];
+    assert(y > 0.3 && y < 2, "chassis rests on its wheels, y=" + y);
+    for (var w = 0; w < 4; w++) {
+      assertEq(Ammo.HEAPF32[s + 8 + w * 8 + 7], 1, "wheel " + w + " touches the ground");
+    }
+  }
+  var startZ = [Ammo.HEAPF32[(state >> 2) + 2], Ammo.HEAPF32[(state >> 2) + 40 + 2]];
+
+  // Only the first vehicle accelerates
+  Ammo.HEAPF32[(controls >> 2) + 0] = 2000;
+  step(60);
+  var movedA = Math.abs(Ammo.HEAPF32[(state >> 2) + 2] - startZ[0]);
+  var movedB = Math.abs(Ammo.HEAPF32[(state >> 2) + 40 + 2] - startZ[1]);
+  assert(movedA > 0.5, "first vehicle drives, moved " + movedA);
+  assert(movedB < 0.1, "second vehicle stays, moved " + movedB);
+  assert(Math.abs(Ammo.HEAPF32[(state >> 2) + 7]) > 1, "speed is reported");
+
+  // Rays that filter out the ground lose contact
+  var vehicle = fleet.getVehicle(1);
+  assert(fleet.removeVehicle(fleet.getVehicle(0)), "removeVehicle");
+  assertEq(fleet.getNumVehicles(), 1);
+  assert(fleet.getVehicle(0) === vehicle, "the last vehicle takes the removed index");
+  fleet.setRayFilter(1, 0);
+  step(1);
+  assertEq(Ammo.HEAPF32[(state >> 2) + 8 + 7], 0, "filtered rays do not hit the ground");
+
+  Ammo._free(state);
+  Ammo._free(controls);
+  world.removeAction(fleet);
+  Ammo.destroy(fleet);
+
+  print('ok.');
+});